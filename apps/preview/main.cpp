@@ -0,0 +1,20 @@
+#include <iostream>
+
+#include "io/preview_server.h"
+
+/**
+ * @brief 常驻预览服务
+ *
+ * 用法：preview_server <socket> [cache_dir]
+ */
+int main(int argc, char** argv) {
+    if(argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <socket> [cache_dir]\n";
+        return 1;
+    }
+    PreviewServer server(argv[1], argc > 2 ? argv[2] : "");
+    if(!server.open()) return 1;
+    std::cerr << "listening on " << argv[1] << "\n";
+    server.run();
+    return 0;
+}
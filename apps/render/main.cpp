@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "io/asset_store.h"
+#include "model/subdivision.h"
+#include "render/batch.h"
+
+namespace {
+
+/**
+ * @brief 命令行参数
+ */
+struct Options {
+    std::string mesh = {};
+    std::string output = "render.tga";
+    std::string format = "tga";     // tga（RLE）/ tga-raw（不压缩）/ raw（BGRA 像素）
+    std::string cache_dir = {};     // 非空时经二进制缓存加载模型
+    std::string batch = {};         // 非空时执行任务文件
+    std::string render_cache = {};  // 非空时使用渲染结果缓存
+    int jobs = 0;                   // 批处理工作线程数，0 表示硬件线程数
+    int width = 800;
+    int height = 800;
+    int repeat = 1;
+    int subdivide = 0;              // Loop 细分层数
+    double adaptive_px = 0;         // 大于 0 时只细分轮廓面与投影边长超过此值的面
+    bool quantize = false;          // 以量化网格常驻并绘制
+    Camera camera = {};
+    RenderSettings settings = {};
+};
+
+void usage(const char* argv0) {
+    std::cerr <<
+        "usage: " << argv0 << " <mesh> [options]\n"
+        "       " << argv0 << " --batch FILE [-j N]\n"
+        "  -o, --output FILE      output file (default render.tga)\n"
+        "  -f, --format FMT       tga | tga-raw | raw (default tga)\n"
+        "  -W, --width N          image width (default 800)\n"
+        "  -H, --height N         image height (default 800)\n"
+        "  -m, --mode MODE        wireframe | points | shaded | hidden-line | feature-line\n"
+        "                         (default shaded)\n"
+        "  -t, --threads N        render threads, 0 = all (default 0)\n"
+        "      --eye X,Y,Z        camera position (default 0,0,3)\n"
+        "      --center X,Y,Z     look-at point (default 0,0,0)\n"
+        "      --up X,Y,Z         up vector (default 0,1,0)\n"
+        "      --ortho            orthographic projection\n"
+        "      --crease DEG       feature-line crease threshold (default 60)\n"
+        "      --no-cull          keep back faces\n"
+        "      --fine-binning     bin in finer chunks for load balance (output is unchanged)\n"
+        "      --repeat N         render N times for timing (default 1)\n"
+        "      --subdivide N      Loop-subdivide the mesh N times before rendering\n"
+        "      --adaptive PX      subdivide only silhouette faces and faces with\n"
+        "                         projected edges longer than PX pixels\n"
+        "      --quantize         keep and draw the mesh in quantized form\n"
+        "      --cache DIR        load meshes through the binary cache in DIR\n"
+        "      --render-cache DIR reuse identical earlier renders stored in DIR\n"
+        "      --batch FILE       run the jobs of a JSON scene/job file\n"
+        "  -j, --jobs N           batch worker threads, 0 = all (default 0)\n";
+}
+
+/**
+ * @brief 解析 "x,y,z"
+ */
+bool parse_vec3(const std::string& s, vec3& out) {
+    std::istringstream in(s);
+    char c1 = 0, c2 = 0;
+    vec3 v;
+    in >> v.x >> c1 >> v.y >> c2 >> v.z;
+    if(!in || c1 != ',' || c2 != ',') return false;
+    out = v;
+    return true;
+}
+
+/**
+ * @brief 解析正整数
+ */
+bool parse_int(const std::string& s, int& out, const int min) {
+    std::istringstream in(s);
+    int v;
+    if(!(in >> v) || !in.eof() || v < min) return false;
+    out = v;
+    return true;
+}
+
+/**
+ * @brief 解析非负实数
+ */
+bool parse_double(const std::string& s, double& out) {
+    std::istringstream in(s);
+    double v;
+    if(!(in >> v) || !in.eof() || v < 0) return false;
+    out = v;
+    return true;
+}
+
+/**
+ * @brief 解析命令行
+ *
+ * @return 参数是否有效
+ */
+bool parse_args(int argc, char** argv, Options& opt) {
+    for(int i = 1; i < argc; i ++) {
+        const std::string arg = argv[i];
+        auto value = [&](std::string& out) {
+            if(i + 1 >= argc) {
+                std::cerr << arg << " needs a value\n";
+                return false;
+            }
+            out = argv[++ i];
+            return true;
+        };
+        std::string v;
+        bool ok = true;
+        if(arg == "-o" || arg == "--output") ok = value(opt.output);
+        else if(arg == "-f" || arg == "--format") ok = value(opt.format) && (opt.format == "tga" || opt.format == "tga-raw" || opt.format == "raw");
+        else if(arg == "-W" || arg == "--width") ok = value(v) && parse_int(v, opt.width, 1);
+        else if(arg == "-H" || arg == "--height") ok = value(v) && parse_int(v, opt.height, 1);
+        else if(arg == "-m" || arg == "--mode") ok = value(v) && RenderSettings::parse_mode(v, opt.settings.mode);
+        else if(arg == "-t" || arg == "--threads") ok = value(v) && parse_int(v, opt.settings.threads, 0);
+        else if(arg == "--eye") ok = value(v) && parse_vec3(v, opt.camera.eye);
+        else if(arg == "--center") ok = value(v) && parse_vec3(v, opt.camera.center);
+        else if(arg == "--up") ok = value(v) && parse_vec3(v, opt.camera.up);
+        else if(arg == "--ortho") opt.camera.persp = false;
+        else if(arg == "--crease") ok = value(v) && parse_double(v, opt.settings.crease_angle);
+        else if(arg == "--no-cull") opt.settings.cull_backfaces = false;
+        else if(arg == "--fine-binning") opt.settings.fine_grained_binning = true;
+        else if(arg == "--repeat") ok = value(v) && parse_int(v, opt.repeat, 1);
+        else if(arg == "--subdivide") ok = value(v) && parse_int(v, opt.subdivide, 0);
+        else if(arg == "--adaptive") ok = value(v) && parse_double(v, opt.adaptive_px);
+        else if(arg == "--quantize") opt.quantize = true;
+        else if(arg == "--cache") ok = value(opt.cache_dir);
+        else if(arg == "--render-cache") ok = value(opt.render_cache);
+        else if(arg == "--batch") ok = value(opt.batch);
+        else if(arg == "-j" || arg == "--jobs") ok = value(v) && parse_int(v, opt.jobs, 0);
+        else if(arg == "-h" || arg == "--help") return false;
+        else if(!arg.empty() && arg[0] == '-') ok = false;
+        else if(opt.mesh.empty()) opt.mesh = arg;
+        else ok = false;
+        if(!ok) {
+            std::cerr << "invalid argument: " << arg << (v.empty() ? "" : " " + v) << "\n";
+            return false;
+        }
+    }
+    if(opt.mesh.empty() == opt.batch.empty()) {
+        std::cerr << "give either a mesh or --batch\n";
+        return false;
+    }
+    if(!opt.camera.valid()) {
+        std::cerr << "degenerate camera: eye equals center or up is parallel to the view direction\n";
+        return false;
+    }
+    return true;
+}
+
+double elapsed_ms(const std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief 执行任务文件
+ *
+ * @return 进程返回值
+ */
+int run_batch_file(const Options& opt) {
+    auto start = std::chrono::steady_clock::now();
+    BatchFile batch;
+    std::unique_ptr<AssetStore> store;
+    if(!opt.cache_dir.empty()) store = std::make_unique<AssetStore>(opt.cache_dir);
+    if(!read_batch_file(opt.batch, batch, store.get())) return 1;
+    const double load_ms = elapsed_ms(start);
+
+    start = std::chrono::steady_clock::now();
+    std::unique_ptr<RenderCache> cache;
+    if(!opt.render_cache.empty()) cache = std::make_unique<RenderCache>(opt.render_cache);
+    const std::vector<JobResult> results = run_batch(batch, opt.jobs, cache.get());
+    const double total_ms = elapsed_ms(start);
+
+    int failed = 0;
+    double render_ms = 0;
+    for(int i = 0; i < (int)results.size(); i ++) {
+        const RenderJob& job = batch.jobs[i];
+        std::printf("job %-4d  %dx%d %s, %.3f ms, %d tiles -> %s%s%s\n", i, job.width, job.height,
+                    RenderSettings::mode_name(job.settings.mode), results[i].render_ms, results[i].stats.tiles_rendered,
+                    job.output.c_str(), results[i].cached ? " (cached)" : "", results[i].ok ? "" : " (FAILED)");
+        failed += !results[i].ok;
+        render_ms += results[i].render_ms;
+    }
+    std::printf("load      %.3f ms (%d meshes, %d scenes)\n", load_ms, (int)batch.meshes.size(), (int)batch.scenes.size());
+    std::printf("render    %.3f ms total, %.3f ms wall for %d jobs\n", render_ms, total_ms, (int)results.size());
+    return failed ? 1 : 0;
+}
+
+} // namespace
+
+/**
+ * @brief 命令行渲染器
+ *
+ * 用法见 usage()。计时统计输出到标准输出。
+ */
+int main(int argc, char** argv) {
+    Options opt;
+    if(!parse_args(argc, argv, opt)) {
+        usage(argv[0]);
+        return 1;
+    }
+    if(!opt.batch.empty()) return run_batch_file(opt);
+
+    auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<const Model> model;
+    if(opt.cache_dir.empty()) model = std::make_shared<const Model>(opt.mesh);
+    else model = AssetStore(opt.cache_dir).model(opt.mesh);
+    const double load_ms = elapsed_ms(start);
+    if(model->nverts() == 0) {
+        std::cerr << "can't load " << opt.mesh << "\n";
+        return 1;
+    }
+    double subdivide_ms = 0;
+    if(opt.subdivide > 0) {
+        start = std::chrono::steady_clock::now();
+        std::vector<char> refine;
+        if(opt.adaptive_px > 0) {
+            const Camera& c = opt.camera;
+            const mat<4,4> to_screen = viewport(0, 0, opt.width, opt.height) * c.view_projection(opt.width, opt.height);
+            refine = Subdivision::select_faces(*model, to_screen, c.persp ? c.eye : c.eye - c.center, c.persp, opt.adaptive_px);
+        }
+        model = std::make_shared<const Model>(Subdivision::loop_adaptive(*model, refine, opt.subdivide));
+        subdivide_ms = elapsed_ms(start);
+    }
+
+    Scene scene;
+    scene.instances.push_back({model});
+    if(opt.quantize) {
+        scene.instances[0].quantized = std::make_shared<const QuantizedModel>(*model);
+        scene.instances[0].model = nullptr;
+    }
+    Renderer renderer(opt.settings);
+    Framebuffer fb(opt.width, opt.height);
+    std::unique_ptr<RenderCache> cache;
+    if(!opt.render_cache.empty()) cache = std::make_unique<RenderCache>(opt.render_cache);
+    RenderStats stats;
+    bool cached = false;
+    double best = 1e300, total = 0;
+    for(int i = 0; i < opt.repeat; i ++) {
+        start = std::chrono::steady_clock::now();
+        if(cache) stats = cache->render(renderer, scene, opt.camera, fb, &cached);
+        else stats = renderer.render(scene, opt.camera, fb);
+        const double ms = elapsed_ms(start);
+        best = std::min(best, ms);
+        total += ms;
+    }
+
+    start = std::chrono::steady_clock::now();
+    if(!write_frame(fb, opt.output, opt.format)) return 1;
+    const double write_ms = elapsed_ms(start);
+
+#ifdef _OPENMP
+    const int threads = opt.settings.threads > 0 ? opt.settings.threads : omp_get_max_threads();
+#else
+    const int threads = 1;
+#endif
+    std::printf("mesh      %s (%d verts, %d faces)\n", opt.mesh.c_str(), model->nverts(), model->nfaces());
+    std::printf("image     %dx%d %s, %d threads\n", opt.width, opt.height, RenderSettings::mode_name(opt.settings.mode), threads);
+    std::printf("load      %.3f ms\n", load_ms);
+    if(opt.subdivide > 0) std::printf("subdivide %.3f ms (%d levels)\n", subdivide_ms, opt.subdivide);
+    std::printf("render    %.3f ms min, %.3f ms mean over %d runs%s\n", best, total / opt.repeat, opt.repeat, cached ? " (cached)" : "");
+    std::printf("tiles     %d rendered, %lld primitives binned\n", stats.tiles_rendered, stats.primitives_binned);
+    std::printf("write     %.3f ms -> %s (%s)\n", write_ms, opt.output.c_str(), opt.format.c_str());
+    return 0;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "io/file_watcher.h"
+#include "model/model.h"
+#include "tga/tgaimage.h"
+
+/**
+ * @brief 常驻进程用的模型与纹理仓库
+ *
+ * 同一路径只加载一次。模型经由二进制缓存 (.tmc) 加载：缓存不旧于源文件及其依赖
+ * （OBJ 引用的 MTL 文件与材质贴图）时直接读缓存，否则解析源文件并重写缓存。
+ * refresh() 通过 FileWatcher 找出变化的源文件，只重新加载受影响的资源；
+ * 已经交出去的 shared_ptr 保持旧内容不变。
+ * 加载失败的资源不缓存，重新加载失败时保留旧内容。
+ */
+class AssetStore {
+public:
+    explicit AssetStore(const std::string cache_dir = {});
+    std::shared_ptr<const Model> model(const std::string& path);
+    void preload(const std::vector<std::string>& paths);
+    std::shared_ptr<const TGAImage> texture(const std::string& path);
+    std::vector<std::string> refresh(const int timeout_ms = 0);
+    std::string cache_path(const std::string& path) const;
+
+private:
+    std::shared_ptr<const Model> load_model(const std::string& path, const bool force, std::vector<std::string>& deps) const;
+    void keep_model(const std::string& key, const std::shared_ptr<const Model>& model, std::vector<std::string>& deps);
+
+    std::string cache_dir = {};     // 为空时缓存写在源文件旁
+    FileWatcher watcher;
+    std::map<std::string, std::shared_ptr<const Model>> models = {};
+    std::map<std::string, std::vector<std::string>> dependencies = {};  // 每个模型的依赖文件，排序去重
+    std::map<std::string, std::shared_ptr<const TGAImage>> textures = {};
+};
@@ -0,0 +1,29 @@
+#pragma once
+#include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 文件变化监视
+ *
+ * Linux 上使用 inotify 监视文件所在目录（编辑器常以“写临时文件 + 改名”的方式保存，
+ * 直接监视文件会丢失事件）；其它平台退化为比较修改时间。
+ */
+class FileWatcher {
+public:
+    FileWatcher();
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+    ~FileWatcher();
+
+    bool watch(const std::string& path);
+    std::vector<std::string> poll(const int timeout_ms = 0);
+
+private:
+    int fd = -1;                                        // inotify 描述符，-1 表示使用轮询
+    std::map<int, std::filesystem::path> dirs = {};     // inotify watch descriptor -> 目录
+    std::set<std::string> files = {};                   // 被监视文件的规范路径
+    std::map<std::string, std::filesystem::file_time_type> stamps = {};  // 轮询模式下的修改时间
+};
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief 64 位 FNV-1a 哈希
+ *
+ * 结果只取决于输入字节，跨平台、跨进程稳定，可用作持久化缓存的键
+ * （std::hash 不保证这一点）。
+ */
+struct Fnv1a {
+    std::uint64_t value = 14695981039346656037ull;
+
+    void bytes(const void* data, const std::size_t size) {
+        const std::uint8_t* p = static_cast<const std::uint8_t*>(data);
+        for(std::size_t i = 0; i < size; i ++) {
+            value ^= p[i];
+            value *= 1099511628211ull;
+        }
+    }
+    void u64(const std::uint64_t v) { bytes(&v, 8); }
+    void f64(const double v) { bytes(&v, 8); }
+    void str(const std::string& s) {
+        u64(s.size());
+        bytes(s.data(), s.size());
+    }
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 只读内存映射文件
+ *
+ * POSIX 平台使用 mmap，其它平台退化为一次性整块读入。
+ * 仅可移动，析构时自动解除映射。
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    ~MappedFile();
+
+    bool open(const std::string filename);
+    void close();
+    const std::uint8_t* data() const;
+    std::size_t size() const;
+    bool is_open() const;
+
+private:
+    const std::uint8_t* ptr = nullptr;
+    std::size_t len = 0;
+    bool mapped = false;                        // true 表示 ptr 来自 mmap
+    std::vector<std::uint8_t> fallback = {};    // 无 mmap 时的读入缓冲
+};
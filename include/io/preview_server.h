@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "io/asset_store.h"
+#include "render/renderer.h"
+
+/**
+ * @brief 一次预览渲染请求
+ *
+ * 在套接字上编码为一行文本：
+ * render <w> <h> <mode> <eye xyz> <center xyz> <up xyz> <persp> <mesh>
+ * mesh 放在行末，可以包含空格。
+ */
+struct PreviewRequest {
+    static constexpr int max_size = 8192;   // 宽、高上限，超过时服务端回复 error 而不分配缓冲
+
+    std::string mesh = {};
+    int width = 0, height = 0;
+    RenderSettings::Mode mode = RenderSettings::SHADED;
+    Camera camera = {};
+
+    std::string to_line() const;
+    static bool parse(const std::string& line, PreviewRequest& out);
+};
+
+/**
+ * @brief 预览渲染结果：width * height 个 BGRA 像素，行主序，原点在左下角
+ */
+struct PreviewFrame {
+    int width = 0, height = 0;
+    double render_ms = 0;
+    std::vector<std::uint32_t> pixels = {};
+};
+
+/**
+ * @brief 常驻预览服务
+ *
+ * 监听 Unix 域套接字，模型经 AssetStore 加载后常驻内存，源文件变化时自动重新加载。
+ * 一个连接上可以连续发送多个请求，每个请求返回
+ * "ok <w> <h> <ms>\n" 加原始像素，或 "error <原因>\n"；"quit" 让服务退出。
+ * 渲染器跨请求复用，相同模型与相机的重复请求只需重绘变化的块。
+ */
+class PreviewServer {
+public:
+    explicit PreviewServer(const std::string socket_path, const std::string cache_dir = {});
+    PreviewServer(const PreviewServer&) = delete;
+    PreviewServer& operator=(const PreviewServer&) = delete;
+    ~PreviewServer();
+
+    bool open();
+    bool serve_one();
+    void run();
+
+private:
+    bool handle(const int client, const std::string& line);
+
+    std::string socket_path = {};
+    int fd = -1;
+    AssetStore store;
+    Renderer renderer;
+    Framebuffer fb;
+};
+
+/**
+ * @brief 预览服务的客户端
+ */
+class PreviewClient {
+public:
+    PreviewClient() = default;
+    PreviewClient(const PreviewClient&) = delete;
+    PreviewClient& operator=(const PreviewClient&) = delete;
+    ~PreviewClient();
+
+    bool connect(const std::string& socket_path);
+    bool render(const PreviewRequest& request, PreviewFrame& frame);
+    void quit();
+
+private:
+    bool read_line(std::string& line);
+
+    int fd = -1;
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief JSON 值（DOM）
+ *
+ * 只读访问时缺失的键或越界的下标返回 null 值，便于链式取值：
+ * `doc["accessors"][0]["count"].number()`。
+ */
+struct JsonValue {
+    enum Type { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT };
+    Type type = NUL;
+    bool boolean = false;
+    double num = 0;
+    std::string text = {};
+    std::vector<JsonValue> items = {};                              // ARRAY
+    std::vector<std::pair<std::string, JsonValue>> members = {};    // OBJECT，保持文件顺序
+
+    const JsonValue& operator[](const std::string& key) const;
+    const JsonValue& operator[](const int i) const;
+    int size() const;
+    bool has(const std::string& key) const;
+    bool is_null() const;
+    double number(const double fallback = 0) const;
+    int integer(const int fallback = 0) const;
+    const std::string& str() const;
+};
+
+bool parse_json(const char* begin, const char* end, JsonValue& out, std::string* error = nullptr);
+bool read_json_file(const std::string filename, JsonValue& out);
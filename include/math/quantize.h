@@ -0,0 +1,109 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "math/geometry.h"
+
+/**
+ * @brief float 转 IEEE 754 半精度（就近舍入到偶数，溢出为无穷）
+ *
+ * @param value
+ * @return std::uint16_t
+ */
+inline std::uint16_t float_to_half(const float value) {
+    std::uint32_t f;
+    std::memcpy(&f, &value, 4);
+    const std::uint32_t sign = (f >> 16) & 0x8000;
+    const std::uint32_t abs = f & 0x7FFFFFFF;
+    if(abs >= 0x7F800000) return sign | 0x7C00 | (abs > 0x7F800000 ? 0x200 : 0);     // Inf / NaN
+    if(abs >= 0x477FF000) return sign | 0x7C00;                                       // 溢出
+    if(abs < 0x38800000) {
+        // 结果为非规格化数或 0
+        if(abs < 0x33000000) return sign;
+        const std::uint32_t mant = (abs & 0x7FFFFF) | 0x800000;
+        const int shift = 126 - int(abs >> 23);
+        std::uint32_t h = mant >> shift;
+        const std::uint32_t rest = mant & ((1u << shift) - 1);
+        const std::uint32_t half = 1u << (shift - 1);
+        if(rest > half || (rest == half && (h & 1))) h ++;
+        return sign | h;
+    }
+    std::uint32_t h = ((abs - 0x38000000) >> 13);
+    const std::uint32_t rest = abs & 0x1FFF;
+    if(rest > 0x1000 || (rest == 0x1000 && (h & 1))) h ++;
+    return sign | h;
+}
+
+/**
+ * @brief IEEE 754 半精度转 float
+ *
+ * @param h
+ * @return float
+ */
+inline float half_to_float(const std::uint16_t h) {
+    const std::uint32_t sign = std::uint32_t(h & 0x8000) << 16;
+    const std::uint32_t exp = (h >> 10) & 0x1F;
+    const std::uint32_t mant = h & 0x3FF;
+    std::uint32_t f;
+    if(exp == 0x1F) f = sign | 0x7F800000 | (mant << 13);
+    else if(exp) f = sign | ((exp + 112) << 23) | (mant << 13);
+    else if(mant) {
+        // 非规格化数：规格化到 float
+        int e = -1;
+        std::uint32_t m = mant;
+        do { m <<= 1; e ++; } while(!(m & 0x400));
+        f = sign | std::uint32_t(112 - e) << 23 | ((m & 0x3FF) << 13);
+    } else f = sign;
+    float ret;
+    std::memcpy(&ret, &f, 4);
+    return ret;
+}
+
+/**
+ * @brief [-1, 1] 映射到 16 位有符号归一化整数
+ */
+inline std::int16_t to_snorm16(const double v) {
+    return std::int16_t(std::lround(std::clamp(v, -1., 1.) * 32767));
+}
+
+/**
+ * @brief 16 位有符号归一化整数映射回 [-1, 1]
+ */
+inline double from_snorm16(const std::int16_t v) {
+    return std::max(v / 32767., -1.);
+}
+
+/**
+ * @brief 单位向量的八面体编码
+ *
+ * 把单位球投影到八面体再展开到 [-1, 1]^2，每个分量 16 位时角度误差约 0.005 度。
+ *
+ * @param n 单位向量
+ * @return vec2 [-1, 1]^2 内的编码
+ */
+inline vec2 oct_encode(const vec3& n) {
+    const double l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    if(l1 <= 0) return {0, 0};
+    vec2 p = {n.x / l1, n.y / l1};
+    if(n.z < 0) {
+        p = {(1 - std::abs(p.y)) * (p.x >= 0 ? 1 : -1), (1 - std::abs(p.x)) * (p.y >= 0 ? 1 : -1)};
+    }
+    return p;
+}
+
+/**
+ * @brief 八面体编码解码为单位向量
+ *
+ * @param e oct_encode 的结果
+ * @return vec3 单位向量
+ */
+inline vec3 oct_decode(const vec2& e) {
+    vec3 n = {e.x, e.y, 1 - std::abs(e.x) - std::abs(e.y)};
+    if(n.z < 0) {
+        n.x = (1 - std::abs(e.y)) * (e.x >= 0 ? 1 : -1);
+        n.y = (1 - std::abs(e.x)) * (e.y >= 0 ? 1 : -1);
+    }
+    return normalized(n);
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+
+#include "model/model.h"
+
+/**
+ * @brief 网格的一条无向边及其两侧的面
+ */
+struct Edge {
+    int v0 = 0, v1 = 0;     // 顶点索引，v0 < v1
+    int f0 = 0, f1 = -1;    // 相邻面，f1 为 -1 表示边界边
+};
+
+/**
+ * @brief 边邻接表
+ *
+ * 由 Model 或 QuantizedModel 的面顶点索引构建：全部 3 * nfaces 条有向边按 (min, max, 角点) 并行排序后，
+ * 相同端点的相邻项即为同一条边。非流形边（多于两个面）按排序顺序两两成对，
+ * 落单的面当作边界边。同时保存每个面的单位法线与每条边的二面角余弦，
+ * 逐视角提取特征边时只需判断朝向。
+ */
+class EdgeAdjacency {
+public:
+    EdgeAdjacency() = default;
+    template<typename Mesh>
+    explicit EdgeAdjacency(const Mesh& model);
+    int nedges() const;
+    const Edge& edge(const int i) const;
+    const vec3& face_normal(const int f) const;
+    double dihedral_cos(const int i) const;
+    template<typename Mesh>
+    std::vector<int> feature_edges(const Mesh& model, const vec3& view, const bool perspective, const double crease_angle) const;
+
+private:
+    std::vector<Edge> edges = {};
+    std::vector<vec3> normals = {};         // 每面单位法线，退化面为零向量
+    std::vector<double> cos_dihedral = {};  // 每条边两侧法线夹角的余弦，边界边为 1
+};
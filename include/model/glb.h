@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "io/mapped_file.h"
+#include "json/json.h"
+
+/**
+ * @brief glTF 访问器在缓冲区上的视图
+ *
+ * 直接指向映射的文件内容，不做拷贝；生命周期不超过所属的 GlbFile。
+ */
+struct AccessorView {
+    enum ComponentType {
+        BYTE = 5120, UNSIGNED_BYTE = 5121, SHORT = 5122,
+        UNSIGNED_SHORT = 5123, UNSIGNED_INT = 5125, FLOAT = 5126
+    };
+    const std::uint8_t* data = nullptr;     // 第 0 个元素
+    int count = 0;                          // 元素个数
+    int stride = 0;                         // 相邻元素的字节间隔
+    int component_type = FLOAT;
+    int components = 0;                     // SCALAR=1, VEC2=2, VEC3=3, VEC4=4, MAT4=16
+    bool normalized = false;
+
+    bool valid() const;
+    double get(const int i, const int c) const;
+    std::uint32_t index(const int i) const;
+};
+
+/**
+ * @brief glTF 2.0 二进制容器 (.glb)
+ *
+ * 文件整体以只读方式映射，JSON 块解析为 DOM，BIN 块及外部 .bin 缓冲区
+ * 均以 AccessorView 的形式原地暴露。
+ */
+class GlbFile {
+public:
+    bool open(const std::string filename);
+    const JsonValue& json() const;
+    AccessorView accessor(const int i) const;
+
+private:
+    MappedFile file = {};
+    JsonValue doc = {};
+    const std::uint8_t* bin = nullptr;          // GLB 内嵌的 BIN 块
+    std::size_t bin_size = 0;
+    std::vector<MappedFile> external = {};      // 以 uri 引用的外部缓冲区，下标同 buffers
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "model/model.h"
+
+/**
+ * @brief 三角网格的半边结构
+ *
+ * 半边 h 属于面 h / 3，同一个面的三条半边连续存放，next / prev / face 由下标算出，
+ * 只需按结构数组（SoA）保存每条半边的起点与对边，以及每个顶点的一条出边，索引均为 32 位。
+ * 构建时把全部半边按 (min, max, 半边号) 并行排序，相邻的一对方向相反的半边互为对边；
+ * 落单的、同向的或多于两条的（非流形）半边没有对边，按边界处理。
+ */
+class HalfEdgeMesh {
+public:
+    static constexpr std::uint32_t invalid = 0xffffffffu;
+
+    HalfEdgeMesh() = default;
+    explicit HalfEdgeMesh(const Model& model);
+    HalfEdgeMesh(const int nverts, const std::vector<std::uint32_t>& triangles);
+
+    int nverts() const { return outgoing.size(); }
+    int nfaces() const { return origin.size() / 3; }
+    int nhalfedges() const { return origin.size(); }
+    int nonmanifold_edges() const { return nonmanifold; }
+
+    std::uint32_t face(const std::uint32_t h) const { return h / 3; }
+    std::uint32_t next(const std::uint32_t h) const { return h % 3 == 2 ? h - 2 : h + 1; }
+    std::uint32_t prev(const std::uint32_t h) const { return h % 3 == 0 ? h + 2 : h - 1; }
+    std::uint32_t twin(const std::uint32_t h) const { return opposite[h]; }
+    std::uint32_t from(const std::uint32_t h) const { return origin[h]; }
+    std::uint32_t to(const std::uint32_t h) const { return origin[next(h)]; }
+    bool is_boundary(const std::uint32_t h) const { return opposite[h] == invalid; }
+    std::uint32_t vertex_halfedge(const std::uint32_t v) const { return outgoing[v]; }
+    bool is_boundary_vertex(const std::uint32_t v) const;
+
+    /**
+     * @brief 按面的绕向依次访问顶点 v 的一环邻点
+     *
+     * 边界顶点从没有对边的出边开始，最后补上扇形另一端的邻点；
+     * 非流形顶点只访问出边所在的那一个扇形。
+     *
+     * @param v
+     * @param visit 对每个邻点调用 visit(邻点, 出边)，扇形末端的邻点出边为 invalid
+     */
+    template<typename Visit>
+    void for_each_neighbor(const std::uint32_t v, Visit&& visit) const {
+        const std::uint32_t start = outgoing[v];
+        if(start == invalid) return;
+        std::uint32_t h = start;
+        do {
+            visit(to(h), h);
+            const std::uint32_t back = prev(h);
+            if(is_boundary(back)) {
+                visit(origin[back], invalid);
+                return;
+            }
+            h = opposite[back];
+        } while(h != start);
+    }
+
+    int valence(const std::uint32_t v) const;
+
+private:
+    void build();
+
+    std::vector<std::uint32_t> origin = {};     // 每条半边的起点
+    std::vector<std::uint32_t> opposite = {};   // 每条半边的对边，invalid 表示边界
+    std::vector<std::uint32_t> outgoing = {};   // 每个顶点的一条出边，边界顶点取没有对边的那条；孤立顶点为 invalid
+    int nonmanifold = 0;                        // 被两个以上半边共享、或两侧绕向不一致的边数
+};
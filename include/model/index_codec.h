@@ -0,0 +1,22 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 三角形索引缓冲的压缩编码
+ *
+ * 每个三角形一个 4 位编码：0 表示独立三角形，其余表示与上一个三角形共享一条
+ * 反向的边（条带相邻），同时记录共享边落在本三角形的哪两个角上，保证角的顺序无损。
+ * 数值部分为 zigzag 差分：独立三角形写 3 个差分，共享边的三角形只写新顶点
+ * 相对“下一个新顶点”（已见最大索引 + 1）的差分，经过缓存优化的网格多数为 0。
+ * 差分序列用 Stream VByte 存储（控制字节与数据字节分离），
+ * x86 上运行时检测到 SSSE3 时用 pshufb 每次解码 4 个值，否则逐字节解码，两者输出相同。
+ */
+std::vector<std::uint8_t> encode_indices(const std::vector<int>& indices);
+bool decode_indices(const std::uint8_t* data, const std::size_t size, std::vector<int>& indices, std::size_t* consumed = nullptr);
+
+std::vector<std::uint8_t> streamvbyte_encode(const std::vector<std::uint32_t>& values);
+bool streamvbyte_decode(const std::uint8_t* data, const std::size_t size, std::vector<std::uint32_t>& values,
+                        std::size_t* consumed = nullptr, const bool simd = true);
+bool streamvbyte_simd_available();
@@ -1,18 +1,110 @@
 #pragma once
+#include <cstdint>
 #include <vector>
 #include <string>
 
 #include "math/geometry.h"
 
+/**
+ * @brief MTL 材质
+ */
+struct Material {
+    std::string name = {};
+    vec3 ambient = {0, 0, 0};       // Ka
+    vec3 diffuse = {1, 1, 1};       // Kd
+    vec3 specular = {0, 0, 0};      // Ks
+    double shininess = 0;           // Ns
+    double opacity = 1;             // d
+    std::string diffuse_map = {};   // map_Kd
+    std::string specular_map = {};  // map_Ks
+    std::string normal_map = {};    // map_Bump / bump / norm
+};
+
+/**
+ * @brief 子网格：同一 o/g 分组且同一材质的一段连续三角形
+ */
+struct Submesh {
+    std::string name = {};  // o/g 名
+    int material = -1;      // 材质索引，-1 表示未指定
+    int first_face = 0;     // 首个三角形
+    int nfaces = 0;         // 三角形个数
+};
+
+/**
+ * @brief 形变目标（blend shape）：只记录被移动的顶点
+ */
+struct MorphTarget {
+    std::string name = {};
+    std::vector<int> indices = {};      // 严格递增的顶点索引
+    std::vector<vec3> deltas = {};      // 与 indices 一一对应的位移
+};
+
 class Model {
+    friend class QuantizedModel;
+    friend class Subdivision;
+    friend class Skinning;
+    friend class MorphBuffer;
+    friend class Renderer;
+
+public:
+    /**
+     * @brief 顶点法线生成时的面权重
+     */
+    enum NormalWeighting { AREA, ANGLE };
+
 private:
     std::vector<vec3> verts = {};       // 顶点
+    std::vector<vec2> tex_coord = {};   // 纹理坐标
+    std::vector<vec3> norms = {};       // 法线
+    std::vector<vec4> tangents = {};    // 切线，w 为副切线方向符号
     std::vector<int> facet_vert = {};   // 面
+    std::vector<int> facet_tex = {};    // 面顶点对应的纹理坐标索引
+    std::vector<int> facet_nrm = {};    // 面顶点对应的法线索引
+    std::vector<int> facet_tan = {};    // 面顶点对应的切线索引，无切线时为空
+    std::vector<int> skin_joints = {};  // 每个顶点 4 个关节索引，无蒙皮时为空
+    std::vector<vec4> skin_weights = {};  // 与 verts 一一对应的 4 个关节权重
+    std::vector<MorphTarget> morph_targets = {};
+    std::vector<Material> materials = {};
+    std::vector<Submesh> submeshes = {};   // 按材质排序，面区间首尾相接
+    std::uint64_t revision = next_revision();   // 进程内唯一，追加形变目标时更新；复制时随内容一起复制
+
+    static std::uint64_t next_revision();
+
+    bool load_obj(const std::string& filename, std::vector<int>& face_submesh);
+    bool load_glb(const std::string& filename, std::vector<int>& face_submesh);
+    bool load_ply(const std::string& filename, std::vector<int>& face_submesh);
+    bool read_cache(const std::string& filename);
+    std::vector<std::uint8_t> cache_bytes() const;
+    int find_material(const std::string& name);
+    bool load_mtl(const std::string& filename);
+    int find_submesh(const std::string& name, const int material);
+    void sort_submeshes(const std::vector<int>& face_submesh);
 
 public:
+    Model() = default;
     Model(const std::string filename);
-    int nverts() const;                                    
-    int nfaces() const;                                    
-    vec3 vert(const int i) const;                          
+    int nverts() const;
+    int nfaces() const;
+    vec3 vert(const int i) const;
     vec3 vert(const int iface, const int nthvert) const;
-};
\ No newline at end of file
+    int facet(const int iface, const int nthvert) const;
+    vec2 uv(const int iface, const int nthvert) const;
+    vec3 normal(const int iface, const int nthvert) const;
+    vec4 tangent(const int iface, const int nthvert) const;
+    bool has_uv() const;
+    bool has_skin() const;
+    int joint(const int i, const int k) const;
+    vec4 weights(const int i) const;
+    bool set_skin(const std::vector<int>& joints, const std::vector<vec4>& weights);
+    int nmorph_targets() const;
+    const MorphTarget& morph_target(const int i) const;
+    bool add_morph_target(const MorphTarget& target);
+    int nsubmeshes() const;
+    const Submesh& submesh(const int i) const;
+    int nmaterials() const;
+    const Material& material(const int i) const;
+    void generate_normals(const NormalWeighting weighting = ANGLE);
+    void generate_tangents();
+    bool write_cache(const std::string& filename) const;
+    std::uint64_t cache_hash() const;
+};
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "model/model.h"
+
+/**
+ * @brief 形变目标的逐帧位置缓冲
+ *
+ * 缓冲保存基础位置加上当前激活目标的位移。每帧只把上一帧被移动过的顶点恢复为基础位置，
+ * 再把权重非零的目标的稀疏位移累加上去，代价与被触及的顶点数成正比，与顶点总数和目标总数无关
+ * （首次求值、换了模型或模型追加了形变目标时整体拷贝一次）。各目标按编号顺序累加，
+ * 单个目标内的顶点互不重复，较大的目标并行累加，结果与线程数无关。
+ */
+class MorphBuffer {
+public:
+    void evaluate(const Model& model, const std::vector<double>& weights);
+    const std::vector<vec3>& positions() const;
+    int touched() const;
+    void reset();
+
+private:
+    std::vector<vec3> pos = {};
+    std::vector<int> moved = {};    // 相对基础位置被移动过的顶点
+    std::vector<char> mark = {};    // 顶点是否在 moved 中
+    const Model* source = nullptr;
+    std::uint64_t source_revision = 0;  // 与地址一起判断是否为同一个模型，地址被新模型复用时不同
+};
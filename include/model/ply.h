@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "io/mapped_file.h"
+
+/**
+ * @brief PLY 元素的一个属性
+ */
+struct PlyProperty {
+    enum Type { NONE = 0, INT8, UINT8, INT16, UINT16, INT32, UINT32, FLOAT32, FLOAT64 };
+    std::string name = {};
+    Type type = NONE;           // 标量类型；列表属性为元素类型
+    Type count_type = NONE;     // 列表长度的类型，NONE 表示标量属性
+    int offset = -1;            // 定长元素内的字节偏移，含列表属性时为 -1
+
+    static int size(const Type t);
+    static double read(const std::uint8_t* p, const Type t);
+};
+
+/**
+ * @brief PLY 元素（vertex / face 等）的数据块
+ */
+struct PlyElement {
+    std::string name = {};
+    int count = 0;
+    std::vector<PlyProperty> props = {};
+    int stride = 0;                     // 定长元素的字节数，含列表属性时为 0
+    const std::uint8_t* data = nullptr; // 数据块起始
+    std::size_t bytes = 0;              // 数据块字节数
+    int uniform_list = 0;               // 唯一属性为列表且所有列表等长时的长度，否则为 0
+
+    int find(const std::string& prop) const;
+};
+
+/**
+ * @brief binary_little_endian 格式的 PLY 文件
+ *
+ * 文件以只读方式映射，各元素的数据块原地暴露。定长元素可按 stride 随机访问；
+ * 单一列表属性的元素（如全部为三角形的 face）在所有列表等长时同样可随机访问，
+ * 否则需要顺序遍历。
+ */
+class PlyFile {
+public:
+    bool open(const std::string filename);
+    const PlyElement* element(const std::string& name) const;
+
+private:
+    MappedFile file = {};
+    std::vector<PlyElement> elements = {};
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "math/geometry.h"
+#include "model/model.h"
+
+/**
+ * @brief 量化压缩的只读网格
+ *
+ * - 位置：相对包围盒量化为 3 x uint16（6 字节，Model 为 24 字节）
+ * - 法线：八面体编码为 2 x snorm16（4 字节）
+ * - 纹理坐标：2 x 半精度浮点（4 字节）
+ * 面索引、材质与子网格与 Model 相同。反量化融合进 transform 的矩阵中，逐顶点没有额外开销。
+ * 可代替 Model 放进 Instance::quantized 常驻并直接渲染，Renderer 用 transform 做顶点变换。
+ */
+class QuantizedModel {
+    friend class Renderer;
+
+public:
+    explicit QuantizedModel(const Model& model);
+    int nverts() const;
+    int nfaces() const;
+    vec3 vert(const int i) const;
+    vec3 vert(const int iface, const int nthvert) const;
+    vec2 uv(const int iface, const int nthvert) const;
+    vec3 normal(const int iface, const int nthvert) const;
+    int facet(const int iface, const int nthvert) const;
+    int nsubmeshes() const;
+    const Submesh& submesh(const int i) const;
+    int nmaterials() const;
+    const Material& material(const int i) const;
+    mat<4,4> dequantize_matrix() const;
+    void transform(const mat<4,4>& m, std::vector<vec4>& out) const;
+    std::size_t vertex_bytes() const;
+    std::uint64_t cache_hash() const;
+
+private:
+    vec3 aabb_min = {};                     // 包围盒最小点
+    vec3 step = {};                         // 每个量化单位对应的长度
+    std::vector<std::uint16_t> pos = {};    // 每顶点 3 个分量
+    std::vector<std::int16_t> nrm = {};     // 每法线 2 个分量
+    std::vector<std::uint16_t> tex = {};    // 每纹理坐标 2 个分量
+    std::vector<int> facet_vert = {};
+    std::vector<int> facet_tex = {};
+    std::vector<int> facet_nrm = {};
+    std::vector<Material> materials = {};
+    std::vector<Submesh> submeshes = {};
+};
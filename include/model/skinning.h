@@ -0,0 +1,33 @@
+#pragma once
+#include <vector>
+
+#include "model/model.h"
+
+/**
+ * @brief 骨骼蒙皮
+ *
+ * 每个顶点受最多 4 个关节影响（Model::joint / Model::weights），关节矩阵为
+ * 关节当前的世界矩阵乘以绑定姿态的逆矩阵。顶点按 8 个一组处理：组内各顶点的
+ * 位置、关节号与权重先转置为按通道排列的 float 数组，混合与变换在通道上用 omp simd 向量化，
+ * 组与组之间并行。输出只有位置，法线需要时按蒙皮后的位置重新生成。
+ *
+ * LINEAR_BLEND 按权重混合矩阵；DUAL_QUATERNION 把关节矩阵的旋转与平移转为对偶四元数后混合，
+ * 关节间转角较大时不会像线性混合那样塌陷，但忽略关节矩阵中的缩放。
+ */
+class Skinning {
+public:
+    enum Method { LINEAR_BLEND, DUAL_QUATERNION };
+    static constexpr int lanes = 8;
+
+    /**
+     * @brief 一个网格的蒙皮任务
+     */
+    struct Job {
+        const Model* model = nullptr;
+        const std::vector<mat<4,4>>* joints = nullptr;
+        std::vector<vec3>* positions = nullptr;    // 输出，大小调整为顶点数
+    };
+
+    static void skin(const Model& model, const std::vector<mat<4,4>>& joints, const Method method, std::vector<vec3>& positions);
+    static void skin_meshes(const std::vector<Job>& jobs, const Method method);
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include <vector>
+
+#include "model/model.h"
+
+/**
+ * @brief Loop 细分
+ *
+ * 每一层先由当前的扁平顶点与索引数组构建 HalfEdgeMesh，再并行计算新顶点
+ * （原顶点按 Loop 规则平滑、每条边插入一个边点）与新三角形，写入新的扁平数组，
+ * 层与层之间不构建 Model。边界按三次 B 样条曲线规则处理。
+ * 面 f 的子三角形紧接着排在前一个面的子三角形之后，子网格与材质因此随面区间保留；
+ * 结果不含纹理坐标，法线按角度加权重新生成。
+ */
+class Subdivision {
+public:
+    static Model loop(const Model& model, const int levels);
+    static Model loop_adaptive(const Model& model, const std::vector<char>& refine, const int levels);
+    static std::vector<char> select_faces(const Model& model, const mat<4,4>& to_screen, const vec3& view,
+                                          const bool perspective, const double max_edge_px);
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "model/model.h"
+
+/**
+ * @brief 稀疏体素网格
+ *
+ * 体素 (x, y, z) 覆盖 origin + [x, x + 1) * size（各轴相同），坐标可为负。
+ * 体素按 8^3 分块，只存放与网格相交的块：每块 8 个 64 位字（每字一层 z，位号 y * 8 + x），
+ * 块坐标经开放寻址哈希表映射到块下标。
+ *
+ * 体素化是保守的：与任一三角形（含边界接触）相交的体素都被置位。
+ * 第一遍并行对三角形包围盒内的体素做分离轴测试，只记录命中所在的块（每线程去重），合并排序去重后建表；
+ * 第二遍重做同样的测试，把命中直接用原子或写入块的位掩码。块只由体素命中产生，不会有体素因缺块而丢失，
+ * 临时内存与非空块数而不是命中体素数成正比。
+ * 块坐标打包为 21 位，体素坐标须在 [-2^23, 2^23) 内。
+ */
+class VoxelGrid {
+public:
+    static constexpr int brick_size = 8;
+
+    VoxelGrid() = default;
+    VoxelGrid(const Model& model, const double voxel_size, const vec3 origin = {0, 0, 0});
+
+    double voxel_size() const;
+    const vec3& origin() const;
+    int nbricks() const;
+    long long count() const;
+    bool occupied(const int x, const int y, const int z) const;
+    vec3 center(const int x, const int y, const int z) const;
+
+private:
+    int find(const std::uint64_t key) const;
+
+    double size = 1;
+    vec3 base = {0, 0, 0};
+    std::vector<std::uint64_t> keys = {};       // 每块的块坐标键
+    std::vector<std::uint64_t> bits = {};       // 每块 8 个字
+    std::vector<std::uint64_t> table_keys = {}; // 哈希表，空槽为 empty_key
+    std::vector<int> table_bricks = {};         // 哈希表槽对应的块下标
+};
@@ -0,0 +1,61 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "io/asset_store.h"
+#include "render/render_cache.h"
+#include "render/renderer.h"
+
+/**
+ * @brief 批处理中的一个渲染任务
+ */
+struct RenderJob {
+    int scene = 0;                  // BatchFile::scenes 下标
+    Camera camera = {};
+    int width = 800, height = 800;
+    RenderSettings settings = {};
+    std::string output = {};
+    std::string format = "tga";     // tga（RLE）/ tga-raw（不压缩）/ raw（BGRA 像素）
+};
+
+/**
+ * @brief 一个任务的执行结果
+ */
+struct JobResult {
+    bool ok = false;
+    bool cached = false;            // 画面取自渲染结果缓存
+    double render_ms = 0;
+    RenderStats stats = {};
+};
+
+/**
+ * @brief 场景与任务文件（JSON）
+ *
+ * ```json
+ * {
+ *   "meshes":  { "cube": "cube.obj" },
+ *   "cameras": { "front": { "eye": [0, 0, 3], "center": [0, 0, 0], "up": [0, 1, 0], "ortho": false } },
+ *   "scenes":  { "two": { "light": [0, 0, 1], "ambient": 0.1,
+ *                         "instances": [ { "mesh": "cube", "translate": [1, 0, 0], "scale": 0.5, "color": [255, 0, 0] } ] } },
+ *   "jobs":    [ { "scene": "two", "camera": "front", "width": 640, "height": 480,
+ *                  "mode": "shaded", "output": "two.tga", "format": "tga" } ]
+ * }
+ * ```
+ *
+ * 相对路径以任务文件所在目录为基准。实例可用 "matrix"（16 个数，行主序）代替
+ * translate / scale；任务的 "camera" 也可以直接写成相机对象。实例的 "scissor" 为
+ * [x0, y0, x1, y1] 裁剪矩形，"stencil" 为模板设置，如
+ * { "func": "not-equal", "ref": 1, "pass": "replace" }，名字见 StencilState::parse_func / parse_op。
+ * 每个网格文件（按规范路径）只加载一次，由所有引用它的实例共享。
+ */
+struct BatchFile {
+    std::vector<std::string> mesh_paths = {};
+    std::vector<std::shared_ptr<const Model>> meshes = {};
+    std::vector<Scene> scenes = {};
+    std::vector<RenderJob> jobs = {};
+};
+
+bool read_batch_file(const std::string& filename, BatchFile& out, AssetStore* store = nullptr);
+std::vector<JobResult> run_batch(const BatchFile& batch, const int threads = 0, RenderCache* cache = nullptr);
+bool write_frame(const Framebuffer& fb, const std::string& filename, const std::string& format);
@@ -0,0 +1,101 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+
+#include "math/geometry.h"
+
+/**
+ * @brief 4x4 单位矩阵
+ */
+inline mat<4,4> identity4() {
+    mat<4,4> m;
+    for(int i = 0; i < 4; i ++) m[i][i] = 1;
+    return m;
+}
+
+/**
+ * @brief 平移矩阵
+ */
+inline mat<4,4> translate(const vec3& t) {
+    mat<4,4> m = identity4();
+    for(int i = 0; i < 3; i ++) m[i][3] = t[i];
+    return m;
+}
+
+/**
+ * @brief 视图矩阵：以 center 为原点，z 轴指向 eye
+ *
+ * @param eye
+ * @param center
+ * @param up
+ * @return mat<4,4>
+ */
+inline mat<4,4> lookat(const vec3& eye, const vec3& center, const vec3& up) {
+    const vec3 z = normalized(eye - center);
+    const vec3 x = normalized(cross(up, z));
+    const vec3 y = normalized(cross(z, x));
+    const mat<4,4> minv = {{{x.x, x.y, x.z, 0}, {y.x, y.y, y.z, 0}, {z.x, z.y, z.z, 0}, {0, 0, 0, 1}}};
+    return minv * translate(vec3{} - center);
+}
+
+/**
+ * @brief 透视投影：w = 1 - z / f，f 为相机到 center 的距离
+ */
+inline mat<4,4> perspective(const double f) {
+    mat<4,4> m = identity4();
+    m[3][2] = -1 / f;
+    return m;
+}
+
+/**
+ * @brief 视口变换：NDC [-1, 1]^2 映射到 [x, x + w] x [y, y + h]
+ */
+inline mat<4,4> viewport(const double x, const double y, const double w, const double h) {
+    return {{{w / 2, 0, 0, x + w / 2}, {0, h / 2, 0, y + h / 2}, {0, 0, 1, 0}, {0, 0, 0, 1}}};
+}
+
+/**
+ * @brief 相机
+ *
+ * NDC 中 z 越大越靠近相机。非正方形画面按短边保持比例。
+ */
+struct Camera {
+    vec3 eye = {0, 0, 3};
+    vec3 center = {0, 0, 0};
+    vec3 up = {0, 1, 0};
+    bool persp = true;      // false 为正交投影
+
+    /**
+     * @brief 世界坐标到裁剪坐标的矩阵
+     *
+     * @param width 画面宽度
+     * @param height 画面高度
+     * @return mat<4,4>
+     */
+    mat<4,4> view_projection(const int width, const int height) const {
+        mat<4,4> aspect = identity4();
+        const double s = std::min(width, height);
+        aspect[0][0] = s / width;
+        aspect[1][1] = s / height;
+        const mat<4,4> proj = persp ? perspective(norm(eye - center)) : identity4();
+        return aspect * proj * lookat(eye, center, up);
+    }
+
+    /**
+     * @brief 能否构成视图矩阵：坐标有限，eye 与 center 不重合，up 不与视线平行
+     */
+    bool valid() const {
+        for(const vec3* v : {&eye, &center, &up})
+            for(int i = 0; i < 3; i ++)
+                if(!std::isfinite((*v)[i])) return false;
+        const vec3 z = eye - center;
+        return norm(z) > 0 && norm(cross(up, z)) > 1e-9 * norm(up) * norm(z);
+    }
+
+    bool operator==(const Camera& o) const {
+        for(int i = 0; i < 3; i ++)
+            if(eye[i] != o.eye[i] || center[i] != o.center[i] || up[i] != o.up[i]) return false;
+        return persp == o.persp;
+    }
+    bool operator!=(const Camera& o) const { return !(*this == o); }
+};
@@ -0,0 +1,114 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tga/tgaimage.h"
+
+/**
+ * @brief 模板测试与模板操作
+ *
+ * 与 OpenGL 相同：测试为 (ref & read_mask) func (value & read_mask)，
+ * 操作的结果只写回 write_mask 中的位。
+ */
+struct StencilState {
+    enum Func { ALWAYS, NEVER, LESS, LESS_EQUAL, GREATER, GREATER_EQUAL, EQUAL, NOT_EQUAL };
+    enum Op { KEEP, ZERO, REPLACE, INCREMENT, INCREMENT_WRAP, DECREMENT, DECREMENT_WRAP, INVERT };
+    bool enabled = false;
+    Func func = ALWAYS;
+    std::uint8_t ref = 0;
+    std::uint8_t read_mask = 0xff;
+    std::uint8_t write_mask = 0xff;
+    Op fail = KEEP;         // 模板测试失败
+    Op depth_fail = KEEP;   // 模板测试通过、深度测试失败
+    Op pass = KEEP;         // 两者都通过
+
+    bool test(const std::uint8_t value) const;
+    void apply(const Op op, std::uint8_t& value) const;
+    bool operator==(const StencilState& o) const;
+    static bool parse_func(const std::string& name, Func& out);
+    static bool parse_op(const std::string& name, Op& out);
+};
+
+/**
+ * @brief 分块渲染用的颜色、深度与 8 位模板缓冲
+ *
+ * 像素按行主序存储，原点在左下角（与 TGAImage::write_tga_file 默认的 vflip 一致）。
+ * 画面划分为 tile_size x tile_size 的块，渲染时各块相互独立。
+ *
+ * 每块记录一个状态：CLEARED 的块只记了清空色，像素数组中的内容作废，
+ * 第一次通过 color / depth / stencil 取可写引用时才填充整块；CONSTANT 的块
+ * 像素数组有效且颜色全部相同；其余为 UNCOMPRESSED。清空因此只需逐块改状态，
+ * 读出（get、resolve、write_tga）时 CLEARED 与 CONSTANT 的块直接按整块颜色处理。
+ */
+class Framebuffer {
+public:
+    static constexpr int tile_size = 32;
+    enum TileState : std::uint8_t { CLEARED, CONSTANT, UNCOMPRESSED };
+
+    Framebuffer() = default;
+    Framebuffer(const int w, const int h);
+    int width() const;
+    int height() const;
+    int tiles_x() const;
+    int tiles_y() const;
+    int ntiles() const;
+
+    void clear(const TGAColor& c);
+    void clear_tile(const int tile, const TGAColor& c);
+    void compact_tile(const int tile);
+    TileState tile_state(const int tile) const;
+    std::uint32_t& color(const int x, const int y);
+    float& depth(const int x, const int y);
+    std::uint8_t& stencil(const int x, const int y);
+    TGAColor get(const int x, const int y) const;
+    void resolve(TGAImage& image) const;
+    bool write_tga(const std::string& filename) const;
+
+    static std::uint32_t pack(const TGAColor& c);
+    static TGAColor unpack(const std::uint32_t c, const int bytespp = 4);
+
+private:
+    int tile_of(const int x, const int y) const { return y / tile_size * ntx + x / tile_size; }
+    void materialize(const int tile);
+
+    int w = 0, h = 0;
+    int ntx = 0;                               // tiles_x()
+    std::vector<std::uint32_t> colors = {};    // BGRA，低字节为 B
+    std::vector<float> depths = {};            // NDC z，越大越近
+    std::vector<std::uint8_t> stencils = {};   // 清空为 0
+    std::vector<TileState> tile_states = {};
+    std::vector<std::uint32_t> tile_colors = {};   // CLEARED 与 CONSTANT 块的颜色
+};
+
+/**
+ * @brief 像素颜色的可写引用（不做越界检查）
+ *
+ * CLEARED 块先被填充，CONSTANT 块变为 UNCOMPRESSED。光栅化内层循环逐像素调用，因此内联。
+ */
+inline std::uint32_t& Framebuffer::color(const int x, const int y) {
+    const int tile = tile_of(x, y);
+    if(tile_states[tile] != UNCOMPRESSED) {
+        if(tile_states[tile] == CLEARED) materialize(tile);
+        tile_states[tile] = UNCOMPRESSED;
+    }
+    return colors[std::size_t(y) * w + x];
+}
+
+/**
+ * @brief 像素深度的可写引用（不做越界检查），CLEARED 块先被填充
+ */
+inline float& Framebuffer::depth(const int x, const int y) {
+    const int tile = tile_of(x, y);
+    if(tile_states[tile] == CLEARED) materialize(tile);
+    return depths[std::size_t(y) * w + x];
+}
+
+/**
+ * @brief 像素模板值的可写引用（不做越界检查），CLEARED 块先被填充
+ */
+inline std::uint8_t& Framebuffer::stencil(const int x, const int y) {
+    const int tile = tile_of(x, y);
+    if(tile_states[tile] == CLEARED) materialize(tile);
+    return stencils[std::size_t(y) * w + x];
+}
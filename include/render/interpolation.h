@@ -0,0 +1,67 @@
+#pragma once
+#include "math/geometry.h"
+
+/**
+ * @brief 屏幕空间平面 f(x, y) = a * x + b * y + c
+ */
+struct Plane {
+    double a = 0, b = 0, c = 0;
+
+    double at(const double x, const double y) const { return a * x + b * y + c; }
+};
+
+/**
+ * @brief 三角形的属性插值设置
+ *
+ * 屏幕空间重心坐标是像素坐标的仿射函数，逐顶点量的任意线性组合因此也是一个平面。
+ * 三角形建立时求出重心坐标、NDC z 与 1/w 的平面，属性按 attr/w 建平面；
+ * 逐像素只需求值几个平面，透视校正时再乘以 1 / (1/w)，不必重算叉积。
+ *
+ * 顶点为 {屏幕 x, 屏幕 y, NDC z, 1/w}。
+ */
+struct TriangleSetup {
+    Plane bary[3] = {};     // 屏幕空间重心坐标，三角形内（含边）三者都不小于 0
+    Plane z = {};           // NDC z，屏幕空间线性
+    Plane inv_w = {};       // 1/w
+    double rw[3] = {};      // 各顶点 1/w
+
+    /**
+     * @brief 建立平面
+     *
+     * @param a
+     * @param b
+     * @param c
+     * @return false 表示三角形退化
+     */
+    bool setup(const vec4& a, const vec4& b, const vec4& c) {
+        const vec4* v[3] = {&a, &b, &c};
+        const double area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+        if(area == 0) return false;
+        for(int i = 0; i < 3; i ++) {
+            // 对边 (p, q) 的有向面积，在顶点 i 处等于 area
+            const vec4& p = *v[(i + 1) % 3];
+            const vec4& q = *v[(i + 2) % 3];
+            bary[i] = {-(q.y - p.y) / area, (q.x - p.x) / area, ((q.y - p.y) * p.x - (q.x - p.x) * p.y) / area};
+            rw[i] = v[i]->w;
+        }
+        z = linear(a.z, b.z, c.z);
+        inv_w = linear(a.w, b.w, c.w);
+        return true;
+    }
+
+    /**
+     * @brief 屏幕空间线性插值的平面
+     */
+    Plane linear(const double f0, const double f1, const double f2) const {
+        return {bary[0].a * f0 + bary[1].a * f1 + bary[2].a * f2,
+                bary[0].b * f0 + bary[1].b * f1 + bary[2].b * f2,
+                bary[0].c * f0 + bary[1].c * f1 + bary[2].c * f2};
+    }
+
+    /**
+     * @brief 透视校正属性的 attr/w 平面，像素处的值除以 inv_w 即为属性值
+     */
+    Plane perspective(const double f0, const double f1, const double f2) const {
+        return linear(f0 * rw[0], f1 * rw[1], f2 * rw[2]);
+    }
+};
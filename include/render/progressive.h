@@ -0,0 +1,44 @@
+#pragma once
+#include <functional>
+#include <vector>
+
+#include "render/renderer.h"
+
+/**
+ * @brief 由粗到细的渐进式渲染
+ *
+ * 依次以 1/coarsest, ..., 1/2, 1 的分辨率渲染，每一遍都用最近邻放大写满目标图像，
+ * 并在写完后调用回调，交互预览因此很快就能显示出低分辨率画面。
+ *
+ * 每个分辨率级别持有自己的 Renderer 与 Framebuffer，跨帧复用：
+ * 相机不变时各级都只重绘变化的块。
+ */
+class ProgressiveRenderer {
+public:
+    /**
+     * @brief 每一遍结束后的回调
+     *
+     * @param pass 从 0 开始的遍数
+     * @param scale 本遍的缩小倍数
+     * @param image 已写入本遍结果的目标图像
+     * @return false 表示取消剩余的遍
+     */
+    using Callback = std::function<bool(const int pass, const int scale, const TGAImage& image)>;
+
+    explicit ProgressiveRenderer(const RenderSettings settings = {}, const int coarsest = 8);
+    void set_settings(const RenderSettings& s);
+    int npasses() const;
+    int render(const Scene& scene, const Camera& camera, TGAImage& image, const Callback& callback = {});
+
+private:
+    /**
+     * @brief 一个分辨率级别
+     */
+    struct Level {
+        int scale;
+        Renderer renderer;
+        Framebuffer fb;
+    };
+
+    std::vector<Level> levels = {};     // 由粗到细
+};
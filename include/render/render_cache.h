@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "render/renderer.h"
+
+/**
+ * @brief 按内容寻址的渲染结果缓存
+ *
+ * 键由渲染全部输入的描述及其哈希组成，描述记录各实例网格的内容哈希（Model 或 QuantizedModel 的 cache_hash）、
+ * 变换与颜色、光照、相机、分辨率、影响画面的设置以及 Renderer::version。
+ * 每个结果连同描述存为 <dir>/<哈希>.trc，读取时描述须一致，命中时直接读回画面，不再渲染。
+ * 可被多个线程共用。
+ */
+class RenderCache {
+public:
+    /**
+     * @brief 一次渲染的键
+     */
+    struct Key {
+        std::uint64_t hash = 0;         // 描述的哈希，决定文件名
+        std::string descriptor = {};    // 全部输入按固定顺序的字节记录
+
+        bool operator==(const Key& o) const { return hash == o.hash && descriptor == o.descriptor; }
+        bool operator!=(const Key& o) const { return !(*this == o); }
+    };
+
+    explicit RenderCache(const std::string dir);
+    Key key(const Scene& scene, const Camera& camera, const RenderSettings& settings, const int width, const int height);
+    bool load(const Key& key, Framebuffer& fb) const;
+    bool store(const Key& key, const Framebuffer& fb) const;
+    RenderStats render(Renderer& renderer, const Scene& scene, const Camera& camera, Framebuffer& fb, bool* hit = nullptr);
+    std::string path(const std::uint64_t key) const;
+
+private:
+    template<typename Mesh>
+    std::uint64_t mesh_hash(const std::shared_ptr<const Mesh>& model);
+
+    std::string dir = {};
+    std::mutex lock;
+    std::map<const void*, std::pair<std::weak_ptr<const void>, std::uint64_t>> mesh_hashes = {};    // 按对象记住网格哈希
+    std::size_t prune_at = 64;      // mesh_hashes 达到此大小时清理已释放的模型
+};
@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "model/edge_adjacency.h"
+#include "render/framebuffer.h"
+#include "render/scene.h"
+
+/**
+ * @brief 渲染参数
+ */
+struct RenderSettings {
+    // HIDDEN_LINE：先只写深度，再画做深度测试的线框；FEATURE_LINE：同样的深度遍，但只画轮廓边、边界边与折痕边
+    enum Mode { WIREFRAME, POINTS, SHADED, HIDDEN_LINE, FEATURE_LINE };
+    Mode mode = SHADED;
+    int threads = 0;                        // 0 表示使用 OpenMP 默认线程数
+    TGAColor background = {0, 0, 0, 255};
+    bool cull_backfaces = true;             // SHADED、HIDDEN_LINE 与 FEATURE_LINE 模式
+    double line_depth_bias = 1e-3;          // HIDDEN_LINE 与 FEATURE_LINE 模式线框深度测试的常数偏移（NDC z）
+    double crease_angle = 60;               // FEATURE_LINE 模式，二面角大于此值（度）的边为折痕
+    bool fine_grained_binning = false;      // 调度提示：分块时切成每线程 4 段以平衡负载，输出不变，不参与比较
+
+    bool operator==(const RenderSettings& o) const;
+    static const char* mode_name(const Mode m);
+    static bool parse_mode(const std::string& name, Mode& out);
+};
+
+/**
+ * @brief 一帧的统计
+ */
+struct RenderStats {
+    int instances_updated = 0;      // 重新做顶点变换的实例数
+    int tiles_rendered = 0;         // 重新光栅化的块数
+    long long primitives_binned = 0;  // 写入块列表的图元引用数
+};
+
+/**
+ * @brief 分块软件光栅化器
+ *
+ * 每帧先并行变换顶点，再把图元按屏幕包围盒并行分到块，最后并行光栅化各块。
+ * 图元被切成连续的段，各段先统计再按前缀和写入同一个按块连续的数组，
+ * 块内顺序因此就是提交顺序，任何设置下输出都是确定的，逐字节与线程数、分段方式无关。
+ *
+ * render_incremental 在相机、分辨率、设置与场景光照都未变时只重绘受影响的块：
+ * 变化（模型指针、变换、颜色、裁剪矩形或模板设置不同）、新增或删除的实例，
+ * 其上一帧与本帧屏幕包围盒覆盖的块被标记为脏，只有这些块被清空并重新光栅化，
+ * 未变化实例的顶点变换结果直接复用。
+ *
+ * 实例的裁剪矩形在分块前就收紧包围盒，矩形外的块与像素不会被光栅化。
+ * 模板缓冲随块一起清空，实例按提交顺序读写，结果同样与线程数无关。
+ */
+class Renderer {
+public:
+    static constexpr int version = 4;   // 输出像素的算法版本，任何改变画面的修改都要递增（渲染结果缓存的键）
+
+    explicit Renderer(const RenderSettings settings = {});
+    const RenderSettings& settings() const;
+    void set_settings(const RenderSettings& s);
+
+    RenderStats render(const Scene& scene, const Camera& camera, Framebuffer& fb);
+    RenderStats render_incremental(const Scene& scene, const Camera& camera, Framebuffer& fb);
+    void invalidate();
+
+private:
+    /**
+     * @brief 单个实例变换到屏幕空间后的数据
+     */
+    struct ScreenMesh {
+        Instance source = {};           // 生成时的实例，用于判断是否变化
+        std::vector<vec4> verts = {};   // 屏幕 x, y，NDC z，1/w；w <= 0 时 w 分量为 0
+        const int* facets = nullptr;    // 网格的面顶点索引，每面 3 个
+        int nfaces = 0;
+        std::vector<vec3> normals = {}; // 每个面顶点的世界空间法线
+        std::vector<vec3> albedo = {};  // 每个面的材质漫反射色
+        std::shared_ptr<const EdgeAdjacency> adjacency = {};   // FEATURE_LINE 模式
+        std::vector<int> features = {}; // FEATURE_LINE 模式本视角的特征边编号
+        int tx0 = 0, ty0 = 0, tx1 = 0, ty1 = 0;   // 覆盖的块范围 [tx0, tx1) x [ty0, ty1)
+    };
+
+    /**
+     * @brief 块列表中的图元引用
+     */
+    struct PrimRef {
+        int instance;
+        int prim;       // 面编号；POINTS 模式为顶点编号；FEATURE_LINE 模式不小于面数时为 features 下标加面数
+    };
+
+    void setup_instance(const Instance& inst, const mat<4,4>& vp, const Framebuffer& fb, ScreenMesh& out) const;
+    template<typename Mesh>
+    void setup_mesh(const Mesh& model, const mat<4,4>& vp, const Framebuffer& fb, ScreenMesh& out) const;
+    void setup_features(const Camera& camera, ScreenMesh& out);
+    template<typename Mesh>
+    void setup_features(const Camera& camera, const std::shared_ptr<const Mesh>& model, ScreenMesh& out);
+    void bin(const Framebuffer& fb, const std::vector<char>& dirty);
+    void depth_tile(const int tile, Framebuffer& fb) const;
+    void raster_tile(const int tile, const Scene& scene, Framebuffer& fb) const;
+    template<bool Stencil>
+    void raster_prim(const PrimRef& ref, const int tile_x0, const int tile_y0, const int tile_x1, const int tile_y1,
+                     const Scene& scene, const vec3& light, Framebuffer& fb) const;
+
+    RenderSettings config = {};
+    std::vector<ScreenMesh> meshes = {};    // 与 scene.instances 一一对应
+    // 每个网格（Model 或 QuantizedModel）的边邻接表，只在网格对象仍存活时复用
+    std::map<const void*, std::pair<std::weak_ptr<const void>, std::shared_ptr<const EdgeAdjacency>>> adjacency = {};
+    std::vector<PrimRef> refs = {};         // 按块连续存放的图元引用，块 t 为 [tile_start[t], tile_start[t + 1])
+    std::vector<long long> tile_start = {};
+    std::vector<long long> cursor = {};     // bin() 中每段每块的计数与写入位置
+    Camera last_camera = {};
+    vec3 last_light = {0, 0, 0};
+    double last_ambient = 0;
+    int last_w = -1, last_h = -1;
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "math/geometry.h"
+#include "model/model.h"
+#include "model/quantized_model.h"
+#include "render/camera.h"
+#include "render/framebuffer.h"
+#include "tga/tgaimage.h"
+
+/**
+ * @brief 裁剪矩形 [x0, x1) x [y0, y1)，像素坐标，原点在左下角
+ */
+struct ScissorRect {
+    bool enabled = false;
+    int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+};
+
+/**
+ * @brief 场景中的一个模型实例，即一次绘制
+ */
+struct Instance {
+    std::shared_ptr<const Model> model = {};
+    mat<4,4> transform = identity4();          // 模型到世界
+    TGAColor color = {255, 255, 255, 255};     // 基色，与材质 Kd 相乘
+    ScissorRect scissor = {};                  // 启用时只绘制矩形内的像素
+    StencilState stencil = {};                 // 启用时按实例顺序做模板测试与模板操作
+    std::shared_ptr<const QuantizedModel> quantized = {};   // 非空时代替 model 绘制
+    // 非空且大小等于网格顶点数时代替网格的顶点位置（模型空间），用于绘制蒙皮与形变目标的结果；
+    // 法线与特征边仍取自网格本身。按指针判断是否变化，新的位置须放进新的对象
+    std::shared_ptr<const std::vector<vec3>> positions = {};
+};
+
+/**
+ * @brief 待渲染的场景
+ */
+struct Scene {
+    std::vector<Instance> instances = {};
+    vec3 light_dir = {0, 0, 1};     // 世界空间中指向光源的方向
+    double ambient = 0.1;           // 环境光强度
+};
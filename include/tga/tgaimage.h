@@ -50,6 +50,7 @@ struct TGAImage {
     void flip_vertically();
     TGAColor get(const int x, const int y) const;
     void set(const int x, const int y, const TGAColor &c);
+    void fill(const int x0, const int y0, const int x1, const int y1, const TGAColor &c);
     int width()  const;
     int height() const;
 private:
@@ -0,0 +1,41 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * @brief 并行排序
+ *
+ * 先把数组切成与线程数相同的段各自排序，再逐轮两两归并相邻段。
+ * less 为严格全序时结果与线程数无关；元素较少时直接 std::sort。
+ *
+ * @tparam T
+ * @tparam Less
+ * @param v
+ * @param less
+ */
+template<typename T, typename Less>
+void parallel_sort(std::vector<T>& v, Less less) {
+#ifdef _OPENMP
+    const int n = v.size();
+    const int chunks = std::min(omp_get_max_threads(), std::max(1, n >> 14));
+    if(chunks > 1) {
+        std::vector<int> bound(chunks + 1);
+        for(int k = 0; k <= chunks; k ++) bound[k] = (long long)n * k / chunks;
+        #pragma omp parallel for schedule(static)
+        for(int k = 0; k < chunks; k ++) std::sort(v.begin() + bound[k], v.begin() + bound[k + 1], less);
+        for(int width = 1; width < chunks; width *= 2) {
+            #pragma omp parallel for schedule(static)
+            for(int k = 0; k < chunks; k += 2 * width) {
+                const int mid = std::min(k + width, chunks), end = std::min(k + 2 * width, chunks);
+                std::inplace_merge(v.begin() + bound[k], v.begin() + bound[mid], v.begin() + bound[end], less);
+            }
+        }
+        return;
+    }
+#endif
+    std::sort(v.begin(), v.end(), less);
+}
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+
+#include "io/asset_store.h"
+#include "io/hash.h"
+
+namespace {
+
+/**
+ * @brief 规范化路径作为仓库的键
+ */
+std::string asset_key(const std::string& path) {
+    std::error_code ec;
+    const std::filesystem::path p = std::filesystem::weakly_canonical(path, ec);
+    return ec ? std::filesystem::absolute(path).string() : p.string();
+}
+
+/**
+ * @brief 模型依赖的其它源文件：OBJ 的 mtllib 引用的 MTL 文件与材质贴图
+ *
+ * @param path 模型源文件（规范路径）
+ * @param model 由源文件解析出的模型
+ * @return std::vector<std::string> 规范路径，排序去重
+ */
+std::vector<std::string> model_dependencies(const std::string& path, const Model& model) {
+    std::vector<std::string> deps;
+    std::string ext = std::filesystem::path(path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    if(ext != ".glb" && ext != ".ply" && ext != ".tmc") {
+        // 与 Model::load_obj 相同：mtllib 之后的整行（去掉首尾空白）是相对 OBJ 所在目录的一个文件
+        const std::filesystem::path dir = std::filesystem::path(path).parent_path();
+        std::ifstream in(path);
+        for(std::string line; std::getline(in, line); ) {
+            if(line.compare(0, 7, "mtllib ")) continue;
+            const size_t begin = line.find_first_not_of(" \t", 7);
+            if(begin == std::string::npos) continue;
+            const size_t end = line.find_last_not_of(" \t\r");
+            deps.push_back(asset_key((dir / line.substr(begin, end - begin + 1)).string()));
+        }
+    }
+    for(int i = 0; i < model.nmaterials(); i ++) {
+        const Material& m = model.material(i);
+        for(const std::string* map : {&m.diffuse_map, &m.specular_map, &m.normal_map})
+            if(!map->empty()) deps.push_back(asset_key(*map));
+    }
+    std::sort(deps.begin(), deps.end());
+    deps.erase(std::unique(deps.begin(), deps.end()), deps.end());
+    return deps;
+}
+
+/**
+ * @brief 读取缓存旁的依赖列表（每行一个路径）
+ *
+ * @return 文件是否存在
+ */
+bool read_dependencies(const std::string& filename, std::vector<std::string>& deps) {
+    std::ifstream in(filename);
+    if(!in.is_open()) return false;
+    deps.clear();
+    for(std::string line; std::getline(in, line); )
+        if(!line.empty()) deps.push_back(line);
+    return true;
+}
+
+/**
+ * @brief 写出缓存旁的依赖列表
+ */
+bool write_dependencies(const std::string& filename, const std::vector<std::string>& deps) {
+    std::ofstream out(filename);
+    for(const std::string& d : deps) out << d << "\n";
+    if(!out.good()) {
+        std::cerr << "can't write " << filename << "\n";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+/**
+ * @brief Construct a new AssetStore object
+ *
+ * @param cache_dir 二进制缓存目录，为空时缓存写在源文件旁（<源文件>.tmc）
+ */
+AssetStore::AssetStore(const std::string cache_dir) : cache_dir(cache_dir) {
+    if(!cache_dir.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(cache_dir, ec);
+    }
+}
+
+/**
+ * @brief 源文件对应的缓存路径
+ *
+ * 放在缓存目录时以完整路径的 FNV-1a 哈希区分同名文件，文件名跨进程、跨平台稳定。
+ *
+ * @param path
+ * @return std::string
+ */
+std::string AssetStore::cache_path(const std::string& path) const {
+    const std::string key = asset_key(path);
+    if(cache_dir.empty()) return key + ".tmc";
+    const std::filesystem::path name = std::filesystem::path(key).filename();
+    Fnv1a h;
+    h.str(key);
+    char hex[24];
+    std::snprintf(hex, sizeof(hex), ".%016llx", (unsigned long long)h.value);
+    return (std::filesystem::path(cache_dir) / (name.string() + hex + ".tmc")).string();
+}
+
+/**
+ * @brief 加载模型，优先使用不旧于源文件及其依赖的缓存
+ *
+ * 依赖列表写在缓存旁（<缓存>.deps）；缺少列表或任一依赖比缓存新时重新解析。
+ *
+ * @param path 源文件
+ * @param force 忽略缓存，重新解析
+ * @param deps 输出模型依赖的 MTL 文件与贴图
+ * @return std::shared_ptr<const Model>
+ */
+std::shared_ptr<const Model> AssetStore::load_model(const std::string& path, const bool force, std::vector<std::string>& deps) const {
+    const std::string cache = cache_path(path);
+    std::error_code e1, e2;
+    const auto src_time = std::filesystem::last_write_time(path, e1);
+    const auto cache_time = std::filesystem::last_write_time(cache, e2);
+    if(!force && !e1 && !e2 && cache_time >= src_time && read_dependencies(cache + ".deps", deps)) {
+        const bool fresh = std::all_of(deps.begin(), deps.end(), [&](const std::string& d) {
+            std::error_code ec;
+            const auto t = std::filesystem::last_write_time(d, ec);
+            return ec || t <= cache_time;
+        });
+        auto cached = fresh ? std::make_shared<Model>(cache) : nullptr;
+        if(cached && (cached->nfaces() > 0 || cached->nverts() > 0)) return cached;
+    }
+    auto model = std::make_shared<Model>(path);
+    deps = model_dependencies(path, *model);
+    if(model->nverts() > 0 && model->write_cache(cache)) write_dependencies(cache + ".deps", deps);
+    return model;
+}
+
+/**
+ * @brief 取模型，首次访问时加载并开始监视源文件及其依赖
+ *
+ * 加载失败的模型不进入仓库，下次访问时重试。
+ *
+ * @param path
+ * @return std::shared_ptr<const Model> 加载失败时为空模型
+ */
+std::shared_ptr<const Model> AssetStore::model(const std::string& path) {
+    const std::string key = asset_key(path);
+    const auto it = models.find(key);
+    if(it != models.end()) return it->second;
+    watcher.watch(key);
+    std::vector<std::string> deps;
+    auto model = load_model(key, false, deps);
+    if(model->nverts() > 0) keep_model(key, model, deps);
+    return model;
+}
+
+/**
+ * @brief 并行加载尚未进入仓库的模型
+ *
+ * 路径按规范路径去重，不同的文件并行加载；之后的 model() 直接取到结果。
+ * 与逐个调用 model() 相同，加载失败的模型不进入仓库。
+ *
+ * @param paths
+ */
+void AssetStore::preload(const std::vector<std::string>& paths) {
+    std::vector<std::string> keys;
+    for(const std::string& p : paths) {
+        std::string key = asset_key(p);
+        if(!models.count(key)) keys.push_back(std::move(key));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    const int n = keys.size();
+    std::vector<std::shared_ptr<const Model>> loaded(n);
+    std::vector<std::vector<std::string>> deps(n);
+    #pragma omp parallel for schedule(dynamic)
+    for(int i = 0; i < n; i ++) loaded[i] = load_model(keys[i], false, deps[i]);
+    for(int i = 0; i < n; i ++) {
+        watcher.watch(keys[i]);
+        if(loaded[i]->nverts() > 0) keep_model(keys[i], loaded[i], deps[i]);
+    }
+}
+
+/**
+ * @brief 把加载成功的模型放进仓库并监视它的依赖
+ */
+void AssetStore::keep_model(const std::string& key, const std::shared_ptr<const Model>& model, std::vector<std::string>& deps) {
+    models[key] = model;
+    for(const std::string& d : deps) watcher.watch(d);
+    dependencies[key] = std::move(deps);
+}
+
+/**
+ * @brief 取纹理，首次访问时加载并开始监视源文件
+ *
+ * 读取失败的纹理不进入仓库，下次访问时重试。
+ *
+ * @param path
+ * @return std::shared_ptr<const TGAImage> 读取失败时为空图
+ */
+std::shared_ptr<const TGAImage> AssetStore::texture(const std::string& path) {
+    const std::string key = asset_key(path);
+    const auto it = textures.find(key);
+    if(it != textures.end()) return it->second;
+    watcher.watch(key);
+    auto image = std::make_shared<TGAImage>();
+    if(image->read_tga_file(key)) textures[key] = image;
+    return image;
+}
+
+/**
+ * @brief 重新加载发生变化的资源
+ *
+ * 模型在源文件或任一依赖（MTL 文件、贴图）变化时重新加载，一次调用中每个模型最多加载一次。
+ *
+ * @param timeout_ms 没有变化时最多等待的毫秒数
+ * @return std::vector<std::string> 被重新加载的资源路径
+ */
+std::vector<std::string> AssetStore::refresh(const int timeout_ms) {
+    std::vector<std::string> reloaded;
+    const std::vector<std::string> changed = watcher.poll(timeout_ms);
+    for(auto& [key, deps] : dependencies) {
+        const bool dirty = std::any_of(changed.begin(), changed.end(), [&](const std::string& file) {
+            return file == key || std::binary_search(deps.begin(), deps.end(), file);
+        });
+        if(!dirty) continue;
+        // 文件可能仍在写入，读到空模型时保留旧内容
+        std::vector<std::string> now;
+        auto model = load_model(key, true, now);
+        if(model->nverts() > 0) {
+            keep_model(key, model, now);
+            reloaded.push_back(key);
+        }
+    }
+    for(const std::string& file : changed) {
+        if(textures.count(file)) {
+            // 读取失败（含截断的文件）时同样保留旧内容
+            auto image = std::make_shared<TGAImage>();
+            if(image->read_tga_file(file)) {
+                textures[file] = image;
+                reloaded.push_back(file);
+            }
+        }
+    }
+    return reloaded;
+}
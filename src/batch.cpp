@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <system_error>
+#include <thread>
+
+#include "json/json.h"
+#include "render/batch.h"
+
+namespace {
+
+/**
+ * @brief 读取长度为 3 的数组
+ *
+ * @return 格式是否正确；值缺失时保持 out 不变并返回 true
+ */
+bool read_vec3(const JsonValue& v, vec3& out) {
+    if(v.is_null()) return true;
+    if(v.type != JsonValue::ARRAY || v.size() != 3) return false;
+    for(int i = 0; i < 3; i ++) out[i] = v[i].number();
+    return true;
+}
+
+/**
+ * @brief 读取 [r, g, b] 或 [r, g, b, a] 颜色
+ */
+bool read_color(const JsonValue& v, TGAColor& out) {
+    if(v.is_null()) return true;
+    if(v.type != JsonValue::ARRAY || (v.size() != 3 && v.size() != 4)) return false;
+    out = {std::uint8_t(std::clamp(v[2].integer(), 0, 255)), std::uint8_t(std::clamp(v[1].integer(), 0, 255)),
+           std::uint8_t(std::clamp(v[0].integer(), 0, 255)), std::uint8_t(std::clamp(v[3].integer(255), 0, 255))};
+    return true;
+}
+
+/**
+ * @brief 读取相机对象，拒绝退化的相机（eye 与 center 重合或 up 与视线平行）
+ */
+bool read_camera(const JsonValue& v, Camera& out) {
+    if(v.type != JsonValue::OBJECT) return false;
+    Camera c;
+    if(!read_vec3(v["eye"], c.eye) || !read_vec3(v["center"], c.center) || !read_vec3(v["up"], c.up)) return false;
+    c.persp = !(v["ortho"].type == JsonValue::BOOL && v["ortho"].boolean);
+    if(!c.valid()) return false;
+    out = c;
+    return true;
+}
+
+/**
+ * @brief 读取实例的模型矩阵："matrix"，或 "translate" 加 "scale"
+ */
+bool read_transform(const JsonValue& v, mat<4,4>& out) {
+    const JsonValue& m = v["matrix"];
+    if(!m.is_null()) {
+        if(m.type != JsonValue::ARRAY || m.size() != 16) return false;
+        for(int i = 0; i < 16; i ++) out[i / 4][i % 4] = m[i].number();
+        return true;
+    }
+    vec3 t = {0, 0, 0}, s = {1, 1, 1};
+    const JsonValue& scale = v["scale"];
+    if(scale.type == JsonValue::NUMBER) s = {scale.num, scale.num, scale.num};
+    else if(!read_vec3(scale, s)) return false;
+    if(!read_vec3(v["translate"], t)) return false;
+    out = translate(t);
+    for(int i = 0; i < 3; i ++) out[i][i] = s[i];
+    return true;
+}
+
+/**
+ * @brief 读取 [x0, y0, x1, y1] 裁剪矩形
+ */
+bool read_scissor(const JsonValue& v, ScissorRect& out) {
+    if(v.is_null()) return true;
+    if(v.type != JsonValue::ARRAY || v.size() != 4) return false;
+    out = {true, v[0].integer(), v[1].integer(), v[2].integer(), v[3].integer()};
+    return true;
+}
+
+/**
+ * @brief 读取模板设置：{"func", "ref", "read_mask", "write_mask", "fail", "depth_fail", "pass"}
+ */
+bool read_stencil(const JsonValue& v, StencilState& out) {
+    if(v.is_null()) return true;
+    if(v.type != JsonValue::OBJECT) return false;
+    StencilState s;
+    s.enabled = true;
+    if(!v["func"].is_null() && !StencilState::parse_func(v["func"].str(), s.func)) return false;
+    for(const auto& [key, op] : {std::pair<const char*, StencilState::Op*>{"fail", &s.fail}, {"depth_fail", &s.depth_fail}, {"pass", &s.pass}})
+        if(!v[key].is_null() && !StencilState::parse_op(v[key].str(), *op)) return false;
+    s.ref = std::clamp(v["ref"].integer(0), 0, 255);
+    s.read_mask = std::clamp(v["read_mask"].integer(255), 0, 255);
+    s.write_mask = std::clamp(v["write_mask"].integer(255), 0, 255);
+    out = s;
+    return true;
+}
+
+/**
+ * @brief 按名字查找，找不到返回 -1
+ */
+int find_name(const std::map<std::string, int>& names, const JsonValue& v) {
+    const auto it = names.find(v.str());
+    return it == names.end() ? -1 : it->second;
+}
+
+} // namespace
+
+/**
+ * @brief 读取任务文件并加载其中的全部网格
+ *
+ * 网格按规范路径去重后并行加载，写法不同但指向同一文件的网格只加载一次、共享同一个模型。
+ * 给出 store 时经由它加载（使用并填充二进制缓存，模型留在仓库中），否则直接解析源文件。
+ *
+ * @param filename
+ * @param out
+ * @param store 资源仓库，可为空
+ * @return 是否成功；失败时输出原因
+ */
+bool read_batch_file(const std::string& filename, BatchFile& out, AssetStore* store) {
+    JsonValue doc;
+    if(!read_json_file(filename, doc)) return false;
+    const std::filesystem::path base = std::filesystem::path(filename).parent_path();
+    auto resolve = [&](const std::string& p) { return std::filesystem::path(p).is_absolute() ? p : (base / p).string(); };
+    auto fail = [&](const std::string& what) {
+        std::cerr << filename << ": " << what << "\n";
+        return false;
+    };
+
+    BatchFile batch;
+    std::map<std::string, int> mesh_names, camera_names, scene_names;
+    for(const auto& [name, path] : doc["meshes"].members) {
+        if(path.type != JsonValue::STRING) return fail("mesh " + name + " needs a path");
+        mesh_names[name] = batch.mesh_paths.size();
+        batch.mesh_paths.push_back(resolve(path.text));
+    }
+    std::vector<Camera> cameras;
+    for(const auto& [name, cam] : doc["cameras"].members) {
+        camera_names[name] = cameras.size();
+        cameras.emplace_back();
+        if(!read_camera(cam, cameras.back())) return fail("bad camera " + name);
+    }
+    std::vector<std::vector<int>> instance_mesh;     // 网格加载完成后再填入实例
+    for(const auto& [name, sc] : doc["scenes"].members) {
+        scene_names[name] = batch.scenes.size();
+        Scene scene;
+        instance_mesh.emplace_back();
+        if(!read_vec3(sc["light"], scene.light_dir)) return fail("bad light in scene " + name);
+        scene.ambient = sc["ambient"].number(scene.ambient);
+        for(const JsonValue& inst : sc["instances"].items) {
+            Instance instance;
+            const int mesh = find_name(mesh_names, inst["mesh"]);
+            if(mesh < 0) return fail("scene " + name + " uses unknown mesh " + inst["mesh"].str());
+            if(!read_transform(inst, instance.transform) || !read_color(inst["color"], instance.color) ||
+               !read_scissor(inst["scissor"], instance.scissor) || !read_stencil(inst["stencil"], instance.stencil))
+                return fail("bad instance in scene " + name);
+            scene.instances.push_back(instance);
+            instance_mesh.back().push_back(mesh);
+        }
+        batch.scenes.push_back(scene);
+    }
+
+    for(const JsonValue& j : doc["jobs"].items) {
+        RenderJob job;
+        job.scene = find_name(scene_names, j["scene"]);
+        if(job.scene < 0) return fail("job uses unknown scene " + j["scene"].str());
+        const JsonValue& cam = j["camera"];
+        if(cam.type == JsonValue::STRING) {
+            const int c = find_name(camera_names, cam);
+            if(c < 0) return fail("job uses unknown camera " + cam.str());
+            job.camera = cameras[c];
+        } else if(!cam.is_null() && !read_camera(cam, job.camera)) {
+            return fail("bad job camera");
+        }
+        job.width = j["width"].integer(job.width);
+        job.height = j["height"].integer(job.height);
+        if(job.width <= 0 || job.height <= 0) return fail("bad job resolution");
+        if(!j["mode"].is_null() && !RenderSettings::parse_mode(j["mode"].str(), job.settings.mode))
+            return fail("unknown mode " + j["mode"].str());
+        if(j["cull"].type == JsonValue::BOOL) job.settings.cull_backfaces = j["cull"].boolean;
+        if(j["fine_grained_binning"].type == JsonValue::BOOL) job.settings.fine_grained_binning = j["fine_grained_binning"].boolean;
+        job.settings.crease_angle = j["crease"].number(job.settings.crease_angle);
+        job.settings.threads = j["threads"].integer(0);
+        if(!read_color(j["background"], job.settings.background)) return fail("bad job background");
+        if(j["output"].type != JsonValue::STRING) return fail("job needs an output");
+        job.output = resolve(j["output"].text);
+        if(!j["format"].is_null()) job.format = j["format"].str();
+        if(job.format != "tga" && job.format != "tga-raw" && job.format != "raw") return fail("unknown format " + job.format);
+        batch.jobs.push_back(job);
+    }
+
+    const int nmeshes = batch.mesh_paths.size();
+    batch.meshes.resize(nmeshes);
+    if(store) {
+        store->preload(batch.mesh_paths);
+        for(int i = 0; i < nmeshes; i ++) batch.meshes[i] = store->model(batch.mesh_paths[i]);
+    } else {
+        std::map<std::string, int> first;       // 规范路径 -> 首个使用它的网格
+        std::vector<int> unique;
+        std::vector<int> source(nmeshes);
+        for(int i = 0; i < nmeshes; i ++) {
+            std::error_code ec;
+            const std::filesystem::path p = std::filesystem::weakly_canonical(batch.mesh_paths[i], ec);
+            const auto [it, inserted] = first.emplace(ec ? batch.mesh_paths[i] : p.string(), i);
+            if(inserted) unique.push_back(i);
+            source[i] = it->second;
+        }
+        #pragma omp parallel for schedule(dynamic)
+        for(int k = 0; k < (int)unique.size(); k ++)
+            batch.meshes[unique[k]] = std::make_shared<const Model>(batch.mesh_paths[unique[k]]);
+        for(int i = 0; i < nmeshes; i ++) batch.meshes[i] = batch.meshes[source[i]];
+    }
+    for(int i = 0; i < nmeshes; i ++)
+        if(batch.meshes[i]->nverts() == 0) return fail("can't load mesh " + batch.mesh_paths[i]);
+    for(int s = 0; s < (int)batch.scenes.size(); s ++)
+        for(int i = 0; i < (int)batch.scenes[s].instances.size(); i ++)
+            batch.scenes[s].instances[i].model = batch.meshes[instance_mesh[s][i]];
+
+    out = std::move(batch);
+    return true;
+}
+
+/**
+ * @brief 用线程池执行全部任务
+ *
+ * 每个工作线程持有自己的 Renderer 与 Framebuffer，按任务顺序领取任务；
+ * 相邻任务的场景相同时增量渲染（相机、分辨率或设置不同时仍整帧重绘），场景不同时整帧重绘。
+ * 多于一个工作线程时，未指定线程数的任务只用一个渲染线程，避免超额订阅。
+ *
+ * @param batch
+ * @param threads 工作线程数，0 表示硬件线程数
+ * @param cache 可选，渲染结果缓存；命中的任务不再渲染
+ * @return std::vector<JobResult> 与 batch.jobs 一一对应
+ */
+std::vector<JobResult> run_batch(const BatchFile& batch, const int threads, RenderCache* cache) {
+    const int njobs = batch.jobs.size();
+    std::vector<JobResult> results(njobs);
+    int nworkers = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+    nworkers = std::max(1, std::min(nworkers, njobs));
+
+    std::atomic<int> next{0};
+    auto worker = [&] {
+        Renderer renderer;
+        Framebuffer fb;
+        int last_scene = -1;
+        for(int i = next ++; i < njobs; i = next ++) {
+            const RenderJob& job = batch.jobs[i];
+            RenderSettings settings = job.settings;
+            if(nworkers > 1 && settings.threads == 0) settings.threads = 1;
+            renderer.set_settings(settings);
+            // 增量状态只在同一个场景的相邻任务之间复用
+            if(job.scene != last_scene) renderer.invalidate();
+            last_scene = job.scene;
+            if(fb.width() != job.width || fb.height() != job.height) fb = Framebuffer(job.width, job.height);
+            const auto start = std::chrono::steady_clock::now();
+            const Scene& scene = batch.scenes[job.scene];
+            if(cache) results[i].stats = cache->render(renderer, scene, job.camera, fb, &results[i].cached);
+            else results[i].stats = renderer.render_incremental(scene, job.camera, fb);
+            results[i].render_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            results[i].ok = write_frame(fb, job.output, job.format);
+        }
+    };
+    std::vector<std::thread> pool;
+    for(int t = 1; t < nworkers; t ++) pool.emplace_back(worker);
+    worker();
+    for(std::thread& t : pool) t.join();
+    return results;
+}
+
+/**
+ * @brief 按格式写出画面
+ *
+ * @param fb
+ * @param filename
+ * @param format tga（RLE）/ tga-raw（不压缩）/ raw（BGRA 像素，行主序，原点在左下角）
+ * @return 是否成功
+ */
+bool write_frame(const Framebuffer& fb, const std::string& filename, const std::string& format) {
+    if(format == "raw") {
+        std::ofstream out(filename, std::ios::binary);
+        for(int y = 0; y < fb.height() && out; y ++) {
+            for(int x = 0; x < fb.width(); x ++) {
+                const std::uint32_t c = Framebuffer::pack(fb.get(x, y));
+                out.write(reinterpret_cast<const char*>(&c), 4);
+            }
+        }
+        if(!out) std::cerr << "can't write " << filename << "\n";
+        return bool(out);
+    }
+    if(format == "tga") return fb.write_tga(filename);
+    TGAImage image;
+    fb.resolve(image);
+    return image.write_tga_file(filename, true, false);
+}
@@ -0,0 +1,112 @@
+#include <cmath>
+#include <cstdint>
+
+#include "model/edge_adjacency.h"
+#include "model/quantized_model.h"
+#include "util/parallel_sort.h"
+
+/**
+ * @brief 构建边邻接表
+ *
+ * @tparam Mesh Model 或 QuantizedModel
+ * @param model
+ */
+template<typename Mesh>
+EdgeAdjacency::EdgeAdjacency(const Mesh& model) {
+    const int nf = model.nfaces();
+    normals.resize(nf);
+    #pragma omp parallel for schedule(static)
+    for(int f = 0; f < nf; f ++) {
+        const vec3 a = model.vert(f, 0);
+        const vec3 n = cross(model.vert(f, 1) - a, model.vert(f, 2) - a);
+        const double len = norm(n);
+        normals[f] = len > 0 ? n / len : vec3{0, 0, 0};
+    }
+
+    // 有向边的键：高 32 位为较小端点，低 32 位为较大端点；角点编号用于打破平局，使排序为全序
+    struct Corner {
+        std::uint64_t key;
+        int corner;
+    };
+    std::vector<Corner> corners(std::size_t(nf) * 3);
+    #pragma omp parallel for schedule(static)
+    for(int f = 0; f < nf; f ++) {
+        for(int k = 0; k < 3; k ++) {
+            const std::uint32_t a = model.facet(f, k), b = model.facet(f, (k + 1) % 3);
+            corners[f * 3 + k] = {std::uint64_t(std::min(a, b)) << 32 | std::max(a, b), f * 3 + k};
+        }
+    }
+    parallel_sort(corners, [](const Corner& l, const Corner& r) {
+        return l.key < r.key || (l.key == r.key && l.corner < r.corner);
+    });
+
+    const int n = corners.size();
+    for(int i = 0; i < n; ) {
+        int j = i;
+        while(j < n && corners[j].key == corners[i].key) j ++;
+        const int v0 = corners[i].key >> 32, v1 = corners[i].key & 0xffffffffu;
+        if(v0 != v1) {
+            for(int k = i; k < j; k += 2) {
+                const int f0 = corners[k].corner / 3;
+                const int f1 = k + 1 < j ? corners[k + 1].corner / 3 : -1;
+                edges.push_back({v0, v1, f0, f1});
+            }
+        }
+        i = j;
+    }
+
+    cos_dihedral.resize(edges.size());
+    const int ne = edges.size();
+    #pragma omp parallel for schedule(static)
+    for(int e = 0; e < ne; e ++)
+        cos_dihedral[e] = edges[e].f1 < 0 ? 1 : normals[edges[e].f0] * normals[edges[e].f1];
+}
+
+int EdgeAdjacency::nedges() const { return edges.size(); }
+const Edge& EdgeAdjacency::edge(const int i) const { return edges[i]; }
+const vec3& EdgeAdjacency::face_normal(const int f) const { return normals[f]; }
+double EdgeAdjacency::dihedral_cos(const int i) const { return cos_dihedral[i]; }
+
+/**
+ * @brief 提取某一视角下的特征边
+ *
+ * 轮廓边：两侧面一个朝前一个朝后；边界边：唯一的面朝前；
+ * 折痕边：二面角大于 crease_angle 且至少一侧朝前。
+ *
+ * @tparam Mesh Model 或 QuantizedModel
+ * @param model 构建时使用的模型
+ * @param view 透视时为模型空间的相机位置，正交时为模型空间中指向相机的方向
+ * @param perspective
+ * @param crease_angle 折痕阈值（度），不小于 180 时不提取折痕
+ * @return std::vector<int> 按边编号升序的特征边
+ */
+template<typename Mesh>
+std::vector<int> EdgeAdjacency::feature_edges(const Mesh& model, const vec3& view, const bool perspective, const double crease_angle) const {
+    const int nf = normals.size();
+    std::vector<char> front(nf);
+    #pragma omp parallel for schedule(static)
+    for(int f = 0; f < nf; f ++) front[f] = normals[f] * (perspective ? view - model.vert(f, 0) : view) > 0;
+
+    const double cos_crease = crease_angle >= 180 ? -2 : std::cos(crease_angle * M_PI / 180);
+    const int ne = edges.size();
+    std::vector<char> keep(ne);
+    #pragma omp parallel for schedule(static)
+    for(int e = 0; e < ne; e ++) {
+        const Edge& edge = edges[e];
+        if(edge.f1 < 0) {
+            keep[e] = front[edge.f0];
+            continue;
+        }
+        const bool a = front[edge.f0], b = front[edge.f1];
+        keep[e] = a != b || ((a || b) && cos_dihedral[e] < cos_crease);
+    }
+    std::vector<int> out;
+    for(int e = 0; e < ne; e ++)
+        if(keep[e]) out.push_back(e);
+    return out;
+}
+
+template EdgeAdjacency::EdgeAdjacency(const Model&);
+template EdgeAdjacency::EdgeAdjacency(const QuantizedModel&);
+template std::vector<int> EdgeAdjacency::feature_edges(const Model&, const vec3&, const bool, const double) const;
+template std::vector<int> EdgeAdjacency::feature_edges(const QuantizedModel&, const vec3&, const bool, const double) const;
@@ -0,0 +1,109 @@
+#include <iostream>
+#include <system_error>
+
+#include "io/file_watcher.h"
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#define TINY_RENDERER_HAS_INOTIFY 1
+#endif
+
+namespace {
+
+/**
+ * @brief 规范化路径，文件不存在时仍返回绝对路径
+ */
+std::filesystem::path canonical_path(const std::string& path) {
+    std::error_code ec;
+    const std::filesystem::path p = std::filesystem::weakly_canonical(path, ec);
+    return ec ? std::filesystem::absolute(path) : p;
+}
+
+/**
+ * @brief 文件修改时间，文件不存在时返回最小值
+ */
+std::filesystem::file_time_type stamp(const std::string& path) {
+    std::error_code ec;
+    const auto t = std::filesystem::last_write_time(path, ec);
+    return ec ? std::filesystem::file_time_type::min() : t;
+}
+
+} // namespace
+
+FileWatcher::FileWatcher() {
+#ifdef TINY_RENDERER_HAS_INOTIFY
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(fd < 0) std::cerr << "inotify unavailable, falling back to polling\n";
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef TINY_RENDERER_HAS_INOTIFY
+    if(fd >= 0) close(fd);
+#endif
+}
+
+/**
+ * @brief 开始监视一个文件
+ *
+ * @param path
+ * @return 监视情况
+ */
+bool FileWatcher::watch(const std::string& path) {
+    const std::filesystem::path p = canonical_path(path);
+    files.insert(p.string());
+    stamps[p.string()] = stamp(p.string());
+#ifdef TINY_RENDERER_HAS_INOTIFY
+    if(fd >= 0) {
+        const std::filesystem::path dir = p.parent_path();
+        const int wd = inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ATTRIB);
+        if(wd < 0) {
+            std::cerr << "can't watch directory " << dir << "\n";
+            return false;
+        }
+        dirs[wd] = dir;
+    }
+#endif
+    return true;
+}
+
+/**
+ * @brief 取出自上次调用以来发生变化的文件
+ *
+ * @param timeout_ms 没有变化时最多等待的毫秒数（仅 inotify 模式下阻塞等待）
+ * @return std::vector<std::string> 变化文件的规范路径，去重
+ */
+std::vector<std::string> FileWatcher::poll(const int timeout_ms) {
+    std::set<std::string> changed;
+#ifdef TINY_RENDERER_HAS_INOTIFY
+    if(fd >= 0) {
+        pollfd pfd = {fd, POLLIN, 0};
+        if(::poll(&pfd, 1, timeout_ms) > 0) {
+            alignas(inotify_event) char buf[4096];
+            ssize_t len;
+            while((len = read(fd, buf, sizeof(buf))) > 0) {
+                for(char* p = buf; p < buf + len;) {
+                    const inotify_event* ev = reinterpret_cast<const inotify_event*>(p);
+                    p += sizeof(inotify_event) + ev->len;
+                    const auto dir = dirs.find(ev->wd);
+                    if(dir == dirs.end() || !ev->len) continue;
+                    const std::string file = (dir->second / ev->name).string();
+                    if(files.count(file)) changed.insert(file);
+                }
+            }
+        }
+        return {changed.begin(), changed.end()};
+    }
+#endif
+    (void)timeout_ms;
+    for(auto& [file, t] : stamps) {
+        const auto now = stamp(file);
+        if(now != t) {
+            t = now;
+            changed.insert(file);
+        }
+    }
+    return {changed.begin(), changed.end()};
+}
@@ -0,0 +1,304 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+#include "render/framebuffer.h"
+
+namespace {
+
+constexpr const char* func_names[] = {"always", "never", "less", "less-equal", "greater", "greater-equal", "equal", "not-equal"};
+constexpr const char* op_names[] = {"keep", "zero", "replace", "increment", "increment-wrap", "decrement", "decrement-wrap", "invert"};
+
+} // namespace
+
+/**
+ * @brief 模板测试
+ *
+ * @param value 缓冲中的模板值
+ * @return 是否通过
+ */
+bool StencilState::test(const std::uint8_t value) const {
+    const int r = ref & read_mask, v = value & read_mask;
+    switch(func) {
+        case NEVER: return false;
+        case LESS: return r < v;
+        case LESS_EQUAL: return r <= v;
+        case GREATER: return r > v;
+        case GREATER_EQUAL: return r >= v;
+        case EQUAL: return r == v;
+        case NOT_EQUAL: return r != v;
+        default: return true;
+    }
+}
+
+/**
+ * @brief 执行模板操作，只改写 write_mask 中的位
+ *
+ * @param op
+ * @param value 缓冲中的模板值
+ */
+void StencilState::apply(const Op op, std::uint8_t& value) const {
+    int v = value;
+    switch(op) {
+        case KEEP: return;
+        case ZERO: v = 0; break;
+        case REPLACE: v = ref; break;
+        case INCREMENT: v = std::min(v + 1, 255); break;
+        case INCREMENT_WRAP: v = (v + 1) & 0xff; break;
+        case DECREMENT: v = std::max(v - 1, 0); break;
+        case DECREMENT_WRAP: v = (v - 1) & 0xff; break;
+        case INVERT: v = ~v & 0xff; break;
+    }
+    value = std::uint8_t((value & ~write_mask) | (v & write_mask));
+}
+
+/**
+ * @brief 设置是否相同
+ */
+bool StencilState::operator==(const StencilState& o) const {
+    return enabled == o.enabled && func == o.func && ref == o.ref && read_mask == o.read_mask &&
+           write_mask == o.write_mask && fail == o.fail && depth_fail == o.depth_fail && pass == o.pass;
+}
+
+/**
+ * @brief 按名字解析比较函数（always / never / less / less-equal / greater / greater-equal / equal / not-equal）
+ */
+bool StencilState::parse_func(const std::string& name, Func& out) {
+    for(int i = 0; i < 8; i ++) {
+        if(name == func_names[i]) {
+            out = Func(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 按名字解析模板操作（keep / zero / replace / increment / increment-wrap / decrement / decrement-wrap / invert）
+ */
+bool StencilState::parse_op(const std::string& name, Op& out) {
+    for(int i = 0; i < 8; i ++) {
+        if(name == op_names[i]) {
+            out = Op(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 分配缓冲，所有块为 CLEARED：颜色为透明黑色，深度为最远，模板为 0
+ *
+ * @param w 宽度（像素）
+ * @param h 高度（像素）
+ */
+Framebuffer::Framebuffer(const int w, const int h)
+    : w(w), h(h), ntx((w + tile_size - 1) / tile_size), colors(std::size_t(w) * h, 0), depths(std::size_t(w) * h, std::numeric_limits<float>::lowest()),
+      stencils(std::size_t(w) * h, 0), tile_states(ntiles(), CLEARED), tile_colors(ntiles(), 0) {}
+
+int Framebuffer::width() const { return w; }
+int Framebuffer::height() const { return h; }
+int Framebuffer::tiles_x() const { return (w + tile_size - 1) / tile_size; }
+int Framebuffer::tiles_y() const { return (h + tile_size - 1) / tile_size; }
+int Framebuffer::ntiles() const { return tiles_x() * tiles_y(); }
+
+/**
+ * @brief 清空整个画面，只改写各块的状态
+ *
+ * @param c 背景色
+ */
+void Framebuffer::clear(const TGAColor& c) {
+    std::fill(tile_states.begin(), tile_states.end(), CLEARED);
+    std::fill(tile_colors.begin(), tile_colors.end(), pack(c));
+}
+
+/**
+ * @brief 清空一个块，只改写块的状态
+ *
+ * @param tile 块编号（行主序）
+ * @param c 背景色
+ */
+void Framebuffer::clear_tile(const int tile, const TGAColor& c) {
+    tile_states[tile] = CLEARED;
+    tile_colors[tile] = pack(c);
+}
+
+/**
+ * @brief 检查 UNCOMPRESSED 块的颜色是否全部相同，是则标为 CONSTANT
+ *
+ * 渲染器在块光栅化结束后调用，只落在包围盒里、没有覆盖像素的块由此恢复为常量块。
+ *
+ * @param tile
+ */
+void Framebuffer::compact_tile(const int tile) {
+    if(tile_states[tile] != UNCOMPRESSED) return;
+    const int x0 = tile % tiles_x() * tile_size, y0 = tile / tiles_x() * tile_size;
+    const int x1 = std::min(x0 + tile_size, w), y1 = std::min(y0 + tile_size, h);
+    const std::uint32_t c = colors[std::size_t(y0) * w + x0];
+    for(int y = y0; y < y1; y ++) {
+        const std::uint32_t* row = &colors[std::size_t(y) * w];
+        if(std::any_of(row + x0, row + x1, [c](const std::uint32_t v) { return v != c; })) return;
+    }
+    tile_states[tile] = CONSTANT;
+    tile_colors[tile] = c;
+}
+
+/**
+ * @brief 块的状态
+ */
+Framebuffer::TileState Framebuffer::tile_state(const int tile) const { return tile_states[tile]; }
+
+/**
+ * @brief 把 CLEARED 块的清空值写入像素数组，块变为 UNCOMPRESSED
+ *
+ * @param tile
+ */
+void Framebuffer::materialize(const int tile) {
+    const int x0 = tile % tiles_x() * tile_size, y0 = tile / tiles_x() * tile_size;
+    const int x1 = std::min(x0 + tile_size, w), y1 = std::min(y0 + tile_size, h);
+    for(int y = y0; y < y1; y ++) {
+        std::fill(colors.begin() + std::size_t(y) * w + x0, colors.begin() + std::size_t(y) * w + x1, tile_colors[tile]);
+        std::fill(depths.begin() + std::size_t(y) * w + x0, depths.begin() + std::size_t(y) * w + x1,
+                  std::numeric_limits<float>::lowest());
+        std::fill(stencils.begin() + std::size_t(y) * w + x0, stencils.begin() + std::size_t(y) * w + x1, 0);
+    }
+    tile_states[tile] = UNCOMPRESSED;
+}
+
+/**
+ * @brief 读取像素颜色
+ *
+ * @return TGAColor 越界时返回默认颜色
+ */
+TGAColor Framebuffer::get(const int x, const int y) const {
+    if(x < 0 || y < 0 || x >= w || y >= h) return {};
+    const int tile = tile_of(x, y);
+    if(tile_states[tile] == CLEARED) return unpack(tile_colors[tile]);
+    return unpack(colors[std::size_t(y) * w + x]);
+}
+
+/**
+ * @brief 把颜色缓冲写入 TGAImage
+ *
+ * 图像尺寸不一致时重新分配为 RGB。CLEARED 与 CONSTANT 块整块填充，其余逐像素复制。
+ *
+ * @param image
+ */
+void Framebuffer::resolve(TGAImage& image) const {
+    if(image.width() != w || image.height() != h) image = TGAImage(w, h, TGAImage::RGB);
+    for(int t = 0; t < ntiles(); t ++) {
+        const int x0 = t % tiles_x() * tile_size, y0 = t / tiles_x() * tile_size;
+        const int x1 = std::min(x0 + tile_size, w), y1 = std::min(y0 + tile_size, h);
+        if(tile_states[t] != UNCOMPRESSED) {
+            image.fill(x0, y0, x1, y1, unpack(tile_colors[t]));
+            continue;
+        }
+        for(int y = y0; y < y1; y ++)
+            for(int x = x0; x < x1; x ++) image.set(x, y, unpack(colors[std::size_t(y) * w + x]));
+    }
+}
+
+/**
+ * @brief 直接把颜色缓冲写成 RLE 压缩的 24 位 TGA
+ *
+ * 与 resolve 后调用 TGAImage::write_tga_file 的结果等价（像素相同，原点在左下角），
+ * 但 CLEARED 与 CONSTANT 块的每一行作为已知长度的同色段整段并入游程，不逐像素比较。
+ *
+ * @param filename
+ * @return 是否成功；失败时输出原因
+ */
+bool Framebuffer::write_tga(const std::string& filename) const {
+    std::ofstream out(filename, std::ios::binary);
+    if(!out.is_open()) {
+        std::cerr << "can't open file " << filename << "\n";
+        return false;
+    }
+    TGAHeader header = {};
+    header.datatypecode = 10;
+    header.width = w;
+    header.height = h;
+    header.bitsperpixel = 24;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // 待写的原样像素与当前游程；游程至少两个像素，每个包最多 128 个像素
+    constexpr int max_packet = 128;
+    std::vector<std::uint32_t> raw;
+    std::uint32_t run_color = 0;
+    int run_length = 0;
+    auto write_pixel = [&](const std::uint32_t c) {
+        const char bgr[3] = {char(c), char(c >> 8), char(c >> 16)};
+        out.write(bgr, 3);
+    };
+    auto flush_raw = [&]() {
+        if(raw.empty()) return;
+        out.put(char(raw.size() - 1));
+        for(const std::uint32_t c : raw) write_pixel(c);
+        raw.clear();
+    };
+    auto flush_run = [&]() {
+        if(run_length == 0) return;
+        out.put(char(run_length - 1 + 128));
+        write_pixel(run_color);
+        run_length = 0;
+    };
+    // 追加 n 个颜色为 c 的像素
+    auto put = [&](std::uint32_t c, int n) {
+        c &= 0xffffff;
+        while(n > 0) {
+            if(run_length > 0 && c != run_color) flush_run();
+            if(run_length == 0) {
+                if(!raw.empty() && raw.back() == c) {
+                    raw.pop_back();
+                    run_length = 1;
+                } else if(n == 1) {
+                    raw.push_back(c);
+                    if((int)raw.size() == max_packet) flush_raw();
+                    return;
+                }
+                flush_raw();
+                run_color = c;
+            }
+            const int take = std::min(n, max_packet - run_length);
+            run_length += take;
+            n -= take;
+            if(run_length == max_packet) flush_run();
+        }
+    };
+    for(int y = 0; y < h; y ++) {
+        const int ty = y / tile_size;
+        for(int tx = 0; tx < tiles_x(); tx ++) {
+            const int t = ty * tiles_x() + tx;
+            const int x0 = tx * tile_size, x1 = std::min(x0 + tile_size, w);
+            if(tile_states[t] != UNCOMPRESSED) {
+                put(tile_colors[t], x1 - x0);
+                continue;
+            }
+            for(int x = x0; x < x1; x ++) put(colors[std::size_t(y) * w + x], 1);
+        }
+    }
+    flush_raw();
+    flush_run();
+
+    constexpr char footer[26] = {0, 0, 0, 0, 0, 0, 0, 0, 'T','R','U','E','V','I','S','I','O','N','-','X','F','I','L','E','.','\0'};
+    out.write(footer, sizeof(footer));
+    if(!out.good()) {
+        std::cerr << "can't write " << filename << "\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief TGAColor 打包为 32 位 BGRA
+ */
+std::uint32_t Framebuffer::pack(const TGAColor& c) {
+    return std::uint32_t(c[0]) | std::uint32_t(c[1]) << 8 | std::uint32_t(c[2]) << 16 | std::uint32_t(c[3]) << 24;
+}
+
+/**
+ * @brief 32 位 BGRA 解包为 TGAColor
+ */
+TGAColor Framebuffer::unpack(const std::uint32_t c, const int bytespp) {
+    return {std::uint8_t(c), std::uint8_t(c >> 8), std::uint8_t(c >> 16), std::uint8_t(c >> 24), std::uint8_t(bytespp)};
+}
@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#include "model/glb.h"
+
+namespace {
+
+constexpr std::uint32_t glb_magic = 0x46546C67;   // "glTF"
+constexpr std::uint32_t chunk_json = 0x4E4F534A;  // "JSON"
+constexpr std::uint32_t chunk_bin = 0x004E4942;   // "BIN\0"
+
+/**
+ * @brief 按小端读取 32 位无符号整数
+ */
+std::uint32_t read_u32(const std::uint8_t* p) {
+    return std::uint32_t(p[0]) | std::uint32_t(p[1]) << 8 | std::uint32_t(p[2]) << 16 | std::uint32_t(p[3]) << 24;
+}
+
+/**
+ * @brief 访问器类型对应的分量个数
+ */
+int type_components(const std::string& type) {
+    if(type == "SCALAR") return 1;
+    if(type == "VEC2") return 2;
+    if(type == "VEC3") return 3;
+    if(type == "VEC4") return 4;
+    if(type == "MAT2") return 4;
+    if(type == "MAT3") return 9;
+    if(type == "MAT4") return 16;
+    return 0;
+}
+
+/**
+ * @brief 分量类型的字节数
+ */
+int component_size(const int type) {
+    switch(type) {
+        case AccessorView::BYTE: case AccessorView::UNSIGNED_BYTE: return 1;
+        case AccessorView::SHORT: case AccessorView::UNSIGNED_SHORT: return 2;
+        case AccessorView::UNSIGNED_INT: case AccessorView::FLOAT: return 4;
+    }
+    return 0;
+}
+
+} // namespace
+
+/**
+ * @brief 视图是否可用
+ */
+bool AccessorView::valid() const {
+    return data != nullptr && components > 0;
+}
+
+/**
+ * @brief 读取第 i 个元素的第 c 个分量，按 glTF 规则处理归一化整数
+ *
+ * @param i
+ * @param c
+ * @return double
+ */
+double AccessorView::get(const int i, const int c) const {
+    const std::uint8_t* p = data + std::size_t(i) * stride + c * component_size(component_type);
+    switch(component_type) {
+        case FLOAT: {
+            float f;
+            std::memcpy(&f, p, 4);
+            return f;
+        }
+        case UNSIGNED_BYTE: return normalized ? p[0] / 255. : p[0];
+        case BYTE: {
+            const double v = std::int8_t(p[0]);
+            return normalized ? std::max(v / 127., -1.) : v;
+        }
+        case UNSIGNED_SHORT: {
+            std::uint16_t v;
+            std::memcpy(&v, p, 2);
+            return normalized ? v / 65535. : v;
+        }
+        case SHORT: {
+            std::int16_t v;
+            std::memcpy(&v, p, 2);
+            return normalized ? std::max(v / 32767., -1.) : v;
+        }
+        case UNSIGNED_INT: {
+            std::uint32_t v;
+            std::memcpy(&v, p, 4);
+            return v;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 读取索引访问器的第 i 个索引
+ *
+ * @param i
+ * @return std::uint32_t
+ */
+std::uint32_t AccessorView::index(const int i) const {
+    const std::uint8_t* p = data + std::size_t(i) * stride;
+    switch(component_type) {
+        case UNSIGNED_BYTE: return p[0];
+        case UNSIGNED_SHORT: {
+            std::uint16_t v;
+            std::memcpy(&v, p, 2);
+            return v;
+        }
+        case UNSIGNED_INT: {
+            std::uint32_t v;
+            std::memcpy(&v, p, 4);
+            return v;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 映射并解析 .glb 文件头、JSON 块与 BIN 块
+ *
+ * @param filename
+ * @return 读取情况
+ */
+bool GlbFile::open(const std::string filename) {
+    if(!file.open(filename)) return false;
+    const std::uint8_t* p = file.data();
+    const std::size_t size = file.size();
+    if(size < 20 || read_u32(p) != glb_magic || read_u32(p + 4) != 2) {
+        std::cerr << filename << " is not a glTF 2.0 binary file\n";
+        return false;
+    }
+    const std::size_t total = std::min<std::size_t>(read_u32(p + 8), size);
+    bool has_json = false;
+    for(std::size_t off = 12; off + 8 <= total;) {
+        const std::size_t len = read_u32(p + off);
+        const std::uint32_t type = read_u32(p + off + 4);
+        const std::uint8_t* chunk = p + off + 8;
+        if(off + 8 + len > total) {
+            std::cerr << filename << ": truncated chunk\n";
+            return false;
+        }
+        if(type == chunk_json && !has_json) {
+            std::string error;
+            if(!parse_json(reinterpret_cast<const char*>(chunk), reinterpret_cast<const char*>(chunk + len), doc, &error)) {
+                std::cerr << filename << ": " << error << "\n";
+                return false;
+            }
+            has_json = true;
+        } else if(type == chunk_bin && !bin) {
+            bin = chunk;
+            bin_size = len;
+        }
+        off += 8 + ((len + 3) & ~std::size_t(3));
+    }
+    if(!has_json) {
+        std::cerr << filename << ": missing JSON chunk\n";
+        return false;
+    }
+
+    const JsonValue& buffers = doc["buffers"];
+    const std::filesystem::path dir = std::filesystem::path(filename).parent_path();
+    external.resize(buffers.size());
+    for(int i = 0; i < buffers.size(); i ++) {
+        const std::string& uri = buffers[i]["uri"].str();
+        if(uri.empty()) continue;
+        if(!uri.compare(0, 5, "data:")) {
+            std::cerr << filename << ": data uri buffers are not supported\n";
+            continue;
+        }
+        external[i].open((dir / uri).string());
+    }
+    return true;
+}
+
+/**
+ * @brief JSON 文档
+ */
+const JsonValue& GlbFile::json() const { return doc; }
+
+/**
+ * @brief 取第 i 个访问器的视图
+ *
+ * 不支持稀疏访问器和无 bufferView 的访问器，此时返回无效视图。
+ *
+ * @param i
+ * @return AccessorView 越界时 valid() 为 false
+ */
+AccessorView GlbFile::accessor(const int i) const {
+    AccessorView view;
+    const JsonValue& acc = doc["accessors"][i];
+    if(acc.is_null() || acc.has("sparse") || !acc.has("bufferView")) return view;
+    const JsonValue& bv = doc["bufferViews"][acc["bufferView"].integer(-1)];
+    const int buffer = bv["buffer"].integer(-1);
+
+    const std::uint8_t* base = nullptr;
+    std::size_t size = 0;
+    if(buffer >= 0 && buffer < (int)external.size() && external[buffer].is_open()) {
+        base = external[buffer].data();
+        size = external[buffer].size();
+    } else if(buffer == 0) {
+        base = bin;
+        size = bin_size;
+    }
+    if(!base) return view;
+
+    view.component_type = acc["componentType"].integer(AccessorView::FLOAT);
+    view.components = type_components(acc["type"].str());
+    view.normalized = acc["normalized"].boolean;
+    view.count = acc["count"].integer(-1);
+    const int elem = view.components * component_size(view.component_type);
+    view.stride = bv["byteStride"].integer(elem);
+
+    // 偏移、长度与个数须为非负整数，步长不小于元素大小，全部元素落在 bufferView 与缓冲区内
+    const int view_offset = bv["byteOffset"].integer(0), acc_offset = acc["byteOffset"].integer(0);
+    const int length = bv["byteLength"].integer(-1);
+    if(elem == 0 || view.count < 0 || view.stride < elem || view_offset < 0 || acc_offset < 0 || length < 0) {
+        view.components = 0;
+        return view;
+    }
+    const std::size_t offset = std::size_t(view_offset) + std::size_t(acc_offset);
+    const std::size_t needed = view.count > 0 ? std::size_t(view.count - 1) * view.stride + elem : 0;
+    if(offset > size || std::size_t(acc_offset) + needed > std::size_t(length) || offset + needed > size) {
+        view.components = 0;
+        return view;
+    }
+    view.data = base + offset;
+    return view;
+}
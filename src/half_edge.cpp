@@ -0,0 +1,88 @@
+#include "model/half_edge.h"
+#include "util/parallel_sort.h"
+
+/**
+ * @brief 由模型的面顶点索引构建
+ *
+ * @param model
+ */
+HalfEdgeMesh::HalfEdgeMesh(const Model& model) : origin(std::size_t(model.nfaces()) * 3), outgoing(model.nverts(), invalid) {
+    const int nf = model.nfaces();
+    #pragma omp parallel for schedule(static)
+    for(int f = 0; f < nf; f ++)
+        for(int k = 0; k < 3; k ++) origin[f * 3 + k] = model.facet(f, k);
+    build();
+}
+
+/**
+ * @brief 由三角形索引数组构建
+ *
+ * @param nverts 顶点数
+ * @param triangles 每 3 个索引一个三角形
+ */
+HalfEdgeMesh::HalfEdgeMesh(const int nverts, const std::vector<std::uint32_t>& triangles)
+    : origin(triangles.begin(), triangles.end() - triangles.size() % 3), outgoing(nverts, invalid) {
+    build();
+}
+
+/**
+ * @brief 匹配对边并为每个顶点选一条出边
+ */
+void HalfEdgeMesh::build() {
+    const int nh = origin.size();
+    opposite.assign(nh, invalid);
+
+    // 键的高 32 位为较小端点，低 32 位为较大端点；半边号打破平局，排序为全序，结果与线程数无关
+    struct Key {
+        std::uint64_t edge;
+        std::uint32_t h;
+    };
+    std::vector<Key> keys(nh);
+    #pragma omp parallel for schedule(static)
+    for(int h = 0; h < nh; h ++) {
+        const std::uint32_t a = origin[h], b = to(h);
+        keys[h] = {std::uint64_t(std::min(a, b)) << 32 | std::max(a, b), std::uint32_t(h)};
+    }
+    parallel_sort(keys, [](const Key& l, const Key& r) { return l.edge < r.edge || (l.edge == r.edge && l.h < r.h); });
+
+    // 每段相同的键只有段首需要处理；两两之间互不重叠，可以并行
+    int bad = 0;
+    #pragma omp parallel for schedule(static) reduction(+:bad)
+    for(int i = 0; i < nh; i ++) {
+        if(i > 0 && keys[i - 1].edge == keys[i].edge) continue;
+        int j = i + 1;
+        while(j < nh && keys[j].edge == keys[i].edge) j ++;
+        const std::uint32_t a = keys[i].h;
+        if(j - i == 2) {
+            const std::uint32_t b = keys[i + 1].h;
+            if(origin[a] == to(b) && origin[a] != origin[b]) {
+                opposite[a] = b;
+                opposite[b] = a;
+                continue;
+            }
+        }
+        if(j - i >= 2) bad ++;
+    }
+    nonmanifold = bad;
+
+    for(int h = nh - 1; h >= 0; h --) {
+        std::uint32_t& out = outgoing[origin[h]];
+        if(out == invalid || !is_boundary(out) || is_boundary(h)) out = h;
+    }
+}
+
+/**
+ * @brief 顶点是否在边界上（包括孤立顶点）
+ */
+bool HalfEdgeMesh::is_boundary_vertex(const std::uint32_t v) const {
+    return outgoing[v] == invalid || is_boundary(outgoing[v]);
+}
+
+/**
+ * @brief 顶点的度（一环邻点数）
+ */
+int HalfEdgeMesh::valence(const std::uint32_t v) const {
+    int n = 0;
+    for_each_neighbor(v, [&](std::uint32_t, std::uint32_t) { n ++; });
+    return n;
+}
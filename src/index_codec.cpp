@@ -0,0 +1,273 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "model/index_codec.h"
+
+// 默认构建不带 -mssse3：x86 上的 GCC / Clang 用 target 属性单独编译 SSSE3 版本，运行时按 CPU 选择
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define STREAMVBYTE_SSSE3 1
+#include <tmmintrin.h>
+#endif
+
+namespace {
+
+/**
+ * @brief 控制字节对应的 4 个值的总字节数
+ */
+struct VByteTables {
+    std::array<std::uint8_t, 256> length = {};
+    std::array<std::array<std::uint8_t, 16>, 256> shuffle = {};   // SSSE3 解码用的重排表
+
+    VByteTables() {
+        for(int c = 0; c < 256; c ++) {
+            int len = 0;
+            for(int k = 0; k < 4; k ++) {
+                const int n = ((c >> (2 * k)) & 3) + 1;
+                for(int b = 0; b < 4; b ++) shuffle[c][k * 4 + b] = b < n ? len + b : 0xFF;
+                len += n;
+            }
+            length[c] = len;
+        }
+    }
+};
+
+const VByteTables vbyte_tables;
+
+/**
+ * @brief 按小端写 32 位整数
+ */
+void put_u32(std::vector<std::uint8_t>& out, const std::uint32_t v) {
+    for(int i = 0; i < 4; i ++) out.push_back((v >> (8 * i)) & 0xFF);
+}
+
+/**
+ * @brief 按小端读 32 位整数
+ */
+std::uint32_t get_u32(const std::uint8_t* p) {
+    return std::uint32_t(p[0]) | std::uint32_t(p[1]) << 8 | std::uint32_t(p[2]) << 16 | std::uint32_t(p[3]) << 24;
+}
+
+/**
+ * @brief 逐个解码 4 值块
+ *
+ * @param control 控制字节
+ * @param ncontrol 控制字节数
+ * @param p 数据字节
+ * @param end 数据字节末尾，其后有 16 字节填充
+ * @param out 输出，长度 ncontrol * 4
+ * @return 数据字节是否够用
+ */
+bool decode_blocks_scalar(const std::uint8_t* control, const std::size_t ncontrol, const std::uint8_t* p,
+                          const std::uint8_t* const end, std::uint32_t* out) {
+    for(std::size_t c = 0; c < ncontrol; c ++, out += 4) {
+        const std::uint8_t key = control[c];
+        const int len = vbyte_tables.length[key];
+        if(p + len > end + (c + 1 == ncontrol ? 16 : 0)) return false;     // 最后一块的补齐值可能读进填充区
+        for(int k = 0; k < 4; k ++) {
+            const int m = ((key >> (2 * k)) & 3) + 1;
+            std::uint32_t v = 0;
+            for(int b = 0; b < m; b ++) v |= std::uint32_t(p[b]) << (8 * b);
+            out[k] = v;
+            p += m;
+        }
+    }
+    return true;
+}
+
+#if defined(STREAMVBYTE_SSSE3)
+/**
+ * @brief 用 pshufb 一次解码 4 值块，参数同 decode_blocks_scalar
+ *
+ * 填充区保证每次可以读满 16 字节。
+ */
+__attribute__((target("ssse3")))
+bool decode_blocks_ssse3(const std::uint8_t* control, const std::size_t ncontrol, const std::uint8_t* p,
+                         const std::uint8_t* const end, std::uint32_t* out) {
+    for(std::size_t c = 0; c < ncontrol; c ++, out += 4) {
+        const std::uint8_t key = control[c];
+        const int len = vbyte_tables.length[key];
+        if(p + len > end + (c + 1 == ncontrol ? 16 : 0)) return false;     // 最后一块的补齐值可能读进填充区
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(vbyte_tables.shuffle[key].data()));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(in, mask));
+        p += len;
+    }
+    return true;
+}
+#endif
+
+std::uint32_t zigzag(const int v) { return (std::uint32_t(v) << 1) ^ std::uint32_t(v >> 31); }
+int unzigzag(const std::uint32_t v) { return int(v >> 1) ^ -int(v & 1); }
+
+} // namespace
+
+/**
+ * @brief Stream VByte 编码
+ *
+ * 格式：值个数(u32) + 数据字节数(u32) + 控制字节 + 数据字节 + 16 字节填充，
+ * 填充保证 SIMD 解码时每次读取 16 字节不越界。
+ *
+ * @param values
+ * @return std::vector<std::uint8_t>
+ */
+std::vector<std::uint8_t> streamvbyte_encode(const std::vector<std::uint32_t>& values) {
+    const std::size_t n = values.size();
+    std::vector<std::uint8_t> control((n + 3) / 4, 0), data;
+    data.reserve(n);
+    for(std::size_t i = 0; i < n; i ++) {
+        const std::uint32_t v = values[i];
+        const int len = v < (1u << 8) ? 1 : v < (1u << 16) ? 2 : v < (1u << 24) ? 3 : 4;
+        control[i / 4] |= (len - 1) << (2 * (i % 4));
+        for(int b = 0; b < len; b ++) data.push_back((v >> (8 * b)) & 0xFF);
+    }
+    std::vector<std::uint8_t> out;
+    out.reserve(8 + control.size() + data.size() + 16);
+    put_u32(out, n);
+    put_u32(out, data.size());
+    out.insert(out.end(), control.begin(), control.end());
+    out.insert(out.end(), data.begin(), data.end());
+    out.insert(out.end(), 16, 0);
+    return out;
+}
+
+/**
+ * @brief 当前 CPU 是否可用 SSSE3 解码
+ */
+bool streamvbyte_simd_available() {
+#if defined(STREAMVBYTE_SSSE3)
+    static const bool available = __builtin_cpu_supports("ssse3");
+    return available;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Stream VByte 解码
+ *
+ * @param data
+ * @param size 可读字节数
+ * @param values 输出
+ * @param consumed 实际读取的字节数（可为空）
+ * @param simd 为 false 时强制使用标量解码（用于对照测试）；CPU 不支持 SSSE3 时总是标量
+ * @return 解码情况，数据不完整时返回 false
+ */
+bool streamvbyte_decode(const std::uint8_t* data, const std::size_t size, std::vector<std::uint32_t>& values,
+                        std::size_t* consumed, const bool simd) {
+    if(size < 8) return false;
+    const std::size_t n = get_u32(data);
+    const std::size_t nbytes = get_u32(data + 4);
+    const std::size_t ncontrol = (n + 3) / 4;
+    const std::size_t total = 8 + ncontrol + nbytes + 16;
+    if(total > size || nbytes < n || nbytes > n * 4) return false;
+    const std::uint8_t* control = data + 8;
+    const std::uint8_t* p = control + ncontrol;
+    const std::uint8_t* const end = p + nbytes;
+
+    values.resize(ncontrol * 4);
+    bool ok;
+#if defined(STREAMVBYTE_SSSE3)
+    if(simd && streamvbyte_simd_available()) ok = decode_blocks_ssse3(control, ncontrol, p, end, values.data());
+    else ok = decode_blocks_scalar(control, ncontrol, p, end, values.data());
+#else
+    (void)simd;
+    ok = decode_blocks_scalar(control, ncontrol, p, end, values.data());
+#endif
+    if(!ok) return false;
+    values.resize(n);
+    if(consumed) *consumed = total;
+    return true;
+}
+
+/**
+ * @brief 编码三角形索引缓冲
+ *
+ * 格式：三角形数(u32) + 4 位编码（每字节 2 个）+ Stream VByte 差分序列。
+ *
+ * @param indices 长度为 3 的倍数；允许 -1 等负值
+ * @return std::vector<std::uint8_t>
+ */
+std::vector<std::uint8_t> encode_indices(const std::vector<int>& indices) {
+    const std::size_t ntri = indices.size() / 3;
+    std::vector<std::uint8_t> codes((ntri + 1) / 2, 0);
+    std::vector<std::uint32_t> deltas;
+    deltas.reserve(indices.size());
+    int last = 0, next = 0;
+    const int* prev = nullptr;
+    for(std::size_t t = 0; t < ntri; t ++) {
+        const int* tri = &indices[t * 3];
+        int code = 0;
+        // 共享边：上一个三角形的边 (prev[e], prev[e+1]) 反向出现在本三角形的角 r+1、r 上
+        for(int e = 0; prev && !code && e < 3; e ++) {
+            const int a = prev[e], b = prev[(e + 1) % 3];
+            for(int r = 0; r < 3; r ++) {
+                if(tri[r] == b && tri[(r + 1) % 3] == a) {
+                    code = 1 + e * 3 + r;
+                    deltas.push_back(zigzag(tri[(r + 2) % 3] - next));
+                    break;
+                }
+            }
+        }
+        if(!code) {
+            deltas.push_back(zigzag(tri[0] - last));
+            deltas.push_back(zigzag(tri[1] - tri[0]));
+            deltas.push_back(zigzag(tri[2] - tri[1]));
+        }
+        codes[t / 2] |= code << (4 * (t % 2));
+        for(int k = 0; k < 3; k ++) next = std::max(next, tri[k] + 1);
+        last = tri[2];
+        prev = tri;
+    }
+    std::vector<std::uint8_t> out;
+    put_u32(out, ntri);
+    out.insert(out.end(), codes.begin(), codes.end());
+    const std::vector<std::uint8_t> values = streamvbyte_encode(deltas);
+    out.insert(out.end(), values.begin(), values.end());
+    return out;
+}
+
+/**
+ * @brief 解码三角形索引缓冲
+ *
+ * @param data
+ * @param size 可读字节数
+ * @param indices 输出
+ * @param consumed 实际读取的字节数（可为空）
+ * @return 解码情况
+ */
+bool decode_indices(const std::uint8_t* data, const std::size_t size, std::vector<int>& indices, std::size_t* consumed) {
+    if(size < 4) return false;
+    const std::size_t ntri = get_u32(data);
+    const std::size_t ncodes = (ntri + 1) / 2;
+    if(4 + ncodes > size) return false;
+    const std::uint8_t* codes = data + 4;
+    std::vector<std::uint32_t> deltas;
+    std::size_t used = 0;
+    if(!streamvbyte_decode(codes + ncodes, size - 4 - ncodes, deltas, &used)) return false;
+
+    indices.resize(ntri * 3);
+    std::size_t d = 0;
+    int last = 0, next = 0;
+    for(std::size_t t = 0; t < ntri; t ++) {
+        const int code = (codes[t / 2] >> (4 * (t % 2))) & 0xF;
+        int* tri = &indices[t * 3];
+        if(code > 9 || (code && t == 0) || d + (code ? 1 : 3) > deltas.size()) return false;
+        if(code) {
+            const int e = (code - 1) / 3, r = (code - 1) % 3;
+            const int* prev = tri - 3;
+            tri[r] = prev[(e + 1) % 3];
+            tri[(r + 1) % 3] = prev[e];
+            tri[(r + 2) % 3] = next + unzigzag(deltas[d ++]);
+        } else {
+            tri[0] = last + unzigzag(deltas[d ++]);
+            tri[1] = tri[0] + unzigzag(deltas[d ++]);
+            tri[2] = tri[1] + unzigzag(deltas[d ++]);
+        }
+        for(int k = 0; k < 3; k ++) next = std::max(next, tri[k] + 1);
+        last = tri[2];
+    }
+    if(d != deltas.size()) return false;
+    if(consumed) *consumed = 4 + ncodes + used;
+    return true;
+}
@@ -0,0 +1,298 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include "json/json.h"
+
+namespace {
+
+/// @brief 缺失值统一返回的 null
+const JsonValue null_value = {};
+
+/**
+ * @brief 递归下降 JSON 解析器
+ */
+struct JsonParser {
+    const char* p;
+    const char* end;
+    std::string error = {};
+
+    void skip_ws() {
+        while(p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p ++;
+    }
+
+    bool fail(const char* what) {
+        if(error.empty()) error = what;
+        return false;
+    }
+
+    bool literal(const char* word) {
+        const char* q = p;
+        for(; *word; word ++, q ++)
+            if(q >= end || *q != *word) return fail("bad literal");
+        p = q;
+        return true;
+    }
+
+    /**
+     * @brief 将码点按 UTF-8 编码追加
+     */
+    static void append_utf8(std::string& s, unsigned cp) {
+        if(cp < 0x80) s += char(cp);
+        else if(cp < 0x800) { s += char(0xC0 | (cp >> 6)); s += char(0x80 | (cp & 0x3F)); }
+        else if(cp < 0x10000) {
+            s += char(0xE0 | (cp >> 12));
+            s += char(0x80 | ((cp >> 6) & 0x3F));
+            s += char(0x80 | (cp & 0x3F));
+        } else {
+            s += char(0xF0 | (cp >> 18));
+            s += char(0x80 | ((cp >> 12) & 0x3F));
+            s += char(0x80 | ((cp >> 6) & 0x3F));
+            s += char(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool hex4(unsigned& cp) {
+        if(end - p < 4) return fail("truncated \\u escape");
+        cp = 0;
+        for(int i = 0; i < 4; i ++, p ++) {
+            const char c = *p;
+            cp <<= 4;
+            if(c >= '0' && c <= '9') cp |= c - '0';
+            else if(c >= 'a' && c <= 'f') cp |= c - 'a' + 10;
+            else if(c >= 'A' && c <= 'F') cp |= c - 'A' + 10;
+            else return fail("bad \\u escape");
+        }
+        return true;
+    }
+
+    bool string(std::string& s) {
+        p ++;   // 跳过 '"'
+        while(p < end && *p != '"') {
+            if(*p != '\\') { s += *p ++; continue; }
+            if(++ p >= end) break;
+            const char c = *p ++;
+            switch(c) {
+                case '"': s += '"'; break;
+                case '\\': s += '\\'; break;
+                case '/': s += '/'; break;
+                case 'b': s += '\b'; break;
+                case 'f': s += '\f'; break;
+                case 'n': s += '\n'; break;
+                case 'r': s += '\r'; break;
+                case 't': s += '\t'; break;
+                case 'u': {
+                    unsigned cp;
+                    if(!hex4(cp)) return false;
+                    // 高代理后须紧跟低代理 [0xDC00, 0xDFFF]；单独的高代理或低代理不是合法的码点
+                    if(cp >= 0xD800 && cp < 0xDC00) {
+                        if(end - p < 6 || p[0] != '\\' || p[1] != 'u') return fail("bad surrogate pair");
+                        p += 2;
+                        unsigned lo;
+                        if(!hex4(lo)) return false;
+                        if(lo < 0xDC00 || lo > 0xDFFF) return fail("bad surrogate pair");
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    } else if(cp >= 0xDC00 && cp <= 0xDFFF) {
+                        return fail("bad surrogate pair");
+                    }
+                    append_utf8(s, cp);
+                    break;
+                }
+                default: return fail("bad escape");
+            }
+        }
+        if(p >= end) return fail("unterminated string");
+        p ++;
+        return true;
+    }
+
+    bool value(JsonValue& v, int depth) {
+        if(depth > 256) return fail("nesting too deep");
+        skip_ws();
+        if(p >= end) return fail("unexpected end");
+        switch(*p) {
+            case '{': {
+                v.type = JsonValue::OBJECT;
+                p ++;
+                skip_ws();
+                if(p < end && *p == '}') { p ++; return true; }
+                while(true) {
+                    skip_ws();
+                    if(p >= end || *p != '"') return fail("expected key");
+                    v.members.emplace_back();
+                    if(!string(v.members.back().first)) return false;
+                    skip_ws();
+                    if(p >= end || *p != ':') return fail("expected ':'");
+                    p ++;
+                    if(!value(v.members.back().second, depth + 1)) return false;
+                    skip_ws();
+                    if(p < end && *p == ',') { p ++; continue; }
+                    if(p < end && *p == '}') { p ++; return true; }
+                    return fail("expected ',' or '}'");
+                }
+            }
+            case '[': {
+                v.type = JsonValue::ARRAY;
+                p ++;
+                skip_ws();
+                if(p < end && *p == ']') { p ++; return true; }
+                while(true) {
+                    v.items.emplace_back();
+                    if(!value(v.items.back(), depth + 1)) return false;
+                    skip_ws();
+                    if(p < end && *p == ',') { p ++; continue; }
+                    if(p < end && *p == ']') { p ++; return true; }
+                    return fail("expected ',' or ']'");
+                }
+            }
+            case '"':
+                v.type = JsonValue::STRING;
+                return string(v.text);
+            case 't':
+                v.type = JsonValue::BOOL;
+                v.boolean = true;
+                return literal("true");
+            case 'f':
+                v.type = JsonValue::BOOL;
+                return literal("false");
+            case 'n':
+                return literal("null");
+            default: {
+                // strtod 需要以 '\0' 结尾的缓冲，数字长度有限，拷贝到栈上
+                char buf[64];
+                int n = 0;
+                while(p + n < end && n < 63 && p[n] && std::strchr("+-0123456789.eE", p[n])) n ++;
+                if(n == 0) return fail("unexpected character");
+                std::copy(p, p + n, buf);
+                buf[n] = '\0';
+                char* stop = nullptr;
+                v.type = JsonValue::NUMBER;
+                v.num = std::strtod(buf, &stop);
+                if(stop != buf + n) return fail("bad number");
+                p += n;
+                return true;
+            }
+        }
+    }
+};
+
+} // namespace
+
+/**
+ * @brief 按键取对象成员
+ *
+ * @param key
+ * @return const JsonValue& 不存在或非对象时返回 null
+ */
+const JsonValue& JsonValue::operator[](const std::string& key) const {
+    for(const auto& m : members)
+        if(m.first == key) return m.second;
+    return null_value;
+}
+
+/**
+ * @brief 按下标取数组元素
+ *
+ * @param i
+ * @return const JsonValue& 越界或非数组时返回 null
+ */
+const JsonValue& JsonValue::operator[](const int i) const {
+    if(i < 0 || i >= (int)items.size()) return null_value;
+    return items[i];
+}
+
+/**
+ * @brief 数组元素个数或对象成员个数
+ */
+int JsonValue::size() const {
+    return type == OBJECT ? members.size() : items.size();
+}
+
+/**
+ * @brief 对象是否含有某键
+ */
+bool JsonValue::has(const std::string& key) const {
+    for(const auto& m : members)
+        if(m.first == key) return true;
+    return false;
+}
+
+/**
+ * @brief 是否为 null（含缺失值）
+ */
+bool JsonValue::is_null() const { return type == NUL; }
+
+/**
+ * @brief 取数值
+ *
+ * @param fallback 非数值时的返回值
+ * @return double
+ */
+double JsonValue::number(const double fallback) const {
+    return type == NUMBER ? num : fallback;
+}
+
+/**
+ * @brief 取整数值，小数部分截断
+ *
+ * @param fallback 非数值、NaN 或超出 int 范围时的返回值
+ * @return int
+ */
+int JsonValue::integer(const int fallback) const {
+    if(type != NUMBER || !(num > std::numeric_limits<int>::min() - 1.) || !(num < std::numeric_limits<int>::max() + 1.)) return fallback;
+    return int(num);
+}
+
+/**
+ * @brief 取字符串，非字符串时返回空串
+ */
+const std::string& JsonValue::str() const {
+    return text;
+}
+
+/**
+ * @brief 解析一段 JSON 文本
+ *
+ * @param begin
+ * @param end
+ * @param out 解析结果
+ * @param error 失败时写入错误描述（可为空）
+ * @return 解析情况
+ */
+bool parse_json(const char* begin, const char* end, JsonValue& out, std::string* error) {
+    JsonParser parser{begin, end};
+    out = {};
+    bool ok = parser.value(out, 0);
+    parser.skip_ws();
+    if(ok && parser.p != end) ok = parser.fail("trailing characters");
+    if(!ok && error) *error = parser.error + " at offset " + std::to_string(parser.p - begin);
+    return ok;
+}
+
+/**
+ * @brief 读取并解析 JSON 文件
+ *
+ * @param filename
+ * @param out 解析结果
+ * @return 读取情况
+ */
+bool read_json_file(const std::string filename, JsonValue& out) {
+    std::ifstream in(filename, std::ios::binary);
+    if(!in.is_open()) {
+        std::cerr << "can't open file " << filename << "\n";
+        return false;
+    }
+    std::stringstream ss;
+    ss << in.rdbuf();
+    const std::string text = ss.str();
+    std::string error;
+    if(!parse_json(text.data(), text.data() + text.size(), out, &error)) {
+        std::cerr << filename << ": " << error << "\n";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,113 @@
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+#include "io/mapped_file.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TINY_RENDERER_HAS_MMAP 1
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if(this == &other) return *this;
+    close();
+    ptr = std::exchange(other.ptr, nullptr);
+    len = std::exchange(other.len, 0);
+    mapped = std::exchange(other.mapped, false);
+    fallback = std::move(other.fallback);
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+/**
+ * @brief 映射整个文件
+ *
+ * @param filename
+ * @return 打开情况；空文件视为成功，data() 为 nullptr
+ */
+bool MappedFile::open(const std::string filename) {
+    close();
+#ifdef TINY_RENDERER_HAS_MMAP
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0) {
+        std::cerr << "can't open file " << filename << "\n";
+        return false;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0) {
+        ::close(fd);
+        std::cerr << "can't stat file " << filename << "\n";
+        return false;
+    }
+    len = st.st_size;
+    if(len > 0) {
+        void* p = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(p == MAP_FAILED) {
+            ::close(fd);
+            len = 0;
+            std::cerr << "can't map file " << filename << "\n";
+            return false;
+        }
+        ptr = static_cast<const std::uint8_t*>(p);
+        mapped = true;
+    }
+    ::close(fd);
+    return true;
+#else
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    if(!in.is_open()) {
+        std::cerr << "can't open file " << filename << "\n";
+        return false;
+    }
+    fallback.resize(in.tellg());
+    in.seekg(0);
+    in.read(reinterpret_cast<char *>(fallback.data()), fallback.size());
+    if(!in.good() && !fallback.empty()) {
+        std::cerr << "an error occured while reading " << filename << "\n";
+        fallback.clear();
+        return false;
+    }
+    ptr = fallback.empty() ? nullptr : fallback.data();
+    len = fallback.size();
+    return true;
+#endif
+}
+
+/**
+ * @brief 解除映射
+ */
+void MappedFile::close() {
+#ifdef TINY_RENDERER_HAS_MMAP
+    if(mapped && ptr) munmap(const_cast<std::uint8_t*>(ptr), len);
+#endif
+    ptr = nullptr;
+    len = 0;
+    mapped = false;
+    fallback.clear();
+}
+
+/**
+ * @brief 文件内容起始地址
+ */
+const std::uint8_t* MappedFile::data() const { return ptr; }
+
+/**
+ * @brief 文件字节数
+ */
+std::size_t MappedFile::size() const { return len; }
+
+/**
+ * @brief 是否持有文件内容
+ */
+bool MappedFile::is_open() const { return ptr != nullptr; }
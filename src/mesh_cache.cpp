@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+#include "io/hash.h"
+#include "io/mapped_file.h"
+#include "model/index_codec.h"
+#include "model/model.h"
+
+namespace {
+
+constexpr char cache_magic[4] = {'T', 'R', 'M', 'C'};
+constexpr std::uint32_t cache_version = 4;
+
+/**
+ * @brief 二进制缓存的顺序写入器
+ */
+struct CacheWriter {
+    std::vector<std::uint8_t> buf = {};
+
+    void bytes(const void* p, const std::size_t n) {
+        const std::uint8_t* b = static_cast<const std::uint8_t*>(p);
+        buf.insert(buf.end(), b, b + n);
+    }
+    void u32(const std::uint32_t v) { bytes(&v, 4); }
+    void f64(const double v) { bytes(&v, 8); }
+    void str(const std::string& s) {
+        u32(s.size());
+        bytes(s.data(), s.size());
+    }
+    template<int n> void vecs(const std::vector<vec<n>>& v) {
+        u32(v.size());
+        for(const vec<n>& e : v)
+            for(int i = 0; i < n; i ++) f64(e[i]);
+    }
+    void indices(const std::vector<int>& idx) {
+        const std::vector<std::uint8_t> enc = encode_indices(idx);
+        u32(enc.size());
+        bytes(enc.data(), enc.size());
+    }
+};
+
+/**
+ * @brief 二进制缓存的顺序读取器，越界后 ok 置为 false
+ */
+struct CacheReader {
+    const std::uint8_t* p;
+    const std::uint8_t* end;
+    bool ok = true;
+
+    bool take(void* dst, const std::size_t n) {
+        if(!ok || std::size_t(end - p) < n) return ok = false;
+        std::memcpy(dst, p, n);
+        p += n;
+        return true;
+    }
+    std::uint32_t u32() { std::uint32_t v = 0; take(&v, 4); return v; }
+    double f64() { double v = 0; take(&v, 8); return v; }
+    std::string str() {
+        const std::uint32_t n = u32();
+        if(!ok || std::size_t(end - p) < n) { ok = false; return {}; }
+        std::string s(reinterpret_cast<const char*>(p), n);
+        p += n;
+        return s;
+    }
+    template<int n> void vecs(std::vector<vec<n>>& v) {
+        const std::uint32_t count = u32();
+        if(!ok || std::size_t(end - p) / (8 * n) < count) { ok = false; return; }
+        v.resize(count);
+        for(vec<n>& e : v)
+            for(int i = 0; i < n; i ++) e[i] = f64();
+    }
+    void indices(std::vector<int>& idx) {
+        const std::uint32_t n = u32();
+        if(!ok || std::size_t(end - p) < n || !decode_indices(p, n, idx)) { ok = false; return; }
+        p += n;
+    }
+};
+
+} // namespace
+
+/**
+ * @brief 序列化为二进制网格缓存 (.tmc) 的字节
+ *
+ * 顶点属性（含蒙皮关节与权重、稀疏形变目标）按原样存储，顶点、纹理坐标、法线与切线四条面索引流用 index_codec 压缩，
+ * 材质与子网格一并保存，读回后与原模型完全一致。
+ *
+ * @return std::vector<std::uint8_t>
+ */
+std::vector<std::uint8_t> Model::cache_bytes() const {
+    CacheWriter w;
+    w.bytes(cache_magic, 4);
+    w.u32(cache_version);
+    w.vecs(verts);
+    w.vecs(tex_coord);
+    w.vecs(norms);
+    w.vecs(tangents);
+    w.indices(facet_vert);
+    w.indices(facet_tex);
+    w.indices(facet_nrm);
+    w.indices(facet_tan);
+    w.u32(skin_joints.size());
+    for(const int j : skin_joints) w.u32(j);
+    w.vecs(skin_weights);
+    w.u32(morph_targets.size());
+    for(const MorphTarget& t : morph_targets) {
+        w.str(t.name);
+        w.u32(t.indices.size());
+        for(const int i : t.indices) w.u32(i);
+        w.vecs(t.deltas);
+    }
+    w.u32(materials.size());
+    for(const Material& m : materials) {
+        w.str(m.name);
+        for(int i = 0; i < 3; i ++) w.f64(m.ambient[i]);
+        for(int i = 0; i < 3; i ++) w.f64(m.diffuse[i]);
+        for(int i = 0; i < 3; i ++) w.f64(m.specular[i]);
+        w.f64(m.shininess);
+        w.f64(m.opacity);
+        w.str(m.diffuse_map);
+        w.str(m.specular_map);
+        w.str(m.normal_map);
+    }
+    w.u32(submeshes.size());
+    for(const Submesh& s : submeshes) {
+        w.str(s.name);
+        w.u32(s.material);
+        w.u32(s.first_face);
+        w.u32(s.nfaces);
+    }
+    return std::move(w.buf);
+}
+
+/**
+ * @brief 网格内容的哈希，即二进制缓存字节的 FNV-1a
+ *
+ * 内容相同的模型（无论从哪种格式加载）哈希相同，可作为渲染结果缓存的键。
+ *
+ * @return std::uint64_t
+ */
+std::uint64_t Model::cache_hash() const {
+    const std::vector<std::uint8_t> bytes = cache_bytes();
+    Fnv1a h;
+    h.bytes(bytes.data(), bytes.size());
+    return h.value;
+}
+
+/**
+ * @brief 写出二进制网格缓存 (.tmc)
+ *
+ * @param filename
+ * @return 写入情况
+ */
+bool Model::write_cache(const std::string& filename) const {
+    const std::vector<std::uint8_t> buf = cache_bytes();
+    std::ofstream out(filename, std::ios::binary);
+    if(!out.is_open()) {
+        std::cerr << "can't open file " << filename << "\n";
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(buf.data()), buf.size());
+    if(!out.good()) {
+        std::cerr << "can't dump the mesh cache " << filename << "\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 读取二进制网格缓存 (.tmc)
+ *
+ * @param filename
+ * @return 读取情况；失败时模型保持为空
+ */
+bool Model::read_cache(const std::string& filename) {
+    MappedFile file;
+    if(!file.open(filename)) return false;
+    CacheReader r{file.data(), file.data() + file.size()};
+    char magic[4] = {};
+    r.take(magic, 4);
+    if(!r.ok || std::memcmp(magic, cache_magic, 4) != 0 || r.u32() != cache_version) {
+        std::cerr << filename << " is not a mesh cache of this version\n";
+        return false;
+    }
+    r.vecs(verts);
+    r.vecs(tex_coord);
+    r.vecs(norms);
+    r.vecs(tangents);
+    r.indices(facet_vert);
+    r.indices(facet_tex);
+    r.indices(facet_nrm);
+    r.indices(facet_tan);
+    const std::uint32_t njoints = r.u32();
+    if(r.ok && std::size_t(r.end - r.p) / 4 >= njoints) {
+        skin_joints.resize(njoints);
+        for(int& j : skin_joints) j = r.u32();
+    } else {
+        r.ok = false;
+    }
+    r.vecs(skin_weights);
+    const std::uint32_t ntargets = r.u32();
+    for(std::uint32_t i = 0; r.ok && i < ntargets; i ++) {
+        MorphTarget t;
+        t.name = r.str();
+        const std::uint32_t n = r.u32();
+        if(!r.ok || std::size_t(r.end - r.p) / 4 < n) {
+            r.ok = false;
+            break;
+        }
+        t.indices.resize(n);
+        for(int& k : t.indices) k = r.u32();
+        r.vecs(t.deltas);
+        morph_targets.push_back(std::move(t));
+    }
+    const std::uint32_t nmat = r.u32();
+    for(std::uint32_t i = 0; r.ok && i < nmat; i ++) {
+        Material m;
+        m.name = r.str();
+        for(int c = 0; c < 3; c ++) m.ambient[c] = r.f64();
+        for(int c = 0; c < 3; c ++) m.diffuse[c] = r.f64();
+        for(int c = 0; c < 3; c ++) m.specular[c] = r.f64();
+        m.shininess = r.f64();
+        m.opacity = r.f64();
+        m.diffuse_map = r.str();
+        m.specular_map = r.str();
+        m.normal_map = r.str();
+        materials.push_back(m);
+    }
+    const std::uint32_t nsub = r.u32();
+    for(std::uint32_t i = 0; r.ok && i < nsub; i ++) {
+        Submesh s;
+        s.name = r.str();
+        s.material = int(r.u32());
+        s.first_face = r.u32();
+        s.nfaces = r.u32();
+        submeshes.push_back(s);
+    }
+    const std::size_t n = facet_vert.size();
+    auto in_range = [](const std::vector<int>& idx, const std::size_t size, const int lowest) {
+        return std::all_of(idx.begin(), idx.end(), [&](int i) { return i >= lowest && i < (int)size; });
+    };
+    // 子网格的面范围与材质编号会被渲染器直接用作下标
+    const bool submeshes_valid = std::all_of(submeshes.begin(), submeshes.end(), [&](const Submesh& s) {
+        return s.material >= -1 && s.material < (int)materials.size() && s.first_face >= 0 && s.nfaces >= 0 &&
+               std::size_t(s.first_face) + std::size_t(s.nfaces) <= n / 3;
+    });
+    // 形变目标的索引须严格递增：MorphBuffer::evaluate 并行写这些顶点
+    auto strictly_increasing = [](const std::vector<int>& idx) {
+        return std::adjacent_find(idx.begin(), idx.end(), [](int a, int b) { return a >= b; }) == idx.end();
+    };
+    if(!r.ok || n % 3 != 0 || facet_tex.size() != n || facet_nrm.size() != n || !in_range(facet_vert, verts.size(), 0) ||
+       !in_range(facet_tex, tex_coord.size(), -1) || !in_range(facet_nrm, norms.size(), 0) ||
+       facet_tan.size() != (tangents.empty() ? 0 : n) || !in_range(facet_tan, tangents.size(), 0) ||
+       skin_weights.size() * 4 != skin_joints.size() || (!skin_weights.empty() && skin_weights.size() != verts.size()) ||
+       !in_range(skin_joints, std::numeric_limits<int>::max(), 0) ||
+       !std::all_of(morph_targets.begin(), morph_targets.end(), [&](const MorphTarget& t) {
+           return t.deltas.size() == t.indices.size() && in_range(t.indices, verts.size(), 0) &&
+                  strictly_increasing(t.indices);
+       }) || !submeshes_valid) {
+        std::cerr << "corrupted mesh cache " << filename << "\n";
+        *this = Model();
+        return false;
+    }
+    return true;
+}
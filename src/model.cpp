@@ -1,21 +1,239 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <functional>
+#include <limits>
 #include <sstream>
 
 #include "model/model.h"
+#include "model/glb.h"
+#include "model/ply.h"
+
+namespace {
+
+/**
+ * @brief 按目标索引分组的面顶点表（CSR 格式）
+ *
+ * 第 i 个目标（顶点或法线）关联的面顶点编号为
+ * corners[offset[i]] ... corners[offset[i + 1] - 1]，按面顶点编号升序排列，
+ * 因此后续的累加顺序与线程数无关。
+ */
+struct CornerTable {
+    std::vector<int> offset = {};
+    std::vector<int> corners = {};
+};
+
+/**
+ * @brief 由面顶点索引构建 CSR 分组（计数 + 前缀和 + 填充）
+ *
+ * @param facet 面顶点索引
+ * @param n 目标个数
+ * @return CornerTable
+ */
+CornerTable build_corner_table(const std::vector<int>& facet, const int n) {
+    CornerTable table;
+    table.offset.assign(n + 1, 0);
+    for(int idx : facet) table.offset[idx + 1] ++;
+    for(int i = 0; i < n; i ++) table.offset[i + 1] += table.offset[i];
+    table.corners.resize(facet.size());
+    std::vector<int> cursor(table.offset.begin(), table.offset.end() - 1);
+    for(int c = 0; c < (int)facet.size(); c ++) table.corners[cursor[facet[c]] ++] = c;
+    return table;
+}
+
+/**
+ * @brief 两条边之间的夹角
+ *
+ * @param a
+ * @param b
+ * @return double 弧度，退化边返回 0
+ */
+double corner_angle(const vec3& a, const vec3& b) {
+    const double len = norm(a) * norm(b);
+    if(len <= 0) return 0;
+    return std::acos(std::clamp(a * b / len, -1., 1.));
+}
+
+/**
+ * @brief 解析 OBJ 的一个索引，支持负数（相对末尾）索引
+ *
+ * @param p 输入位置，解析后前移
+ * @param size 当前已定义的元素个数
+ * @return int 0 起始的索引，缺省或非法时返回 -1
+ */
+int parse_obj_index(const char*& p, const int size) {
+    char* end = nullptr;
+    const long idx = std::strtol(p, &end, 10);
+    if(end == p) return -1;
+    p = end;
+    const long ret = idx < 0 ? size + idx : idx - 1;
+    return ret >= 0 && ret < size ? int(ret) : -1;
+}
+
+/**
+ * @brief 取一行中关键字之后的内容，去掉首尾空白
+ *
+ * @param line
+ * @param keyword_len 关键字长度
+ * @return std::string
+ */
+std::string line_argument(const std::string& line, const size_t keyword_len) {
+    const size_t begin = line.find_first_not_of(" \t", keyword_len);
+    if(begin == std::string::npos) return {};
+    const size_t end = line.find_last_not_of(" \t\r");
+    return line.substr(begin, end - begin + 1);
+}
+
+/**
+ * @brief 二维叉积 (b - a) x (c - b)
+ */
+double turn(const vec2& a, const vec2& b, const vec2& c) {
+    return (b.x - a.x) * (c.y - b.y) - (b.y - a.y) * (c.x - b.x);
+}
+
+/**
+ * @brief 点 p 是否在逆时针三角形 abc 内（含边界）
+ */
+bool inside_triangle(const vec2& p, const vec2& a, const vec2& b, const vec2& c) {
+    return turn(a, b, p) >= 0 && turn(b, c, p) >= 0 && turn(c, a, p) >= 0;
+}
+
+/**
+ * @brief 多边形三角化时复用的临时缓冲区，避免逐面分配
+ */
+struct PolygonScratch {
+    std::vector<vec2> proj = {};   // 投影到主平面后的二维坐标（逆时针）
+    std::vector<int> remain = {};  // 耳切法中尚未切除的顶点
+};
+
+/**
+ * @brief 将多边形三角化，按局部顶点编号 (0..n-1) 逐个回调三角形
+ *
+ * 先沿 Newell 法线的主轴投影到二维；凸多边形直接扇形剖分，
+ * 凹多边形使用耳切法。退化多边形找不到耳朵时退化为强制切除，保证结束。
+ *
+ * @tparam Emit void(int, int, int)
+ * @param verts 顶点坐标
+ * @param poly 多边形各顶点在 verts 中的索引
+ * @param n 顶点个数（>= 3）
+ * @param scratch 复用缓冲区
+ * @param emit 输出回调
+ */
+template<typename Emit>
+void triangulate_polygon(const std::vector<vec3>& verts, const int* poly, const int n, PolygonScratch& scratch, Emit emit) {
+    if(n == 3) {
+        emit(0, 1, 2);
+        return;
+    }
+
+    vec3 newell;
+    for(int i = 0; i < n; i ++) {
+        const vec3& a = verts[poly[i]];
+        const vec3& b = verts[poly[(i + 1) % n]];
+        newell = newell + vec3{(a.y - b.y) * (a.z + b.z), (a.z - b.z) * (a.x + b.x), (a.x - b.x) * (a.y + b.y)};
+    }
+    int axis = 2;
+    if(std::abs(newell.x) >= std::abs(newell.y) && std::abs(newell.x) >= std::abs(newell.z)) axis = 0;
+    else if(std::abs(newell.y) >= std::abs(newell.z)) axis = 1;
+    const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+    const double flip = newell[axis] < 0 ? -1 : 1;
+
+    scratch.proj.resize(n);
+    for(int i = 0; i < n; i ++) scratch.proj[i] = {verts[poly[i]][u], verts[poly[i]][v] * flip};
+    const std::vector<vec2>& p = scratch.proj;
+
+    bool convex = true;
+    for(int i = 0; convex && i < n; i ++) convex = turn(p[i], p[(i + 1) % n], p[(i + 2) % n]) >= 0;
+    if(convex) {
+        for(int i = 1; i + 1 < n; i ++) emit(0, i, i + 1);
+        return;
+    }
+
+    std::vector<int>& remain = scratch.remain;
+    remain.resize(n);
+    for(int i = 0; i < n; i ++) remain[i] = i;
+    while(remain.size() > 3) {
+        const int m = remain.size();
+        int ear = -1;
+        for(int i = 0; ear < 0 && i < m; i ++) {
+            const int a = remain[(i + m - 1) % m], b = remain[i], c = remain[(i + 1) % m];
+            if(turn(p[a], p[b], p[c]) <= 0) continue;
+            bool empty = true;
+            for(int j = 0; empty && j < m; j ++) {
+                const int q = remain[j];
+                if(q == a || q == b || q == c) continue;
+                empty = !inside_triangle(p[q], p[a], p[b], p[c]);
+            }
+            if(empty) ear = i;
+        }
+        if(ear < 0) ear = 0;
+        emit(remain[(ear + m - 1) % m], remain[ear], remain[(ear + 1) % m]);
+        remain.erase(remain.begin() + ear);
+    }
+    emit(remain[0], remain[1], remain[2]);
+}
+
+} // namespace
 
 /**
  * @brief Construct a new Model:: Model object
- * 
- * @param filename 
+ *
+ * 按扩展名选择加载器：.glb 为 glTF 2.0 二进制，.ply 为二进制小端 PLY，
+ * .tmc 为 write_cache 写出的二进制缓存（直接还原，不做后处理），其余按 OBJ 读取。
+ * 加载后三角形按材质重排，同一材质的子网格在索引缓冲中相邻，
+ * 每个子网格占据一段连续的面区间。缺少法线时按角度加权生成平滑法线，
+ * 含纹理坐标时同时生成切线。
+ *
+ * @param filename
  */
 Model::Model(const std::string filename) {
+    std::string ext = std::filesystem::path(filename).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    if(ext == ".tmc") {
+        read_cache(filename);
+        return;
+    }
+    std::vector<int> face_submesh;      // 每个三角形所属子网格
+    bool ok = false;
+    if(ext == ".glb") ok = load_glb(filename, face_submesh);
+    else if(ext == ".ply") ok = load_ply(filename, face_submesh);
+    else ok = load_obj(filename, face_submesh);
+    if(!ok) return;
+    sort_submeshes(face_submesh);
+    if(norms.empty() || std::any_of(facet_nrm.begin(), facet_nrm.end(), [](int n) { return n < 0; }))
+        generate_normals();
+    if(has_uv()) generate_tangents();
+}
+
+/**
+ * @brief 读取 OBJ 文件
+ *
+ * 四边形及任意多边形面在读取时直接三角化（凸多边形扇形剖分，凹多边形耳切）。
+ * o/g/usemtl 将三角形划分为子网格，mtllib 引用的 MTL 文件解析为材质。
+ *
+ * @param filename
+ * @param face_submesh 输出每个三角形所属的子网格
+ * @return 读取情况
+ */
+bool Model::load_obj(const std::string& filename, std::vector<int>& face_submesh) {
     std::ifstream in;
     in.open(filename, std::ios::in);
     if(in.fail()) {
         std::cerr << "Failed to open " << filename << std::endl;
-        return;
+        return false;
     }
+    const std::filesystem::path dir = std::filesystem::path(filename).parent_path();
     std::string line;
+    std::vector<int> poly_v, poly_t, poly_n;    // 当前面的各项索引，跨行复用
+    PolygonScratch scratch;
+    std::string group;                  // 当前 o/g 名
+    int mtl = -1;                       // 当前材质
+    int cur = -1;                       // 当前 (group, mtl) 对应的子网格
     while(!in.eof()) {
         std::getline(in, line);
         std::istringstream iss(line.c_str());
@@ -26,40 +244,403 @@ Model::Model(const std::string filename) {
             for(int i = 0; i < 3; i ++) iss >> v[i];
             verts.push_back(v);
         }
+        else if(!line.compare(0, 3, "vt ")) {
+            iss >> trash >> trash;
+            vec2 uv;
+            for(int i = 0; i < 2; i ++) iss >> uv[i];
+            tex_coord.push_back(uv);
+        }
+        else if(!line.compare(0, 3, "vn ")) {
+            iss >> trash >> trash;
+            vec3 n;
+            for(int i = 0; i < 3; i ++) iss >> n[i];
+            norms.push_back(normalized(n));
+        }
+        else if(!line.compare(0, 7, "mtllib ")) {
+            load_mtl((dir / line_argument(line, 7)).string());
+        }
+        else if(!line.compare(0, 7, "usemtl ")) {
+            mtl = find_material(line_argument(line, 7));
+            cur = -1;
+        }
+        else if(!line.compare(0, 2, "o ") || !line.compare(0, 2, "g ")) {
+            group = line_argument(line, 2);
+            cur = -1;
+        }
         else if(!line.compare(0, 2, "f ")) {
-            int f, t, n, cnt = 0;
-            iss >> trash;
-            while(iss >> f >> trash >> t >> trash >> n) {
-                facet_vert.push_back(-- f);
-                cnt ++;
+            // 支持 v、v/t、v//n、v/t/n 四种写法
+            poly_v.clear(); poly_t.clear(); poly_n.clear();
+            const char* p = line.c_str() + 2;
+            while(true) {
+                while(*p == ' ' || *p == '\t') p ++;
+                if(!*p || *p == '\r') break;
+                int v = parse_obj_index(p, verts.size()), t = -1, n = -1;
+                if(*p == '/') {
+                    p ++;
+                    if(*p != '/') t = parse_obj_index(p, tex_coord.size());
+                    if(*p == '/') {
+                        p ++;
+                        n = parse_obj_index(p, norms.size());
+                    }
+                }
+                while(*p && *p != ' ' && *p != '\t') p ++;
+                if(v < 0) {
+                    std::cerr << "Warning: skipping face with bad vertex index in " << filename << std::endl;
+                    poly_v.clear();
+                    break;
+                }
+                poly_v.push_back(v);
+                poly_t.push_back(t);
+                poly_n.push_back(n);
+            }
+            if(poly_v.size() < 3) continue;
+            if(cur < 0) cur = find_submesh(group, mtl);
+            triangulate_polygon(verts, poly_v.data(), poly_v.size(), scratch, [&](int a, int b, int c) {
+                for(int k : {a, b, c}) {
+                    facet_vert.push_back(poly_v[k]);
+                    facet_tex.push_back(poly_t[k]);
+                    facet_nrm.push_back(poly_n[k]);
+                }
+                face_submesh.push_back(cur);
+            });
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 读取 glTF 2.0 二进制文件 (.glb)
+ *
+ * 文件以只读方式映射，顶点与索引数据通过 AccessorView 原地读取，
+ * 并行地直接转换到内部布局，不经过文本解析或中间拷贝。
+ * 遍历默认场景的节点树并把节点变换烘焙进顶点；没有场景时按原样读取全部网格。
+ * 只读取 TRIANGLES 图元，每个图元按 (网格名, 材质) 归入子网格。
+ * 带 JOINTS_0 / WEIGHTS_0 的图元读入蒙皮权重；按规范，带 skin 的节点自身的变换不烘焙，顶点保持绑定姿态。
+ * 图元的 targets 读为稀疏形变目标，只保留位移非零的顶点；同一网格各图元的第 t 个目标合并为一个，
+ * 名字取自网格 extras.targetNames。
+ * glTF 的纹理坐标原点在左上角，读取时翻转为 OBJ 的左下角约定。
+ *
+ * @param filename
+ * @param face_submesh 输出每个三角形所属的子网格
+ * @return 读取情况
+ */
+bool Model::load_glb(const std::string& filename, std::vector<int>& face_submesh) {
+    GlbFile glb;
+    if(!glb.open(filename)) return false;
+    const JsonValue& doc = glb.json();
+    const std::filesystem::path dir = std::filesystem::path(filename).parent_path();
+
+    const JsonValue& mats = doc["materials"];
+    for(int i = 0; i < mats.size(); i ++) {
+        Material m;
+        m.name = mats[i]["name"].str().empty() ? "material_" + std::to_string(i) : mats[i]["name"].str();
+        const JsonValue& pbr = mats[i]["pbrMetallicRoughness"];
+        const JsonValue& base = pbr["baseColorFactor"];
+        for(int c = 0; c < 3; c ++) m.diffuse[c] = base[c].number(1);
+        m.opacity = base[3].number(1);
+        auto texture_uri = [&](const JsonValue& info) -> std::string {
+            if(info.is_null()) return {};
+            const std::string& uri = doc["images"][doc["textures"][info["index"].integer()]["source"].integer()]["uri"].str();
+            return uri.empty() ? uri : (dir / uri).string();
+        };
+        m.diffuse_map = texture_uri(pbr["baseColorTexture"]);
+        m.normal_map = texture_uri(mats[i]["normalTexture"]);
+        materials.push_back(m);
+    }
+
+    // 收集 (网格, 世界矩阵)
+    std::vector<std::pair<int, mat<4,4>>> instances;
+    mat<4,4> identity;
+    for(int i = 0; i < 4; i ++) identity[i][i] = 1;
+    const JsonValue& nodes = doc["nodes"];
+    std::function<void(int, const mat<4,4>&, int)> visit = [&](int n, const mat<4,4>& parent, int depth) {
+        const JsonValue& node = nodes[n];
+        if(node.is_null() || depth > 64) return;
+        mat<4,4> local = identity;
+        if(node.has("matrix")) {
+            for(int r = 0; r < 4; r ++)
+                for(int c = 0; c < 4; c ++) local[r][c] = node["matrix"][c * 4 + r].number();
+        } else {
+            const JsonValue& t = node["translation"];
+            const JsonValue& q = node["rotation"];
+            const JsonValue& sc = node["scale"];
+            const double x = q[0].number(0), y = q[1].number(0), z = q[2].number(0), w = q[3].number(1);
+            const mat<3,3> rot = {{
+                {1 - 2 * (y * y + z * z), 2 * (x * y - z * w), 2 * (x * z + y * w)},
+                {2 * (x * y + z * w), 1 - 2 * (x * x + z * z), 2 * (y * z - x * w)},
+                {2 * (x * z - y * w), 2 * (y * z + x * w), 1 - 2 * (x * x + y * y)}
+            }};
+            for(int r = 0; r < 3; r ++) {
+                for(int c = 0; c < 3; c ++) local[r][c] = rot[r][c] * sc[c].number(1);
+                local[r][3] = t[r].number(0);
+            }
+        }
+        const mat<4,4> world = parent * local;
+        if(node.has("mesh")) instances.push_back({node["mesh"].integer(), node.has("skin") ? identity : world});
+        for(int c = 0; c < node["children"].size(); c ++) visit(node["children"][c].integer(), world, depth + 1);
+    };
+    const JsonValue& scene = doc["scenes"][doc["scene"].integer(0)];
+    for(int i = 0; i < scene["nodes"].size(); i ++) visit(scene["nodes"][i].integer(), identity, 0);
+    if(scene.is_null())
+        for(int i = 0; i < doc["meshes"].size(); i ++) instances.push_back({i, identity});
+
+    for(const auto& [mesh_id, world] : instances) {
+        const JsonValue& mesh = doc["meshes"][mesh_id];
+        mat<3,3> linear;
+        for(int r = 0; r < 3; r ++)
+            for(int c = 0; c < 3; c ++) linear[r][c] = world[r][c];
+        const double det = linear.det();
+        const mat<3,3> normal_mat = std::abs(det) > 1e-300 ? linear.invert_transpose() : linear;
+        const bool flip = det < 0;      // 镜像变换需翻转绕序
+
+        const int target_base = morph_targets.size();
+        for(int p = 0; p < mesh["primitives"].size(); p ++) {
+            const JsonValue& prim = mesh["primitives"][p];
+            if(prim["mode"].integer(4) != 4) continue;
+            const JsonValue& attrs = prim["attributes"];
+            const AccessorView pos = glb.accessor(attrs["POSITION"].integer(-1));
+            if(!pos.valid() || pos.components < 3) continue;
+            const AccessorView nrm = attrs.has("NORMAL") ? glb.accessor(attrs["NORMAL"].integer()) : AccessorView{};
+            const AccessorView tex = attrs.has("TEXCOORD_0") ? glb.accessor(attrs["TEXCOORD_0"].integer()) : AccessorView{};
+            const AccessorView idx = prim.has("indices") ? glb.accessor(prim["indices"].integer()) : AccessorView{};
+            const bool has_nrm = nrm.valid() && nrm.count == pos.count;
+            const bool has_tex = tex.valid() && tex.count == pos.count;
+            const AccessorView jnt = attrs.has("JOINTS_0") ? glb.accessor(attrs["JOINTS_0"].integer()) : AccessorView{};
+            const AccessorView wgt = attrs.has("WEIGHTS_0") ? glb.accessor(attrs["WEIGHTS_0"].integer()) : AccessorView{};
+            const bool has_skin = jnt.valid() && wgt.valid() && jnt.count == pos.count && wgt.count == pos.count &&
+                                  jnt.components == 4 && wgt.components == 4;
+
+            const int vbase = verts.size(), nbase = norms.size(), tbase = tex_coord.size();
+            const int nv = pos.count;
+            verts.resize(vbase + nv);
+            if(has_nrm) norms.resize(nbase + nv);
+            if(has_tex) tex_coord.resize(tbase + nv);
+            if(has_skin || !skin_weights.empty()) {
+                skin_joints.resize((vbase + nv) * 4, 0);
+                skin_weights.resize(vbase + nv, vec4{});
+            }
+            #pragma omp parallel for schedule(static)
+            for(int i = 0; i < nv; i ++) {
+                const vec3 v = {pos.get(i, 0), pos.get(i, 1), pos.get(i, 2)};
+                const vec4 w = world * vec4{v.x, v.y, v.z, 1};
+                verts[vbase + i] = w.xyz();
+                if(has_nrm) {
+                    const vec3 n = normal_mat * vec3{nrm.get(i, 0), nrm.get(i, 1), nrm.get(i, 2)};
+                    const double len = norm(n);
+                    norms[nbase + i] = len > 0 ? n / len : vec3{0, 0, 1};
+                }
+                if(has_tex) tex_coord[tbase + i] = {tex.get(i, 0), 1 - tex.get(i, 1)};
+                if(has_skin) {
+                    for(int k = 0; k < 4; k ++) {
+                        skin_joints[(vbase + i) * 4 + k] = std::max(0, int(jnt.get(i, k)));
+                        skin_weights[vbase + i][k] = std::max(0., wgt.get(i, k));
+                    }
+                }
             }
-            if (3!=cnt) {
-                std::cerr << "Error: the obj file is supposed to be triangulated" << std::endl;
-                return;
+
+            const JsonValue& targets = prim["targets"];
+            for(int t = 0; t < targets.size(); t ++) {
+                const AccessorView delta = glb.accessor(targets[t]["POSITION"].integer(-1));
+                if(!delta.valid() || delta.count != nv || delta.components < 3) continue;
+                if((int)morph_targets.size() <= target_base + t) {
+                    morph_targets.resize(target_base + t + 1);
+                    const std::string& name = mesh["extras"]["targetNames"][t].str();
+                    morph_targets[target_base + t].name = name.empty() ? mesh["name"].str() + "_target_" + std::to_string(t) : name;
+                }
+                MorphTarget& target = morph_targets[target_base + t];
+                for(int i = 0; i < nv; i ++) {
+                    const vec3 d = linear * vec3{delta.get(i, 0), delta.get(i, 1), delta.get(i, 2)};
+                    if(d.x == 0 && d.y == 0 && d.z == 0) continue;
+                    target.indices.push_back(vbase + i);
+                    target.deltas.push_back(d);
+                }
+            }
+
+            const int nidx = idx.valid() ? idx.count : nv;
+            const int nf = nidx / 3;
+            const int fbase = facet_vert.size() / 3;
+            facet_vert.resize((fbase + nf) * 3);
+            facet_tex.resize((fbase + nf) * 3);
+            facet_nrm.resize((fbase + nf) * 3);
+            bool in_range = true;
+            #pragma omp parallel for schedule(static) reduction(&&:in_range)
+            for(int f = 0; f < nf; f ++) {
+                for(int k = 0; k < 3; k ++) {
+                    const int src = f * 3 + (flip && k ? 3 - k : k);
+                    const std::uint32_t i = idx.valid() ? idx.index(src) : std::uint32_t(src);
+                    in_range = in_range && i < std::uint32_t(nv);
+                    const int vi = i < std::uint32_t(nv) ? int(i) : 0;
+                    facet_vert[(fbase + f) * 3 + k] = vbase + vi;
+                    facet_tex[(fbase + f) * 3 + k] = has_tex ? tbase + vi : -1;
+                    facet_nrm[(fbase + f) * 3 + k] = has_nrm ? nbase + vi : -1;
+                }
             }
+            if(!in_range) std::cerr << "Warning: out of range indices in " << filename << std::endl;
+            const int material = prim["material"].integer(-1);
+            const int sub = find_submesh(mesh["name"].str(), material < (int)materials.size() ? material : -1);
+            face_submesh.insert(face_submesh.end(), nf, sub);
         }
     }
+    return true;
+}
+
+/**
+ * @brief 读取 binary_little_endian 格式的 PLY 文件
+ *
+ * 文件以只读方式映射。vertex 块为定长记录，按 stride 并行转换到内部布局，
+ * x/y/z 为相邻 float 时走整块拷贝的快速路径；face 块全部为三角形时同样并行转换，
+ * 否则顺序遍历并对多边形做三角化。可选读取 nx/ny/nz 与 u/v（或 s/t）。
+ *
+ * @param filename
+ * @param face_submesh 输出每个三角形所属的子网格
+ * @return 读取情况
+ */
+bool Model::load_ply(const std::string& filename, std::vector<int>& face_submesh) {
+    PlyFile ply;
+    if(!ply.open(filename)) return false;
+    const PlyElement* vertex = ply.element("vertex");
+    const PlyElement* face = ply.element("face");
+    if(!vertex || !vertex->stride) {
+        std::cerr << filename << ": missing fixed-size vertex element" << std::endl;
+        return false;
+    }
+    auto prop = [](const PlyElement* e, std::initializer_list<const char*> names) -> const PlyProperty* {
+        for(const char* name : names) {
+            const int i = e->find(name);
+            if(i >= 0) return &e->props[i];
+        }
+        return nullptr;
+    };
+    const PlyProperty* px = prop(vertex, {"x"});
+    const PlyProperty* py = prop(vertex, {"y"});
+    const PlyProperty* pz = prop(vertex, {"z"});
+    if(!px || !py || !pz) {
+        std::cerr << filename << ": vertex element lacks x/y/z" << std::endl;
+        return false;
+    }
+    const PlyProperty* nx = prop(vertex, {"nx"});
+    const PlyProperty* ny = prop(vertex, {"ny"});
+    const PlyProperty* nz = prop(vertex, {"nz"});
+    const PlyProperty* tu = prop(vertex, {"u", "s", "texture_u"});
+    const PlyProperty* tv = prop(vertex, {"v", "t", "texture_v"});
+    const bool has_nrm = nx && ny && nz;
+    const bool has_tex = tu && tv;
+
+    const int nv = vertex->count;
+    const int stride = vertex->stride;
+    const std::uint8_t* vdata = vertex->data;
+    const bool packed = px->type == PlyProperty::FLOAT32 && py->type == PlyProperty::FLOAT32 &&
+                        pz->type == PlyProperty::FLOAT32 && py->offset == px->offset + 4 && pz->offset == px->offset + 8;
+    verts.resize(nv);
+    if(has_nrm) norms.resize(nv);
+    if(has_tex) tex_coord.resize(nv);
+    #pragma omp parallel for schedule(static)
+    for(int i = 0; i < nv; i ++) {
+        const std::uint8_t* rec = vdata + std::size_t(i) * stride;
+        if(packed) {
+            float xyz[3];
+            std::memcpy(xyz, rec + px->offset, sizeof(xyz));
+            verts[i] = {xyz[0], xyz[1], xyz[2]};
+        } else {
+            verts[i] = {PlyProperty::read(rec + px->offset, px->type),
+                        PlyProperty::read(rec + py->offset, py->type),
+                        PlyProperty::read(rec + pz->offset, pz->type)};
+        }
+        if(has_nrm) {
+            const vec3 n = {PlyProperty::read(rec + nx->offset, nx->type),
+                            PlyProperty::read(rec + ny->offset, ny->type),
+                            PlyProperty::read(rec + nz->offset, nz->type)};
+            const double len = norm(n);
+            norms[i] = len > 0 ? n / len : vec3{0, 0, 1};
+        }
+        if(has_tex) tex_coord[i] = {PlyProperty::read(rec + tu->offset, tu->type), PlyProperty::read(rec + tv->offset, tv->type)};
+    }
+
+    const int list_id = face ? std::max(face->find("vertex_indices"), face->find("vertex_index")) : -1;
+    if(list_id < 0) return true;      // 点云
+    const PlyProperty& list = face->props[list_id];
+    const int cs = PlyProperty::size(list.count_type);
+    const int is = PlyProperty::size(list.type);
+    const int sub = find_submesh(std::filesystem::path(filename).stem().string(), -1);
+    bool in_range = true;
+
+    if(face->uniform_list == 3) {
+        const int nf = face->count;
+        const std::size_t item = cs + 3 * is;
+        const std::uint8_t* fdata = face->data;
+        facet_vert.resize(std::size_t(nf) * 3);
+        #pragma omp parallel for schedule(static) reduction(&&:in_range)
+        for(int f = 0; f < nf; f ++) {
+            const std::uint8_t* rec = fdata + std::size_t(f) * item + cs;
+            for(int k = 0; k < 3; k ++) {
+                const double idx = PlyProperty::read(rec + k * is, list.type);
+                const bool ok = idx >= 0 && idx < nv;
+                in_range = in_range && ok;
+                facet_vert[f * 3 + k] = ok ? int(idx) : 0;
+            }
+        }
+    } else {
+        std::vector<int> poly;
+        PolygonScratch scratch;
+        const std::uint8_t* p = face->data;
+        for(int f = 0; f < face->count; f ++) {
+            poly.clear();
+            for(int j = 0; j < (int)face->props.size(); j ++) {
+                const PlyProperty& pr = face->props[j];
+                if(pr.count_type == PlyProperty::NONE) {
+                    p += PlyProperty::size(pr.type);
+                    continue;
+                }
+                const double count = PlyProperty::read(p, pr.count_type);
+                p += PlyProperty::size(pr.count_type);
+                // PlyFile::open 已按同样的长度遍历过数据块；转换为 int 前仍与块内剩余字节比较
+                const std::size_t left = face->data + face->bytes - p;
+                if(count > 0 && !(count <= double(left / PlyProperty::size(pr.type)) && count <= std::numeric_limits<int>::max())) {
+                    std::cerr << filename << ": bad list length in face " << f << std::endl;
+                    *this = Model();
+                    return false;
+                }
+                const int n = count > 0 ? int(count) : 0;
+                for(int k = 0; k < n; k ++, p += PlyProperty::size(pr.type)) {
+                    if(j != list_id) continue;
+                    const double idx = PlyProperty::read(p, pr.type);
+                    const bool ok = idx >= 0 && idx < nv;
+                    in_range = in_range && ok;
+                    poly.push_back(ok ? int(idx) : 0);
+                }
+            }
+            if(poly.size() < 3) continue;
+            triangulate_polygon(verts, poly.data(), poly.size(), scratch, [&](int a, int b, int c) {
+                for(int k : {a, b, c}) facet_vert.push_back(poly[k]);
+            });
+        }
+    }
+    if(!in_range) std::cerr << "Warning: out of range indices in " << filename << std::endl;
+    facet_tex = has_tex ? facet_vert : std::vector<int>(facet_vert.size(), -1);
+    facet_nrm = has_nrm ? facet_vert : std::vector<int>(facet_vert.size(), -1);
+    face_submesh.assign(facet_vert.size() / 3, sub);
+    return true;
 }
 
 /**
  * @brief 顶点个数
- * 
- * @return int 
+ *
+ * @return int
  */
 int Model::nverts() const { return verts.size(); }
 
 /**
  * @brief 面数
- * 
- * @return int 
+ *
+ * @return int
  */
 int Model::nfaces() const { return facet_vert.size() / 3; }
 
 /**
  * @brief 获取顶点
- * 
+ *
  * @param i 索引
- * @return vec3 
+ * @return vec3
  */
 vec3 Model::vert(const int i) const {
     return verts[i];
@@ -67,13 +648,438 @@ vec3 Model::vert(const int i) const {
 
 /**
  * @brief 获取第 iface 个面的第 nthvert 个顶点
- * 
- * @param iface 
- * @param nthvert 
- * @return vec3 
+ *
+ * @param iface
+ * @param nthvert
+ * @return vec3
  */
 vec3 Model::vert(const int iface, const int nthvert) const {
     int idx = iface * 3 + nthvert;
     int global_idx = facet_vert[idx];
     return verts[global_idx];
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 面顶点的顶点索引
+ *
+ * @param iface
+ * @param nthvert
+ * @return int
+ */
+int Model::facet(const int iface, const int nthvert) const {
+    return facet_vert[iface * 3 + nthvert];
+}
+
+/**
+ * @brief 获取第 iface 个面的第 nthvert 个顶点的纹理坐标
+ *
+ * @param iface
+ * @param nthvert
+ * @return vec2 该面顶点无纹理坐标时返回 (0, 0)
+ */
+vec2 Model::uv(const int iface, const int nthvert) const {
+    const int idx = facet_tex[iface * 3 + nthvert];
+    return idx < 0 ? vec2{} : tex_coord[idx];
+}
+
+/**
+ * @brief 获取第 iface 个面的第 nthvert 个顶点的法线
+ *
+ * @param iface
+ * @param nthvert
+ * @return vec3 单位向量
+ */
+vec3 Model::normal(const int iface, const int nthvert) const {
+    return norms[facet_nrm[iface * 3 + nthvert]];
+}
+
+/**
+ * @brief 获取第 iface 个面的第 nthvert 个顶点的切线
+ *
+ * @param iface
+ * @param nthvert
+ * @return vec4 xyz 为单位切线，w 为副切线方向符号（bitangent = w * cross(n, t)）；
+ *         未生成切线时返回 0 向量
+ */
+vec4 Model::tangent(const int iface, const int nthvert) const {
+    if(tangents.empty()) return {};
+    return tangents[facet_tan[iface * 3 + nthvert]];
+}
+
+/**
+ * @brief 是否带有可用的纹理坐标
+ */
+bool Model::has_uv() const {
+    return !tex_coord.empty() && facet_tex.size() == facet_vert.size();
+}
+
+/**
+ * @brief 是否带有蒙皮权重
+ */
+bool Model::has_skin() const {
+    return !skin_weights.empty();
+}
+
+/**
+ * @brief 第 i 个顶点的第 k 个关节索引
+ *
+ * @param i
+ * @param k 0..3
+ * @return int
+ */
+int Model::joint(const int i, const int k) const {
+    return skin_joints[i * 4 + k];
+}
+
+/**
+ * @brief 第 i 个顶点的 4 个关节权重
+ *
+ * @param i
+ * @return vec4 权重和为 0 的顶点不受关节影响
+ */
+vec4 Model::weights(const int i) const {
+    return skin_weights[i];
+}
+
+/**
+ * @brief 设置蒙皮权重，覆盖已有权重
+ *
+ * @param joints 每个顶点 4 个非负关节索引
+ * @param weights 每个顶点 4 个非负权重
+ * @return 大小与取值是否有效；无效时保持不变
+ */
+bool Model::set_skin(const std::vector<int>& joints, const std::vector<vec4>& weights) {
+    const bool valid = joints.size() == verts.size() * 4 && weights.size() == verts.size() &&
+                       std::all_of(joints.begin(), joints.end(), [](int j) { return j >= 0; }) &&
+                       std::all_of(weights.begin(), weights.end(), [](const vec4& w) { return w.x >= 0 && w.y >= 0 && w.z >= 0 && w.w >= 0; });
+    if(!valid) {
+        std::cerr << "invalid skin weights for a mesh with " << verts.size() << " vertices\n";
+        return false;
+    }
+    skin_joints = joints;
+    skin_weights = weights;
+    return true;
+}
+
+/**
+ * @brief 形变目标个数
+ */
+int Model::nmorph_targets() const { return morph_targets.size(); }
+
+/**
+ * @brief 获取第 i 个形变目标
+ */
+const MorphTarget& Model::morph_target(const int i) const { return morph_targets[i]; }
+
+/**
+ * @brief 追加形变目标
+ *
+ * @param target 索引须严格递增且在顶点范围内，与位移一一对应
+ * @return 是否有效；无效时不追加
+ */
+bool Model::add_morph_target(const MorphTarget& target) {
+    bool valid = target.indices.size() == target.deltas.size();
+    for(std::size_t i = 0; valid && i < target.indices.size(); i ++)
+        valid = target.indices[i] >= 0 && target.indices[i] < nverts() && (i == 0 || target.indices[i - 1] < target.indices[i]);
+    if(!valid) {
+        std::cerr << "invalid morph target " << target.name << "\n";
+        return false;
+    }
+    morph_targets.push_back(target);
+    revision = next_revision();
+    return true;
+}
+
+/**
+ * @brief 分配新的修订号，供依赖模型内容的缓存判断模型是否已换掉
+ */
+std::uint64_t Model::next_revision() {
+    static std::atomic<std::uint64_t> counter{0};
+    return ++ counter;
+}
+
+/**
+ * @brief 生成平滑顶点法线，覆盖已有法线
+ *
+ * 两遍无原子操作的并行 scatter：
+ * 1. 并行遍历面，计算每个面顶点的加权面法线贡献；
+ * 2. 按 CSR 分组并行遍历顶点，按固定顺序累加其所有面顶点贡献并归一化。
+ *
+ * @param weighting AREA 按面积加权，ANGLE 按面顶点处的内角加权
+ */
+void Model::generate_normals(const NormalWeighting weighting) {
+    const int nf = nfaces();
+    const int nv = nverts();
+    std::vector<vec3> contrib(facet_vert.size());
+
+    #pragma omp parallel for schedule(static)
+    for(int f = 0; f < nf; f ++) {
+        const vec3 p[3] = { vert(f, 0), vert(f, 1), vert(f, 2) };
+        const vec3 n = cross(p[1] - p[0], p[2] - p[0]);   // 模长为面积的两倍
+        for(int k = 0; k < 3; k ++) {
+            double w = 1;
+            if(weighting == ANGLE) {
+                const double len = norm(n);
+                w = len > 0 ? corner_angle(p[(k + 1) % 3] - p[k], p[(k + 2) % 3] - p[k]) / len : 0;
+            }
+            contrib[f * 3 + k] = n * w;
+        }
+    }
+
+    const CornerTable table = build_corner_table(facet_vert, nv);
+    norms.assign(nv, vec3{});
+
+    #pragma omp parallel for schedule(static)
+    for(int v = 0; v < nv; v ++) {
+        vec3 sum;
+        for(int i = table.offset[v]; i < table.offset[v + 1]; i ++) sum = sum + contrib[table.corners[i]];
+        const double len = norm(sum);
+        norms[v] = len > 0 ? sum / len : vec3{0, 0, 1};
+    }
+    facet_nrm = facet_vert;
+    tangents.clear();       // 按旧法线生成，需重新 generate_tangents
+    facet_tan.clear();
+}
+
+/**
+ * @brief 生成与 MikkTSpace 兼容的切线
+ *
+ * 与 MikkTSpace 相同：面切线先投影到面顶点法线的切平面并归一化，
+ * 再按内角加权累加到同一切线槽的面顶点上，最后做 Gram-Schmidt 正交化，
+ * 副切线方向由符号位 w 记录。法线索引、纹理坐标索引与 UV 朝向（是否镜像）
+ * 都相同的面顶点共享一个切线槽，因此 UV 接缝与镜像 UV 两侧的切线互不平均。
+ * 与 generate_normals 相同采用两遍并行 scatter，要求先有法线。
+ */
+void Model::generate_tangents() {
+    if(!has_uv() || norms.empty()) return;
+    const int nf = nfaces();
+    const int nn = norms.size();
+    const int ncorners = facet_vert.size();
+    std::vector<vec3> tcontrib(ncorners);
+    std::vector<vec3> bcontrib(ncorners);
+    std::vector<char> mirrored(nf);
+
+    #pragma omp parallel for schedule(static)
+    for(int f = 0; f < nf; f ++) {
+        const vec3 p[3] = { vert(f, 0), vert(f, 1), vert(f, 2) };
+        const vec2 t[3] = { uv(f, 0), uv(f, 1), uv(f, 2) };
+        const vec3 e1 = p[1] - p[0], e2 = p[2] - p[0];
+        const vec2 d1 = t[1] - t[0], d2 = t[2] - t[0];
+        const double det = d1.x * d2.y - d2.x * d1.y;
+        mirrored[f] = det < 0;
+        vec3 tan, bit;
+        if(std::abs(det) > 1e-20) {
+            tan = (e1 * d2.y - e2 * d1.y) / det;
+            bit = (e2 * d1.x - e1 * d2.x) / det;
+        }
+        for(int k = 0; k < 3; k ++) {
+            const vec3 n = normal(f, k);
+            vec3 tk = tan - n * (n * tan);
+            vec3 bk = bit - n * (n * bit);
+            const double tl = norm(tk), bl = norm(bk);
+            const double w = corner_angle(p[(k + 1) % 3] - p[k], p[(k + 2) % 3] - p[k]);
+            tcontrib[f * 3 + k] = tl > 0 ? tk * (w / tl) : vec3{};
+            bcontrib[f * 3 + k] = bl > 0 ? bk * (w / bl) : vec3{};
+        }
+    }
+
+    // 切线槽：先按法线分组，组内按 (纹理坐标索引, 是否镜像) 再分，组号按法线顺序连续编号
+    const CornerTable by_normal = build_corner_table(facet_nrm, nn);
+    auto slot_key = [&](const int c) { return std::pair<int, char>{facet_tex[c], mirrored[c / 3]}; };
+    std::vector<int> nslots(nn + 1, 0);
+    #pragma omp parallel for schedule(static)
+    for(int v = 0; v < nn; v ++) {
+        std::vector<std::pair<int, char>> keys;
+        for(int i = by_normal.offset[v]; i < by_normal.offset[v + 1]; i ++) keys.push_back(slot_key(by_normal.corners[i]));
+        std::sort(keys.begin(), keys.end());
+        nslots[v + 1] = std::unique(keys.begin(), keys.end()) - keys.begin();
+    }
+    for(int v = 0; v < nn; v ++) nslots[v + 1] += nslots[v];
+    facet_tan.assign(ncorners, 0);
+    #pragma omp parallel for schedule(static)
+    for(int v = 0; v < nn; v ++) {
+        std::vector<std::pair<int, char>> keys;
+        for(int i = by_normal.offset[v]; i < by_normal.offset[v + 1]; i ++) keys.push_back(slot_key(by_normal.corners[i]));
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        for(int i = by_normal.offset[v]; i < by_normal.offset[v + 1]; i ++) {
+            const int c = by_normal.corners[i];
+            facet_tan[c] = nslots[v] + int(std::lower_bound(keys.begin(), keys.end(), slot_key(c)) - keys.begin());
+        }
+    }
+
+    const int nt = nslots[nn];
+    const CornerTable table = build_corner_table(facet_tan, nt);
+    tangents.assign(nt, vec4{});
+
+    #pragma omp parallel for schedule(static)
+    for(int v = 0; v < nt; v ++) {
+        vec3 tsum, bsum;
+        for(int i = table.offset[v]; i < table.offset[v + 1]; i ++) {
+            tsum = tsum + tcontrib[table.corners[i]];
+            bsum = bsum + bcontrib[table.corners[i]];
+        }
+        const vec3 n = table.offset[v] < table.offset[v + 1] ? norms[facet_nrm[table.corners[table.offset[v]]]] : vec3{0, 0, 1};
+        vec3 t = tsum - n * (n * tsum);
+        if(norm(t) <= 1e-12) {
+            // 无有效 UV 梯度时任取一条与法线正交的方向
+            t = std::abs(n.x) < .9 ? cross(n, vec3{1, 0, 0}) : cross(n, vec3{0, 1, 0});
+        }
+        t = normalized(t);
+        const double sign = cross(n, t) * bsum < 0 ? -1. : 1.;
+        tangents[v] = {t.x, t.y, t.z, sign};
+    }
+}
+
+/**
+ * @brief 子网格个数
+ *
+ * @return int
+ */
+int Model::nsubmeshes() const { return submeshes.size(); }
+
+/**
+ * @brief 获取第 i 个子网格
+ *
+ * @param i
+ * @return const Submesh&
+ */
+const Submesh& Model::submesh(const int i) const { return submeshes[i]; }
+
+/**
+ * @brief 材质个数
+ *
+ * @return int
+ */
+int Model::nmaterials() const { return materials.size(); }
+
+/**
+ * @brief 获取第 i 个材质
+ *
+ * @param i
+ * @return const Material&
+ */
+const Material& Model::material(const int i) const { return materials[i]; }
+
+/**
+ * @brief 按名字查找材质，不存在时追加一个默认材质
+ *
+ * @param name
+ * @return int 材质索引
+ */
+int Model::find_material(const std::string& name) {
+    for(int i = 0; i < (int)materials.size(); i ++)
+        if(materials[i].name == name) return i;
+    Material m;
+    m.name = name;
+    materials.push_back(m);
+    return materials.size() - 1;
+}
+
+/**
+ * @brief 按 (名字, 材质) 查找子网格，不存在时追加
+ *
+ * @param name
+ * @param material
+ * @return int 子网格索引
+ */
+int Model::find_submesh(const std::string& name, const int material) {
+    for(int i = 0; i < (int)submeshes.size(); i ++)
+        if(submeshes[i].name == name && submeshes[i].material == material) return i;
+    submeshes.push_back({name, material, 0, 0});
+    return submeshes.size() - 1;
+}
+
+/**
+ * @brief 解析 MTL 材质库
+ *
+ * 支持 newmtl、Ka/Kd/Ks、Ns、d/Tr 以及 map_Kd、map_Ks、map_Bump/bump/norm，
+ * 贴图路径按 MTL 文件所在目录解析。同名材质覆盖先前的定义。
+ *
+ * @param filename
+ * @return 读取情况
+ */
+bool Model::load_mtl(const std::string& filename) {
+    std::ifstream in;
+    in.open(filename, std::ios::in);
+    if(in.fail()) {
+        std::cerr << "Failed to open " << filename << std::endl;
+        return false;
+    }
+    const std::filesystem::path dir = std::filesystem::path(filename).parent_path();
+    std::string line;
+    Material* m = nullptr;
+    while(std::getline(in, line)) {
+        const size_t begin = line.find_first_not_of(" \t");
+        if(begin == std::string::npos) continue;
+        line.erase(0, begin);
+        std::istringstream iss(line);
+        std::string key;
+        iss >> key;
+        if(key == "newmtl") {
+            m = &materials[find_material(line_argument(line, key.size()))];
+            continue;
+        }
+        if(!m) continue;
+        if(key == "Ka")      for(int i = 0; i < 3; i ++) iss >> m->ambient[i];
+        else if(key == "Kd") for(int i = 0; i < 3; i ++) iss >> m->diffuse[i];
+        else if(key == "Ks") for(int i = 0; i < 3; i ++) iss >> m->specular[i];
+        else if(key == "Ns") iss >> m->shininess;
+        else if(key == "d")  iss >> m->opacity;
+        else if(key == "Tr") { iss >> m->opacity; m->opacity = 1 - m->opacity; }
+        else if(key == "map_Kd") m->diffuse_map = (dir / line_argument(line, key.size())).string();
+        else if(key == "map_Ks") m->specular_map = (dir / line_argument(line, key.size())).string();
+        else if(key == "map_Bump" || key == "bump" || key == "norm")
+            m->normal_map = (dir / line_argument(line, key.size())).string();
+    }
+    return true;
+}
+
+/**
+ * @brief 按材质重排三角形，使每个子网格占据连续的面区间
+ *
+ * 子网格按 (材质, 首次出现顺序) 排序后做一次稳定的计数排序，
+ * 子网格内部保持文件中的三角形顺序。
+ *
+ * @param face_submesh 每个三角形所属的子网格
+ */
+void Model::sort_submeshes(const std::vector<int>& face_submesh) {
+    const int ns = submeshes.size();
+    std::vector<int> order(ns);
+    for(int i = 0; i < ns; i ++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return submeshes[a].material < submeshes[b].material;
+    });
+
+    std::vector<int> rank(ns);
+    for(int i = 0; i < ns; i ++) rank[order[i]] = i;
+    std::vector<int> count(ns, 0);
+    for(int s : face_submesh) count[rank[s]] ++;
+
+    std::vector<Submesh> sorted(ns);
+    std::vector<int> cursor(ns);
+    int first = 0;
+    for(int i = 0; i < ns; i ++) {
+        sorted[i] = submeshes[order[i]];
+        sorted[i].first_face = cursor[i] = first;
+        sorted[i].nfaces = count[i];
+        first += count[i];
+    }
+    submeshes = std::move(sorted);
+
+    const int nf = face_submesh.size();
+    std::vector<int> dst(nf);
+    for(int f = 0; f < nf; f ++) dst[f] = cursor[rank[face_submesh[f]]] ++;
+    std::vector<int> v(facet_vert.size()), t(facet_tex.size()), n(facet_nrm.size());
+    #pragma omp parallel for schedule(static)
+    for(int f = 0; f < nf; f ++) {
+        for(int k = 0; k < 3; k ++) {
+            v[dst[f] * 3 + k] = facet_vert[f * 3 + k];
+            t[dst[f] * 3 + k] = facet_tex[f * 3 + k];
+            n[dst[f] * 3 + k] = facet_nrm[f * 3 + k];
+        }
+    }
+    facet_vert = std::move(v);
+    facet_tex = std::move(t);
+    facet_nrm = std::move(n);
+}
@@ -0,0 +1,63 @@
+#include <algorithm>
+
+#include "model/morph.h"
+
+/**
+ * @brief 按权重求值一帧
+ *
+ * @param model
+ * @param weights 第 i 个元素为第 i 个目标的权重，缺少的按 0 处理
+ */
+void MorphBuffer::evaluate(const Model& model, const std::vector<double>& weights) {
+    const int nv = model.nverts();
+    if(source != &model || source_revision != model.revision || (int)pos.size() != nv) {
+        pos = model.verts;
+        mark.assign(nv, 0);
+        moved.clear();
+        source = &model;
+        source_revision = model.revision;
+    }
+    for(const int i : moved) {
+        pos[i] = model.verts[i];
+        mark[i] = 0;
+    }
+    moved.clear();
+
+    const int nt = std::min<int>(weights.size(), model.nmorph_targets());
+    for(int t = 0; t < nt; t ++) {
+        const double w = weights[t];
+        if(w == 0) continue;
+        const MorphTarget& target = model.morph_targets[t];
+        const int n = target.indices.size();
+        for(const int i : target.indices) {
+            if(mark[i]) continue;
+            mark[i] = 1;
+            moved.push_back(i);
+        }
+        const int* idx = target.indices.data();
+        const vec3* d = target.deltas.data();
+        vec3* p = pos.data();
+        #pragma omp parallel for schedule(static) if(n > 16384)
+        for(int k = 0; k < n; k ++) p[idx[k]] = p[idx[k]] + d[k] * w;
+    }
+}
+
+/**
+ * @brief 丢弃缓冲，下一帧从模型重新拷贝基础位置（就地修改了模型顶点后调用）
+ */
+void MorphBuffer::reset() {
+    pos.clear();
+    moved.clear();
+    mark.clear();
+    source = nullptr;
+}
+
+/**
+ * @brief 当前帧的顶点位置，与模型顶点一一对应
+ */
+const std::vector<vec3>& MorphBuffer::positions() const { return pos; }
+
+/**
+ * @brief 当前帧相对基础位置被移动的顶点数
+ */
+int MorphBuffer::touched() const { return moved.size(); }
@@ -0,0 +1,226 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include "model/ply.h"
+
+namespace {
+
+/**
+ * @brief PLY 类型名转换为类型
+ */
+PlyProperty::Type parse_type(const std::string& name) {
+    if(name == "char" || name == "int8") return PlyProperty::INT8;
+    if(name == "uchar" || name == "uint8") return PlyProperty::UINT8;
+    if(name == "short" || name == "int16") return PlyProperty::INT16;
+    if(name == "ushort" || name == "uint16") return PlyProperty::UINT16;
+    if(name == "int" || name == "int32") return PlyProperty::INT32;
+    if(name == "uint" || name == "uint32") return PlyProperty::UINT32;
+    if(name == "float" || name == "float32") return PlyProperty::FLOAT32;
+    if(name == "double" || name == "float64") return PlyProperty::FLOAT64;
+    return PlyProperty::NONE;
+}
+
+/**
+ * @brief 顺序遍历含列表属性的元素，求数据块长度
+ *
+ * @param e
+ * @param p 数据块起始
+ * @param avail 剩余可用字节
+ * @return std::size_t 数据块长度，越界时返回 avail + 1
+ */
+std::size_t walk_element(const PlyElement& e, const std::uint8_t* p, const std::size_t avail) {
+    std::size_t off = 0;
+    for(int i = 0; i < e.count; i ++) {
+        for(const PlyProperty& prop : e.props) {
+            if(prop.count_type == PlyProperty::NONE) {
+                off += PlyProperty::size(prop.type);
+                continue;
+            }
+            const int cs = PlyProperty::size(prop.count_type);
+            if(off + cs > avail) return avail + 1;
+            const double n = PlyProperty::read(p + off, prop.count_type);
+            off += cs;
+            if(n > 0) {
+                // 先与剩余字节数比较再转换，过大（含无穷）的长度不会在转换时溢出
+                const std::size_t is = PlyProperty::size(prop.type);
+                if(!(n <= double((avail - off) / is))) return avail + 1;
+                off += std::size_t(n) * is;
+            }
+        }
+        if(off > avail) return avail + 1;
+    }
+    return off;
+}
+
+} // namespace
+
+/**
+ * @brief 类型的字节数
+ */
+int PlyProperty::size(const Type t) {
+    switch(t) {
+        case INT8: case UINT8: return 1;
+        case INT16: case UINT16: return 2;
+        case INT32: case UINT32: case FLOAT32: return 4;
+        case FLOAT64: return 8;
+        default: return 0;
+    }
+}
+
+/**
+ * @brief 按小端读取一个值（假定宿主为小端）
+ *
+ * @param p
+ * @param t
+ * @return double
+ */
+double PlyProperty::read(const std::uint8_t* p, const Type t) {
+    switch(t) {
+        case INT8: return std::int8_t(p[0]);
+        case UINT8: return p[0];
+        case INT16: { std::int16_t v; std::memcpy(&v, p, 2); return v; }
+        case UINT16: { std::uint16_t v; std::memcpy(&v, p, 2); return v; }
+        case INT32: { std::int32_t v; std::memcpy(&v, p, 4); return v; }
+        case UINT32: { std::uint32_t v; std::memcpy(&v, p, 4); return v; }
+        case FLOAT32: { float v; std::memcpy(&v, p, 4); return v; }
+        case FLOAT64: { double v; std::memcpy(&v, p, 8); return v; }
+        default: return 0;
+    }
+}
+
+/**
+ * @brief 按名字查找属性
+ *
+ * @param prop
+ * @return int 属性下标，不存在时返回 -1
+ */
+int PlyElement::find(const std::string& prop) const {
+    for(int i = 0; i < (int)props.size(); i ++)
+        if(props[i].name == prop) return i;
+    return -1;
+}
+
+/**
+ * @brief 映射文件并解析头部，定位各元素的数据块
+ *
+ * 单一列表属性的元素先并行检查所有列表长度是否等于首个列表长度，
+ * 成立时直接按定长计算块长度，否则顺序遍历。
+ *
+ * @param filename
+ * @return 读取情况
+ */
+bool PlyFile::open(const std::string filename) {
+    if(!file.open(filename)) return false;
+    const char* text = reinterpret_cast<const char*>(file.data());
+    const std::size_t size = file.size();
+    const char* const marker = "end_header";
+    const char* hit = size ? std::search(text, text + size, marker, marker + std::strlen(marker)) : text;
+    if(size < 4 || std::strncmp(text, "ply", 3) != 0 || hit == text + size) {
+        std::cerr << filename << " is not a PLY file\n";
+        return false;
+    }
+    const char* body = hit + std::strlen(marker);
+    while(body < text + size && *body != '\n') body ++;
+    body ++;
+
+    std::istringstream header(std::string(text, hit));
+    std::string line;
+    while(std::getline(header, line)) {
+        std::istringstream iss(line);
+        std::string key;
+        iss >> key;
+        if(key == "format") {
+            std::string format;
+            iss >> format;
+            if(format != "binary_little_endian") {
+                std::cerr << filename << ": unsupported PLY format " << format << "\n";
+                return false;
+            }
+        } else if(key == "element") {
+            PlyElement e;
+            iss >> e.name >> e.count;
+            elements.push_back(e);
+        } else if(key == "property" && !elements.empty()) {
+            PlyProperty prop;
+            std::string type;
+            iss >> type;
+            if(type == "list") {
+                std::string count_type, item_type;
+                iss >> count_type >> item_type;
+                prop.count_type = parse_type(count_type);
+                prop.type = parse_type(item_type);
+                if(prop.count_type == PlyProperty::NONE) prop.type = PlyProperty::NONE;
+            } else {
+                prop.type = parse_type(type);
+            }
+            iss >> prop.name;
+            if(prop.type == PlyProperty::NONE) {
+                std::cerr << filename << ": bad property type in \"" << line << "\"\n";
+                return false;
+            }
+            elements.back().props.push_back(prop);
+        }
+    }
+
+    const std::uint8_t* p = reinterpret_cast<const std::uint8_t*>(body);
+    const std::uint8_t* end = file.data() + size;
+    for(PlyElement& e : elements) {
+        bool fixed = true;
+        int off = 0;
+        for(PlyProperty& prop : e.props) {
+            fixed = fixed && prop.count_type == PlyProperty::NONE;
+            if(fixed) prop.offset = off;
+            off += PlyProperty::size(prop.type);
+        }
+        const std::size_t avail = p <= end ? end - p : 0;
+        e.data = p;
+        if(fixed) {
+            e.stride = off;
+            e.bytes = std::size_t(e.count) * e.stride;
+        } else {
+            const PlyProperty& list = e.props[0];
+            const int cs = PlyProperty::size(list.count_type);
+            if(e.props.size() == 1 && e.count > 0 && avail >= std::size_t(cs)) {
+                const double first = PlyProperty::read(p, list.count_type);
+                // 长度须放得进剩余字节再转换为 int，否则交给 walk_element 报告截断
+                const bool fits = first <= double((avail - cs) / PlyProperty::size(list.type)) &&
+                                  first <= std::numeric_limits<int>::max();
+                const int n = first > 0 && fits ? int(first) : 0;
+                const std::size_t item = cs + std::size_t(n) * PlyProperty::size(list.type);
+                bool uniform = n > 0 && std::size_t(e.count) * item <= avail;
+                if(uniform) {
+                    const int count = e.count;
+                    #pragma omp parallel for schedule(static) reduction(&&:uniform)
+                    for(int i = 0; i < count; i ++)
+                        uniform = uniform && PlyProperty::read(p + std::size_t(i) * item, list.count_type) == n;
+                }
+                if(uniform) {
+                    e.uniform_list = n;
+                    e.bytes = std::size_t(e.count) * item;
+                }
+            }
+            if(!e.uniform_list) e.bytes = walk_element(e, p, avail);
+        }
+        if(e.bytes > avail) {
+            std::cerr << filename << ": truncated element " << e.name << "\n";
+            return false;
+        }
+        p += e.bytes;
+    }
+    return true;
+}
+
+/**
+ * @brief 按名字查找元素
+ *
+ * @param name
+ * @return const PlyElement* 不存在时返回 nullptr
+ */
+const PlyElement* PlyFile::element(const std::string& name) const {
+    for(const PlyElement& e : elements)
+        if(e.name == name) return &e;
+    return nullptr;
+}
@@ -0,0 +1,376 @@
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include "io/preview_server.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define TINY_RENDERER_HAS_UNIX_SOCKET 1
+#endif
+
+namespace {
+
+#ifdef TINY_RENDERER_HAS_UNIX_SOCKET
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+/**
+ * @brief 填写 Unix 域套接字地址
+ *
+ * @return 路径是否放得下
+ */
+bool make_address(const std::string& path, sockaddr_un& addr) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if(path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "socket path too long: " << path << "\n";
+        return false;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+/**
+ * @brief 发送全部数据
+ */
+bool write_all(const int fd, const void* data, std::size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while(size > 0) {
+        const ssize_t n = send(fd, p, size, MSG_NOSIGNAL);
+        if(n <= 0) return false;
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+/**
+ * @brief 接收恰好 size 字节
+ */
+bool read_all(const int fd, void* data, std::size_t size) {
+    char* p = static_cast<char*>(data);
+    while(size > 0) {
+        const ssize_t n = recv(fd, p, size, 0);
+        if(n <= 0) return false;
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+constexpr std::size_t max_line = 4096;     // 请求行与响应头的长度上限（不含换行符）
+
+/**
+ * @brief 逐字节读取一行（不含换行符），客户端读响应头用：头之后紧跟像素，不能多读
+ *
+ * @return 读到换行符；连接关闭或超过 max_line 时为 false
+ */
+bool read_line(const int fd, std::string& line) {
+    line.clear();
+    char c;
+    while(recv(fd, &c, 1, 0) == 1) {
+        if(c == '\n') return true;
+        if(line.size() == max_line) return false;
+        line += c;
+    }
+    return false;
+}
+
+/**
+ * @brief 服务端的请求行读取器，一个连接一个
+ *
+ * 每次 recv 读入一块，多出的字节留给下一行。一行超过 max_line 仍没有换行符时失败，
+ * 对端无法让服务端无限制地缓存数据。
+ */
+class LineReader {
+public:
+    explicit LineReader(const int fd) : fd(fd) {}
+
+    bool next(std::string& line) {
+        std::size_t scanned = pos;
+        for(;;) {
+            const std::size_t eol = buf.find('\n', scanned);
+            if(eol != std::string::npos) {
+                if(eol - pos > max_line) return false;
+                line.assign(buf, pos, eol - pos);
+                pos = eol + 1;
+                return true;
+            }
+            if(buf.size() - pos > max_line) return false;
+            buf.erase(0, pos);
+            pos = 0;
+            scanned = buf.size();
+            char chunk[4096];
+            const ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if(n <= 0) return false;
+            buf.append(chunk, n);
+        }
+    }
+
+private:
+    int fd;
+    std::string buf = {};       // [pos, size) 为尚未取走的字节
+    std::size_t pos = 0;
+};
+#endif
+
+} // namespace
+
+/**
+ * @brief 编码为一行文本（不含换行符）
+ */
+std::string PreviewRequest::to_line() const {
+    std::ostringstream out;
+    out.precision(17);
+    out << "render " << width << ' ' << height << ' ' << RenderSettings::mode_name(mode);
+    for(const vec3* v : {&camera.eye, &camera.center, &camera.up}) out << ' ' << v->x << ' ' << v->y << ' ' << v->z;
+    out << ' ' << int(camera.persp) << ' ' << mesh;
+    return out.str();
+}
+
+/**
+ * @brief 解析一行请求
+ *
+ * @param line
+ * @param out
+ * @return 格式是否正确
+ */
+bool PreviewRequest::parse(const std::string& line, PreviewRequest& out) {
+    std::istringstream in(line);
+    std::string command, mode;
+    PreviewRequest r;
+    int persp = 1;
+    in >> command >> r.width >> r.height >> mode;
+    for(vec3* v : {&r.camera.eye, &r.camera.center, &r.camera.up}) in >> v->x >> v->y >> v->z;
+    in >> persp;
+    if(!in || command != "render" || r.width <= 0 || r.height <= 0 || !RenderSettings::parse_mode(mode, r.mode)) return false;
+    r.camera.persp = persp != 0;
+    if(!r.camera.valid()) return false;
+    std::getline(in >> std::ws, r.mesh);
+    if(r.mesh.empty()) return false;
+    out = r;
+    return true;
+}
+
+/**
+ * @brief Construct a new PreviewServer object
+ *
+ * @param socket_path 监听的套接字路径
+ * @param cache_dir 模型二进制缓存目录，为空时写在源文件旁
+ */
+PreviewServer::PreviewServer(const std::string socket_path, const std::string cache_dir)
+    : socket_path(socket_path), store(cache_dir) {}
+
+PreviewServer::~PreviewServer() {
+#ifdef TINY_RENDERER_HAS_UNIX_SOCKET
+    if(fd >= 0) {
+        close(fd);
+        unlink(socket_path.c_str());
+    }
+#endif
+}
+
+/**
+ * @brief 绑定并监听套接字，已存在的同名套接字文件会被替换
+ *
+ * @return 是否成功
+ */
+bool PreviewServer::open() {
+#ifdef TINY_RENDERER_HAS_UNIX_SOCKET
+    sockaddr_un addr;
+    if(!make_address(socket_path, addr)) return false;
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0) {
+        std::cerr << "can't create socket: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    unlink(socket_path.c_str());
+    if(bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(fd, 4) < 0) {
+        std::cerr << "can't listen on " << socket_path << ": " << std::strerror(errno) << "\n";
+        close(fd);
+        fd = -1;
+        return false;
+    }
+    return true;
+#else
+    std::cerr << "preview server needs Unix domain sockets\n";
+    return false;
+#endif
+}
+
+/**
+ * @brief 接受一个连接并处理其上的全部请求
+ *
+ * @return false 表示收到 quit 或监听出错，服务应退出
+ */
+bool PreviewServer::serve_one() {
+#ifdef TINY_RENDERER_HAS_UNIX_SOCKET
+    if(fd < 0) return false;
+    int client;
+    // 被信号打断或对端在排队时放弃连接不是监听套接字的错误，重试即可
+    do client = accept(fd, nullptr, nullptr);
+    while(client < 0 && (errno == EINTR || errno == ECONNABORTED));
+    if(client < 0) {
+        std::cerr << "accept failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    bool keep = true;
+    std::string line;
+    LineReader reader(client);
+    while(keep && reader.next(line)) keep = handle(client, line);
+    close(client);
+    return keep;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief 依次处理连接直到收到 quit
+ */
+void PreviewServer::run() {
+    while(serve_one()) {}
+}
+
+/**
+ * @brief 处理一行请求并写回响应
+ *
+ * @param client
+ * @param line
+ * @return false 表示收到 quit
+ */
+bool PreviewServer::handle(const int client, const std::string& line) {
+#ifdef TINY_RENDERER_HAS_UNIX_SOCKET
+    if(line == "quit") return false;
+    PreviewRequest request;
+    if(!PreviewRequest::parse(line, request)) {
+        const std::string reply = "error malformed request\n";
+        write_all(client, reply.data(), reply.size());
+        return true;
+    }
+    if(request.width > PreviewRequest::max_size || request.height > PreviewRequest::max_size) {
+        const std::string reply = "error image larger than " + std::to_string(PreviewRequest::max_size) + "x" +
+                                  std::to_string(PreviewRequest::max_size) + "\n";
+        write_all(client, reply.data(), reply.size());
+        return true;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    store.refresh();
+    Scene scene;
+    scene.instances.push_back({store.model(request.mesh)});
+    if(scene.instances[0].model->nfaces() == 0 && scene.instances[0].model->nverts() == 0) {
+        const std::string reply = "error can't load " + request.mesh + "\n";
+        write_all(client, reply.data(), reply.size());
+        return true;
+    }
+    RenderSettings settings = renderer.settings();
+    settings.mode = request.mode;
+    renderer.set_settings(settings);
+    if(fb.width() != request.width || fb.height() != request.height) fb = Framebuffer(request.width, request.height);
+    renderer.render_incremental(scene, request.camera, fb);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<std::uint32_t> pixels(std::size_t(fb.width()) * fb.height());
+    for(int y = 0; y < fb.height(); y ++)
+        for(int x = 0; x < fb.width(); x ++) pixels[std::size_t(y) * fb.width() + x] = Framebuffer::pack(fb.get(x, y));
+    std::ostringstream header;
+    header << "ok " << fb.width() << ' ' << fb.height() << ' ' << ms << "\n";
+    const std::string reply = header.str();
+    if(write_all(client, reply.data(), reply.size())) write_all(client, pixels.data(), pixels.size() * 4);
+    return true;    // 写失败时下一次读取也会失败，连接随之关闭
+#else
+    (void)client;
+    (void)line;
+    return false;
+#endif
+}
+
+PreviewClient::~PreviewClient() {
+#ifdef TINY_RENDERER_HAS_UNIX_SOCKET
+    if(fd >= 0) close(fd);
+#endif
+}
+
+/**
+ * @brief 连接到预览服务
+ *
+ * @param socket_path
+ * @return 是否成功
+ */
+bool PreviewClient::connect(const std::string& socket_path) {
+#ifdef TINY_RENDERER_HAS_UNIX_SOCKET
+    sockaddr_un addr;
+    if(!make_address(socket_path, addr)) return false;
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::cerr << "can't connect to " << socket_path << ": " << std::strerror(errno) << "\n";
+        if(fd >= 0) close(fd);
+        fd = -1;
+        return false;
+    }
+    return true;
+#else
+    (void)socket_path;
+    std::cerr << "preview client needs Unix domain sockets\n";
+    return false;
+#endif
+}
+
+/**
+ * @brief 发送请求并等待画面
+ *
+ * @param request
+ * @param frame
+ * @return 是否成功
+ */
+bool PreviewClient::render(const PreviewRequest& request, PreviewFrame& frame) {
+#ifdef TINY_RENDERER_HAS_UNIX_SOCKET
+    const std::string line = request.to_line() + "\n";
+    std::string header;
+    if(fd < 0 || !write_all(fd, line.data(), line.size()) || !read_line(header)) return false;
+    std::istringstream in(header);
+    std::string status;
+    PreviewFrame f;
+    in >> status >> f.width >> f.height >> f.render_ms;
+    if(status != "ok" || !in) {
+        std::cerr << "preview server: " << header << "\n";
+        return false;
+    }
+    f.pixels.resize(std::size_t(f.width) * f.height);
+    if(!read_all(fd, f.pixels.data(), f.pixels.size() * 4)) return false;
+    frame = std::move(f);
+    return true;
+#else
+    (void)request;
+    (void)frame;
+    return false;
+#endif
+}
+
+/**
+ * @brief 让服务退出
+ */
+void PreviewClient::quit() {
+#ifdef TINY_RENDERER_HAS_UNIX_SOCKET
+    if(fd >= 0) write_all(fd, "quit\n", 5);
+#endif
+}
+
+/**
+ * @brief 读取响应头
+ */
+bool PreviewClient::read_line(std::string& line) {
+#ifdef TINY_RENDERER_HAS_UNIX_SOCKET
+    return ::read_line(fd, line);
+#else
+    (void)line;
+    return false;
+#endif
+}
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <iostream>
+
+#include "render/progressive.h"
+
+namespace {
+
+/**
+ * @brief 把缩小 scale 倍的画面按最近邻放大写入图像
+ *
+ * @param fb
+ * @param scale
+ * @param image
+ */
+void upsample(const Framebuffer& fb, const int scale, TGAImage& image) {
+    const int w = image.width(), h = image.height();
+    #pragma omp parallel for schedule(static)
+    for(int y = 0; y < h; y ++) {
+        for(int x0 = 0; x0 < w; x0 += scale) {
+            const TGAColor c = fb.get(x0 / scale, y / scale);
+            const int x1 = std::min(x0 + scale, w);
+            for(int x = x0; x < x1; x ++) image.set(x, y, c);
+        }
+    }
+}
+
+/**
+ * @brief 把实例的裁剪矩形缩小到低分辨率级别
+ *
+ * 向外取整，低分辨率的画面覆盖原矩形。
+ *
+ * @param scene
+ * @param scale
+ * @param out 需要缩小时写入场景副本
+ * @return 是否有裁剪矩形需要缩小
+ */
+bool scale_scissors(const Scene& scene, const int scale, Scene& out) {
+    if(scale == 1) return false;
+    if(std::none_of(scene.instances.begin(), scene.instances.end(), [](const Instance& i) { return i.scissor.enabled; })) return false;
+    out = scene;
+    auto floor_div = [&](const int v) { return v >= 0 ? v / scale : -((-v + scale - 1) / scale); };
+    for(Instance& inst : out.instances) {
+        ScissorRect& s = inst.scissor;
+        if(!s.enabled) continue;
+        s = {true, floor_div(s.x0), floor_div(s.y0), -floor_div(-s.x1), -floor_div(-s.y1)};
+    }
+    return true;
+}
+
+} // namespace
+
+/**
+ * @brief Construct a new Progressive Renderer object
+ *
+ * @param settings
+ * @param coarsest 第一遍的缩小倍数，向下取为 2 的幂
+ */
+ProgressiveRenderer::ProgressiveRenderer(const RenderSettings settings, const int coarsest) {
+    int s = 1;
+    while(s * 2 <= coarsest) s *= 2;
+    for(; s >= 1; s /= 2) levels.push_back({s, Renderer(settings), {}});
+}
+
+/**
+ * @brief 修改所有级别的渲染设置
+ *
+ * @param s
+ */
+void ProgressiveRenderer::set_settings(const RenderSettings& s) {
+    for(Level& level : levels) level.renderer.set_settings(s);
+}
+
+/**
+ * @brief 遍数
+ */
+int ProgressiveRenderer::npasses() const { return levels.size(); }
+
+/**
+ * @brief 渐进式渲染一帧
+ *
+ * @param scene
+ * @param camera
+ * @param image 目标图像，按其当前尺寸渲染
+ * @param callback 每遍结束后调用，可为空
+ * @return int 完成的遍数，被回调取消时小于 npasses()
+ */
+int ProgressiveRenderer::render(const Scene& scene, const Camera& camera, TGAImage& image, const Callback& callback) {
+    const int w = image.width(), h = image.height();
+    if(w <= 0 || h <= 0) {
+        std::cerr << "progressive render needs an allocated target image\n";
+        return 0;
+    }
+    for(int pass = 0; pass < npasses(); pass ++) {
+        Level& level = levels[pass];
+        const int lw = (w + level.scale - 1) / level.scale, lh = (h + level.scale - 1) / level.scale;
+        if(level.fb.width() != lw || level.fb.height() != lh) level.fb = Framebuffer(lw, lh);
+        Scene scaled;
+        level.renderer.render_incremental(scale_scissors(scene, level.scale, scaled) ? scaled : scene, camera, level.fb);
+        if(level.scale == 1) level.fb.resolve(image);
+        else upsample(level.fb, level.scale, image);
+        if(callback && !callback(pass, level.scale, image)) return pass + 1;
+    }
+    return npasses();
+}
@@ -0,0 +1,204 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "io/hash.h"
+#include "math/quantize.h"
+#include "model/quantized_model.h"
+
+/**
+ * @brief 由 Model 构建量化网格
+ *
+ * @param model
+ */
+QuantizedModel::QuantizedModel(const Model& model)
+    : facet_vert(model.facet_vert), facet_tex(model.facet_tex), facet_nrm(model.facet_nrm),
+      materials(model.materials), submeshes(model.submeshes) {
+    const int nv = model.verts.size();
+    vec3 lo, hi;
+    for(int c = 0; c < 3; c ++) {
+        lo[c] = nv ? std::numeric_limits<double>::max() : 0;
+        hi[c] = nv ? std::numeric_limits<double>::lowest() : 0;
+    }
+    for(const vec3& v : model.verts) {
+        for(int c = 0; c < 3; c ++) {
+            lo[c] = std::min(lo[c], v[c]);
+            hi[c] = std::max(hi[c], v[c]);
+        }
+    }
+    aabb_min = lo;
+    for(int c = 0; c < 3; c ++) step[c] = hi[c] > lo[c] ? (hi[c] - lo[c]) / 65535. : 1;
+
+    pos.resize(std::size_t(nv) * 3);
+    #pragma omp parallel for schedule(static)
+    for(int i = 0; i < nv; i ++)
+        for(int c = 0; c < 3; c ++)
+            pos[i * 3 + c] = std::uint16_t(std::lround(std::clamp((model.verts[i][c] - lo[c]) / step[c], 0., 65535.)));
+
+    const int nn = model.norms.size();
+    nrm.resize(std::size_t(nn) * 2);
+    #pragma omp parallel for schedule(static)
+    for(int i = 0; i < nn; i ++) {
+        const vec2 e = oct_encode(model.norms[i]);
+        nrm[i * 2] = to_snorm16(e.x);
+        nrm[i * 2 + 1] = to_snorm16(e.y);
+    }
+
+    const int nt = model.tex_coord.size();
+    tex.resize(std::size_t(nt) * 2);
+    #pragma omp parallel for schedule(static)
+    for(int i = 0; i < nt; i ++) {
+        tex[i * 2] = float_to_half(model.tex_coord[i].x);
+        tex[i * 2 + 1] = float_to_half(model.tex_coord[i].y);
+    }
+}
+
+/**
+ * @brief 顶点个数
+ */
+int QuantizedModel::nverts() const { return pos.size() / 3; }
+
+/**
+ * @brief 面数
+ */
+int QuantizedModel::nfaces() const { return facet_vert.size() / 3; }
+
+/**
+ * @brief 获取反量化后的顶点
+ *
+ * @param i
+ * @return vec3
+ */
+vec3 QuantizedModel::vert(const int i) const {
+    return {aabb_min.x + pos[i * 3] * step.x, aabb_min.y + pos[i * 3 + 1] * step.y, aabb_min.z + pos[i * 3 + 2] * step.z};
+}
+
+/**
+ * @brief 获取第 iface 个面的第 nthvert 个顶点
+ */
+vec3 QuantizedModel::vert(const int iface, const int nthvert) const {
+    return vert(facet_vert[iface * 3 + nthvert]);
+}
+
+/**
+ * @brief 获取第 iface 个面的第 nthvert 个顶点的纹理坐标
+ */
+vec2 QuantizedModel::uv(const int iface, const int nthvert) const {
+    const int idx = facet_tex[iface * 3 + nthvert];
+    if(idx < 0 || tex.empty()) return {};
+    return {half_to_float(tex[idx * 2]), half_to_float(tex[idx * 2 + 1])};
+}
+
+/**
+ * @brief 获取第 iface 个面的第 nthvert 个顶点的法线
+ */
+vec3 QuantizedModel::normal(const int iface, const int nthvert) const {
+    const int idx = facet_nrm[iface * 3 + nthvert];
+    return oct_decode({from_snorm16(nrm[idx * 2]), from_snorm16(nrm[idx * 2 + 1])});
+}
+
+/**
+ * @brief 获取第 iface 个面的第 nthvert 个顶点的索引
+ */
+int QuantizedModel::facet(const int iface, const int nthvert) const {
+    return facet_vert[iface * 3 + nthvert];
+}
+
+/**
+ * @brief 子网格个数
+ */
+int QuantizedModel::nsubmeshes() const { return submeshes.size(); }
+
+/**
+ * @brief 获取第 i 个子网格
+ */
+const Submesh& QuantizedModel::submesh(const int i) const { return submeshes[i]; }
+
+/**
+ * @brief 材质个数
+ */
+int QuantizedModel::nmaterials() const { return materials.size(); }
+
+/**
+ * @brief 获取第 i 个材质
+ */
+const Material& QuantizedModel::material(const int i) const { return materials[i]; }
+
+/**
+ * @brief 由量化坐标 (qx, qy, qz, 1) 到模型坐标的仿射矩阵
+ *
+ * @return mat<4,4>
+ */
+mat<4,4> QuantizedModel::dequantize_matrix() const {
+    mat<4,4> d;
+    for(int c = 0; c < 3; c ++) {
+        d[c][c] = step[c];
+        d[c][3] = aabb_min[c];
+    }
+    d[3][3] = 1;
+    return d;
+}
+
+/**
+ * @brief 变换全部顶点，反量化融合进矩阵
+ *
+ * 先求 m * D（D 为 dequantize_matrix），逐顶点只做一次 4x3 仿射乘法，
+ * 与直接变换未压缩顶点的代价相同。
+ *
+ * @param m 模型到裁剪空间（或任意目标空间）的矩阵
+ * @param out 输出，大小调整为 nverts()
+ */
+void QuantizedModel::transform(const mat<4,4>& m, std::vector<vec4>& out) const {
+    const mat<4,4> f = m * dequantize_matrix();
+    const int nv = nverts();
+    out.resize(nv);
+    const std::uint16_t* q = pos.data();
+    #pragma omp parallel for simd schedule(static)
+    for(int i = 0; i < nv; i ++) {
+        const double x = q[i * 3], y = q[i * 3 + 1], z = q[i * 3 + 2];
+        out[i] = {
+            f[0].x * x + f[0].y * y + f[0].z * z + f[0].w,
+            f[1].x * x + f[1].y * y + f[1].z * z + f[1].w,
+            f[2].x * x + f[2].y * y + f[2].z * z + f[2].w,
+            f[3].x * x + f[3].y * y + f[3].z * z + f[3].w,
+        };
+    }
+}
+
+/**
+ * @brief 顶点属性占用的字节数（不含面索引）
+ */
+std::size_t QuantizedModel::vertex_bytes() const {
+    return pos.size() * sizeof(pos[0]) + nrm.size() * sizeof(nrm[0]) + tex.size() * sizeof(tex[0]);
+}
+
+/**
+ * @brief 影响画面的内容的哈希：量化参数与数据、面索引、子网格与材质颜色
+ */
+std::uint64_t QuantizedModel::cache_hash() const {
+    Fnv1a h;
+    for(int c = 0; c < 3; c ++) {
+        h.f64(aabb_min[c]);
+        h.f64(step[c]);
+    }
+    auto array = [&](const auto& v) {
+        h.u64(v.size());
+        h.bytes(v.data(), v.size() * sizeof(v[0]));
+    };
+    array(pos);
+    array(nrm);
+    array(tex);
+    array(facet_vert);
+    array(facet_tex);
+    array(facet_nrm);
+    h.u64(submeshes.size());
+    for(const Submesh& sub : submeshes) {
+        h.u64(std::uint64_t(std::int64_t(sub.material)));
+        h.u64(sub.first_face);
+        h.u64(sub.nfaces);
+    }
+    h.u64(materials.size());
+    for(const Material& m : materials)
+        for(int c = 0; c < 3; c ++) h.f64(m.diffuse[c]);
+    return h.value;
+}
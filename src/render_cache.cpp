@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "io/hash.h"
+#include "io/mapped_file.h"
+#include "render/render_cache.h"
+
+namespace {
+
+constexpr char result_magic[4] = {'T', 'R', 'R', 'C'};
+constexpr std::uint32_t result_version = 2;
+constexpr std::size_t header_size = 4 + 4 + 8 + 4 + 4 + 4;     // 之后是描述与像素
+
+/**
+ * @brief 按字节记录渲染输入，接口与 Fnv1a 相同
+ */
+struct ByteWriter {
+    std::string bytes = {};
+
+    void u64(const std::uint64_t v) { bytes.append(reinterpret_cast<const char*>(&v), 8); }
+    void f64(const double v) { bytes.append(reinterpret_cast<const char*>(&v), 8); }
+};
+
+} // namespace
+
+/**
+ * @brief Construct a new RenderCache object
+ *
+ * @param dir 结果目录，不存在时创建
+ */
+RenderCache::RenderCache(const std::string dir) : dir(dir) {
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+}
+
+/**
+ * @brief 结果文件路径
+ */
+std::string RenderCache::path(const std::uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.trc", (unsigned long long)key);
+    return (std::filesystem::path(dir) / name).string();
+}
+
+/**
+ * @brief 网格内容哈希，同一对象只计算一次
+ *
+ * 记录数翻倍时清掉已释放模型的记录，长期运行的进程中表的大小与存活模型数成正比。
+ *
+ * @tparam Mesh Model 或 QuantizedModel
+ */
+template<typename Mesh>
+std::uint64_t RenderCache::mesh_hash(const std::shared_ptr<const Mesh>& model) {
+    if(!model) return 0;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        const auto it = mesh_hashes.find(model.get());
+        if(it != mesh_hashes.end() && it->second.first.lock() == model) return it->second.second;
+    }
+    const std::uint64_t h = model->cache_hash();
+    std::lock_guard<std::mutex> guard(lock);
+    mesh_hashes[model.get()] = {model, h};
+    if(mesh_hashes.size() >= prune_at) {
+        for(auto it = mesh_hashes.begin(); it != mesh_hashes.end(); )
+            it = it->second.first.expired() ? mesh_hashes.erase(it) : std::next(it);
+        prune_at = std::max<std::size_t>(64, mesh_hashes.size() * 2);
+    }
+    return h;
+}
+
+/**
+ * @brief 计算一次渲染的键
+ *
+ * 描述按固定顺序记录影响画面的全部输入：Renderer::version、分辨率、设置、相机、光照，
+ * 以及每个实例实际绘制的网格（Model 或 QuantizedModel）及其内容哈希、代替顶点位置时位置的哈希、变换、颜色、裁剪矩形与模板设置；键是描述的哈希。
+ * 线程数与分块方式不影响输出，不参与其中。
+ *
+ * @param scene
+ * @param camera
+ * @param settings
+ * @param width
+ * @param height
+ * @return Key
+ */
+RenderCache::Key RenderCache::key(const Scene& scene, const Camera& camera, const RenderSettings& settings, const int width, const int height) {
+    ByteWriter d;
+    d.u64(Renderer::version);
+    d.u64(width);
+    d.u64(height);
+    d.u64(settings.mode);
+    d.u64(Framebuffer::pack(settings.background));
+    d.u64(settings.cull_backfaces);
+    d.f64(settings.line_depth_bias);
+    d.f64(settings.crease_angle);
+    for(const vec3* v : {&camera.eye, &camera.center, &camera.up})
+        for(int i = 0; i < 3; i ++) d.f64((*v)[i]);
+    d.u64(camera.persp);
+    for(int i = 0; i < 3; i ++) d.f64(scene.light_dir[i]);
+    d.f64(scene.ambient);
+    d.u64(scene.instances.size());
+    for(const Instance& inst : scene.instances) {
+        d.u64(bool(inst.quantized));
+        d.u64(inst.quantized ? mesh_hash(inst.quantized) : mesh_hash(inst.model));
+        const int nverts = inst.quantized ? inst.quantized->nverts() : inst.model ? inst.model->nverts() : 0;
+        const bool posed = inst.positions && int(inst.positions->size()) == nverts;
+        d.u64(posed);
+        if(posed) {
+            Fnv1a p;
+            p.bytes(inst.positions->data(), inst.positions->size() * sizeof(vec3));
+            d.u64(p.value);
+        }
+        for(int i = 0; i < 4; i ++)
+            for(int j = 0; j < 4; j ++) d.f64(inst.transform[i][j]);
+        d.u64(Framebuffer::pack(inst.color));
+        const ScissorRect& sc = inst.scissor;
+        d.u64(sc.enabled);
+        if(sc.enabled)
+            for(const int v : {sc.x0, sc.y0, sc.x1, sc.y1}) d.u64(std::uint64_t(std::int64_t(v)));
+        const StencilState& st = inst.stencil;
+        d.u64(st.enabled);
+        if(st.enabled)
+            for(const int v : {int(st.func), int(st.ref), int(st.read_mask), int(st.write_mask), int(st.fail), int(st.depth_fail), int(st.pass)})
+                d.u64(v);
+    }
+    Fnv1a h;
+    h.bytes(d.bytes.data(), d.bytes.size());
+    return {h.value, std::move(d.bytes)};
+}
+
+/**
+ * @brief 读取缓存的画面
+ *
+ * 存储的描述须与 key 的描述逐字节相同，键的哈希碰撞不会读出别的画面。
+ *
+ * @param key
+ * @param fb 命中时按存储的尺寸重写，深度清为最远
+ * @return 是否命中
+ */
+bool RenderCache::load(const Key& key, Framebuffer& fb) const {
+    const std::string file = path(key.hash);
+    if(!std::filesystem::exists(file)) return false;
+    MappedFile mapped;
+    if(!mapped.open(file) || mapped.size() < header_size) return false;
+    const std::uint8_t* p = mapped.data();
+    std::uint32_t version, w, h, desc_size;
+    std::uint64_t stored;
+    std::memcpy(&version, p + 4, 4);
+    std::memcpy(&stored, p + 8, 8);
+    std::memcpy(&w, p + 16, 4);
+    std::memcpy(&h, p + 20, 4);
+    std::memcpy(&desc_size, p + 24, 4);
+    if(std::memcmp(p, result_magic, 4) != 0 || version != result_version || stored != key.hash ||
+       mapped.size() != header_size + std::size_t(desc_size) + std::size_t(w) * h * 4) {
+        std::cerr << "ignoring corrupt render cache entry " << file << "\n";
+        return false;
+    }
+    if(desc_size != key.descriptor.size() || std::memcmp(p + header_size, key.descriptor.data(), desc_size) != 0) {
+        std::cerr << "render cache entry " << file << " belongs to different inputs\n";
+        return false;
+    }
+    if(fb.width() != int(w) || fb.height() != int(h)) fb = Framebuffer(w, h);
+    else fb.clear({});
+    const std::uint8_t* pixels = p + header_size + desc_size;
+    for(int y = 0; y < int(h); y ++)
+        for(int x = 0; x < int(w); x ++) std::memcpy(&fb.color(x, y), pixels + (std::size_t(y) * w + x) * 4, 4);
+    return true;
+}
+
+/**
+ * @brief 保存画面
+ *
+ * 先写临时文件再改名，并发写入同一个键时读者不会看到半个文件。
+ *
+ * @param key
+ * @param fb
+ * @return 是否成功
+ */
+bool RenderCache::store(const Key& key, const Framebuffer& fb) const {
+    const std::uint32_t desc_size = key.descriptor.size();
+    std::vector<std::uint8_t> buf(header_size + desc_size + std::size_t(fb.width()) * fb.height() * 4);
+    const std::uint32_t w = fb.width(), h = fb.height();
+    std::memcpy(buf.data(), result_magic, 4);
+    std::memcpy(buf.data() + 4, &result_version, 4);
+    std::memcpy(buf.data() + 8, &key.hash, 8);
+    std::memcpy(buf.data() + 16, &w, 4);
+    std::memcpy(buf.data() + 20, &h, 4);
+    std::memcpy(buf.data() + 24, &desc_size, 4);
+    std::memcpy(buf.data() + header_size, key.descriptor.data(), desc_size);
+    std::uint8_t* pixels = buf.data() + header_size + desc_size;
+    for(int y = 0; y < fb.height(); y ++) {
+        for(int x = 0; x < fb.width(); x ++) {
+            const std::uint32_t c = Framebuffer::pack(fb.get(x, y));
+            std::memcpy(pixels + (std::size_t(y) * w + x) * 4, &c, 4);
+        }
+    }
+
+    const std::string file = path(key.hash);
+    std::ostringstream tmp;
+    tmp << file << ".tmp." << std::this_thread::get_id();
+    {
+        std::ofstream out(tmp.str(), std::ios::binary);
+        out.write(reinterpret_cast<const char*>(buf.data()), buf.size());
+        if(!out.good()) {
+            std::cerr << "can't write render cache entry " << tmp.str() << "\n";
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp.str(), file, ec);
+    if(ec) {
+        std::cerr << "can't write render cache entry " << file << ": " << ec.message() << "\n";
+        std::filesystem::remove(tmp.str(), ec);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 命中时读回画面，否则渲染并保存
+ *
+ * 命中后 fb 不再是 renderer 上一帧的结果，renderer 的增量状态随之失效。
+ *
+ * @param renderer
+ * @param scene
+ * @param camera
+ * @param fb 按其当前尺寸渲染
+ * @param hit 可选，输出是否命中
+ * @return RenderStats 命中时为零
+ */
+RenderStats RenderCache::render(Renderer& renderer, const Scene& scene, const Camera& camera, Framebuffer& fb, bool* hit) {
+    const Key k = key(scene, camera, renderer.settings(), fb.width(), fb.height());
+    const bool found = load(k, fb);
+    if(hit) *hit = found;
+    if(found) {
+        renderer.invalidate();
+        return {};
+    }
+    const RenderStats stats = renderer.render_incremental(scene, camera, fb);
+    store(k, fb);
+    return stats;
+}
@@ -0,0 +1,710 @@
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "render/interpolation.h"
+#include "render/renderer.h"
+
+namespace {
+
+/**
+ * @brief 本帧使用的线程数
+ */
+int thread_count(const RenderSettings& s) {
+#ifdef _OPENMP
+    return s.threads > 0 ? s.threads : omp_get_max_threads();
+#else
+    (void)s;
+    return 1;
+#endif
+}
+
+/**
+ * @brief 两个实例是否相同（模型、量化网格与顶点位置指针、变换、颜色、裁剪矩形与模板设置）
+ */
+bool same_instance(const Instance& a, const Instance& b) {
+    if(a.model != b.model || a.quantized != b.quantized || a.positions != b.positions || !(a.stencil == b.stencil)) return false;
+    if(a.scissor.enabled != b.scissor.enabled) return false;
+    if(a.scissor.enabled && (a.scissor.x0 != b.scissor.x0 || a.scissor.y0 != b.scissor.y0 ||
+                             a.scissor.x1 != b.scissor.x1 || a.scissor.y1 != b.scissor.y1)) return false;
+    for(int i = 0; i < 4; i ++)
+        for(int j = 0; j < 4; j ++)
+            if(a.transform[i][j] != b.transform[i][j]) return false;
+    for(int i = 0; i < 4; i ++)
+        if(a.color[i] != b.color[i]) return false;
+    return true;
+}
+
+/**
+ * @brief 矩形 [x0, x1) x [y0, y1) 与裁剪矩形求交
+ */
+void apply_scissor(const ScissorRect& s, int& x0, int& y0, int& x1, int& y1) {
+    if(!s.enabled) return;
+    x0 = std::max(x0, s.x0);
+    y0 = std::max(y0, s.y0);
+    x1 = std::min(x1, s.x1);
+    y1 = std::min(y1, s.y1);
+}
+
+/**
+ * @brief 对一个片元做模板测试并执行相应的模板操作
+ *
+ * 深度测试在模板测试之后生效：模板失败时执行 fail 并丢弃片元，
+ * 否则按深度结果执行 pass 或 depth_fail。
+ *
+ * @param s
+ * @param value 缓冲中的模板值，按操作改写
+ * @param depth_ok 深度测试是否通过，不做深度测试的模式传 true
+ * @return 片元是否写入
+ */
+bool stencil_pass(const StencilState& s, std::uint8_t& value, const bool depth_ok) {
+    if(!s.enabled) return depth_ok;
+    if(!s.test(value)) {
+        s.apply(s.fail, value);
+        return false;
+    }
+    s.apply(depth_ok ? s.pass : s.depth_fail, value);
+    return depth_ok;
+}
+
+/**
+ * @brief 屏幕坐标向下取整为像素坐标
+ *
+ * 先在 double 中夹到 [-1, limit + 1]：靠近相机平面的顶点可以投影到 1e12 像素之外，
+ * 直接转换为 int 是未定义行为。调用者须保证 v 有限。
+ */
+int pixel_floor(const double v, const int limit) {
+    return int(std::floor(std::clamp(v, -1., limit + 1.)));
+}
+
+/**
+ * @brief 在矩形 [x0, x1) x [y0, y1) 内画线段
+ *
+ * 端点在屏幕坐标中给出，沿主轴逐像素取整插值。每个像素只取决于线段端点，与矩形无关，
+ * 因此同一条线被多个块分别绘制时拼接无缝。端点超出 ±2^24 像素的保护带时先在 double 中
+ * 裁剪到保护带，保护带与块无关，拼接同样无缝。
+ *
+ * @param plot 对每个像素调用 plot(x, y, t)，t 为从 a 到 b 的参数
+ */
+template<typename Plot>
+void line_in_rect(const double fax, const double fay, const double fbx, const double fby,
+                  const int x0, const int y0, const int x1, const int y1, Plot&& plot) {
+    const double guard = 1 << 24;
+    const double p[2] = {fax, fay}, d[2] = {fbx - fax, fby - fay};
+    double t0 = 0, t1 = 1;
+    for(int i = 0; i < 2; i ++) {
+        if(d[i] == 0) {
+            if(std::abs(p[i]) > guard) return;
+            continue;
+        }
+        double ta = (-guard - p[i]) / d[i], tb = (guard - p[i]) / d[i];
+        if(ta > tb) std::swap(ta, tb);
+        t0 = std::max(t0, ta);
+        t1 = std::min(t1, tb);
+    }
+    if(t0 > t1) return;
+    int ax = std::floor(t0 == 0 ? fax : fax + d[0] * t0), ay = std::floor(t0 == 0 ? fay : fay + d[1] * t0);
+    int bx = std::floor(t1 == 1 ? fbx : fax + d[0] * t1), by = std::floor(t1 == 1 ? fby : fay + d[1] * t1);
+    auto plot_t = [&](const int x, const int y, const double t) { plot(x, y, t0 + (t1 - t0) * t); };
+
+    const bool steep = std::abs(ax - bx) < std::abs(ay - by);
+    if(steep) {
+        std::swap(ax, ay);
+        std::swap(bx, by);
+    }
+    const bool reversed = ax > bx;
+    if(reversed) {
+        std::swap(ax, bx);
+        std::swap(ay, by);
+    }
+    const int lo = std::max(ax, steep ? y0 : x0);
+    const int hi = std::min(bx, (steep ? y1 : x1) - 1);
+    for(int u = lo; u <= hi; u ++) {
+        const double t = bx == ax ? 0 : (u - ax) / double(bx - ax);
+        const int v = ay + int(std::floor(t * (by - ay) + .5));
+        const int x = steep ? v : u, y = steep ? u : v;
+        if(x >= x0 && x < x1 && y >= y0 && y < y1) plot_t(x, y, reversed ? 1 - t : t);
+    }
+}
+
+} // namespace
+
+/**
+ * @brief 设置是否相同
+ *
+ * 只比较影响画面的字段；threads 与 fine_grained_binning 只改变调度，切换时不需要重绘。
+ */
+bool RenderSettings::operator==(const RenderSettings& o) const {
+    return mode == o.mode && Framebuffer::pack(background) == Framebuffer::pack(o.background) &&
+           cull_backfaces == o.cull_backfaces &&
+           line_depth_bias == o.line_depth_bias && crease_angle == o.crease_angle;
+}
+
+/**
+ * @brief 模式名（wireframe / points / shaded / hidden-line / feature-line）
+ */
+const char* RenderSettings::mode_name(const Mode m) {
+    switch(m) {
+        case WIREFRAME: return "wireframe";
+        case POINTS: return "points";
+        case HIDDEN_LINE: return "hidden-line";
+        case FEATURE_LINE: return "feature-line";
+        default: return "shaded";
+    }
+}
+
+/**
+ * @brief 按名字解析模式
+ *
+ * @param name
+ * @param out
+ * @return 名字是否有效
+ */
+bool RenderSettings::parse_mode(const std::string& name, Mode& out) {
+    for(const Mode m : {WIREFRAME, POINTS, SHADED, HIDDEN_LINE, FEATURE_LINE}) {
+        if(name == mode_name(m)) {
+            out = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Construct a new Renderer object
+ *
+ * @param settings
+ */
+Renderer::Renderer(const RenderSettings settings) : config(settings) {}
+
+/**
+ * @brief 当前设置
+ */
+const RenderSettings& Renderer::settings() const { return config; }
+
+/**
+ * @brief 修改设置，影响画面的改动会使增量状态失效
+ *
+ * @param s
+ */
+void Renderer::set_settings(const RenderSettings& s) {
+    if(!(s == config)) invalidate();
+    config = s;
+}
+
+/**
+ * @brief 丢弃增量渲染状态，下一帧完整重绘
+ */
+void Renderer::invalidate() {
+    meshes.clear();
+    last_w = last_h = -1;
+}
+
+/**
+ * @brief 完整渲染一帧
+ *
+ * @param scene
+ * @param camera
+ * @param fb 目标缓冲，整个画面被重写
+ * @return RenderStats
+ */
+RenderStats Renderer::render(const Scene& scene, const Camera& camera, Framebuffer& fb) {
+    invalidate();
+    return render_incremental(scene, camera, fb);
+}
+
+/**
+ * @brief 增量渲染一帧，只重绘变化实例覆盖的块
+ *
+ * 相机、分辨率、设置或场景光照变化时退化为完整渲染。fb 须为上一帧渲染的同一个缓冲。
+ *
+ * @param scene
+ * @param camera
+ * @param fb
+ * @return RenderStats
+ */
+RenderStats Renderer::render_incremental(const Scene& scene, const Camera& camera, Framebuffer& fb) {
+    RenderStats stats;
+    // 光照影响所有着色像素，变化时与相机变化一样整帧重绘
+    const bool lighting = scene.light_dir.x != last_light.x || scene.light_dir.y != last_light.y ||
+                          scene.light_dir.z != last_light.z || scene.ambient != last_ambient;
+    const bool full = camera != last_camera || fb.width() != last_w || fb.height() != last_h || lighting;
+    if(full) meshes.clear();
+    last_camera = camera;
+    last_light = scene.light_dir;
+    last_ambient = scene.ambient;
+    last_w = fb.width();
+    last_h = fb.height();
+
+    const int tx = fb.tiles_x();
+    std::vector<char> dirty(fb.ntiles(), full);
+    auto mark = [&](const ScreenMesh& m) {
+        for(int y = m.ty0; y < m.ty1; y ++)
+            for(int x = m.tx0; x < m.tx1; x ++) dirty[y * tx + x] = 1;
+    };
+
+    const int n = scene.instances.size();
+    for(int i = n; i < (int)meshes.size(); i ++) mark(meshes[i]);
+    meshes.resize(n);
+    const mat<4,4> vp = viewport(0, 0, fb.width(), fb.height()) * camera.view_projection(fb.width(), fb.height());
+    for(int i = 0; i < n; i ++) {
+        if(!full && same_instance(meshes[i].source, scene.instances[i])) continue;
+        mark(meshes[i]);
+        setup_instance(scene.instances[i], vp, fb, meshes[i]);
+        if(config.mode == RenderSettings::FEATURE_LINE) setup_features(camera, meshes[i]);
+        mark(meshes[i]);
+        stats.instances_updated ++;
+    }
+
+    bin(fb, dirty);
+
+    std::vector<int> tiles;
+    for(int t = 0; t < fb.ntiles(); t ++) {
+        if(!dirty[t]) continue;
+        tiles.push_back(t);
+        stats.primitives_binned += tile_start[t + 1] - tile_start[t];
+    }
+    stats.tiles_rendered = tiles.size();
+
+    const int nt = tiles.size();
+    #pragma omp parallel for schedule(dynamic) num_threads(thread_count(config))
+    for(int i = 0; i < nt; i ++) raster_tile(tiles[i], scene, fb);
+    return stats;
+}
+
+/**
+ * @brief 变换实例的顶点到屏幕空间，并准备着色所需的逐面数据
+ *
+ * 实例带量化网格时绘制量化网格，否则绘制 model；带 positions 时用它代替网格的顶点位置。
+ *
+ * @param inst
+ * @param vp 世界到屏幕的矩阵（含视口变换）
+ * @param fb
+ * @param out
+ */
+void Renderer::setup_instance(const Instance& inst, const mat<4,4>& vp, const Framebuffer& fb, ScreenMesh& out) const {
+    out = {};
+    out.source = inst;
+    if(inst.quantized) setup_mesh(*inst.quantized, vp, fb, out);
+    else if(inst.model) setup_mesh(*inst.model, vp, fb, out);
+}
+
+/**
+ * @brief setup_instance 对具体网格类型的实现
+ *
+ * QuantizedModel 用 transform 把反量化与模型、视图、投影矩阵合成一次变换，直接从 16 位坐标得到裁剪坐标。
+ *
+ * @tparam Mesh Model 或 QuantizedModel
+ */
+template<typename Mesh>
+void Renderer::setup_mesh(const Mesh& model, const mat<4,4>& vp, const Framebuffer& fb, ScreenMesh& out) const {
+    const Instance& inst = out.source;
+    const mat<4,4> mvp = vp * inst.transform;
+    const int nv = model.nverts();
+    const int nf = model.nfaces();
+    const int nthreads = thread_count(config);
+    out.facets = model.facet_vert.data();
+    out.nfaces = nf;
+
+    constexpr bool quantized = std::is_same_v<Mesh, QuantizedModel>;
+    const std::vector<vec3>* positions = inst.positions && int(inst.positions->size()) == nv ? inst.positions.get() : nullptr;
+    const bool fused = quantized && !positions;
+    if constexpr(quantized) {
+        if(fused) model.transform(mvp, out.verts);
+    }
+    if(!fused) out.verts.resize(nv);
+    double xmin = 1e300, ymin = 1e300, xmax = -1e300, ymax = -1e300;
+    #pragma omp parallel for schedule(static) num_threads(nthreads) reduction(min:xmin, ymin) reduction(max:xmax, ymax)
+    for(int i = 0; i < nv; i ++) {
+        vec4 clip;
+        if(fused) {
+            clip = out.verts[i];
+        } else {
+            const vec3 v = positions ? (*positions)[i] : model.vert(i);
+            clip = mvp * vec4{v.x, v.y, v.z, 1};
+        }
+        if(clip.w <= 1e-9) {
+            out.verts[i] = {0, 0, 0, 0};
+            continue;
+        }
+        const double rw = 1 / clip.w;
+        out.verts[i] = {clip.x * rw, clip.y * rw, clip.z * rw, rw};
+        // 非有限坐标（退化的相机或变换）与 w <= 0 一样丢弃
+        if(!std::isfinite(out.verts[i].x) || !std::isfinite(out.verts[i].y) || !std::isfinite(out.verts[i].z) || !std::isfinite(rw)) {
+            out.verts[i] = {0, 0, 0, 0};
+            continue;
+        }
+        xmin = std::min(xmin, out.verts[i].x);
+        xmax = std::max(xmax, out.verts[i].x);
+        ymin = std::min(ymin, out.verts[i].y);
+        ymax = std::max(ymax, out.verts[i].y);
+    }
+    if(xmin <= xmax) {
+        const int ts = Framebuffer::tile_size;
+        out.tx0 = std::clamp(pixel_floor(xmin, fb.width()) / ts, 0, fb.tiles_x());
+        out.ty0 = std::clamp(pixel_floor(ymin, fb.height()) / ts, 0, fb.tiles_y());
+        out.tx1 = std::clamp(pixel_floor(xmax, fb.width()) / ts + 1, 0, fb.tiles_x());
+        out.ty1 = std::clamp(pixel_floor(ymax, fb.height()) / ts + 1, 0, fb.tiles_y());
+        if(xmax < 0 || ymax < 0) out.tx1 = out.tx0;
+        const ScissorRect& s = inst.scissor;
+        if(s.enabled) {
+            if(s.x0 >= s.x1 || s.y0 >= s.y1) out.tx1 = out.tx0;
+            out.tx0 = std::max(out.tx0, std::clamp(s.x0 / ts, 0, fb.tiles_x()));
+            out.ty0 = std::max(out.ty0, std::clamp(s.y0 / ts, 0, fb.tiles_y()));
+            out.tx1 = std::min(out.tx1, std::clamp((s.x1 + ts - 1) / ts, 0, fb.tiles_x()));
+            out.ty1 = std::min(out.ty1, std::clamp((s.y1 + ts - 1) / ts, 0, fb.tiles_y()));
+        }
+    }
+
+    if(config.mode != RenderSettings::SHADED) return;
+
+    mat<3,3> linear;
+    for(int r = 0; r < 3; r ++)
+        for(int c = 0; c < 3; c ++) linear[r][c] = inst.transform[r][c];
+    const mat<3,3> nmat = std::abs(linear.det()) > 1e-300 ? linear.invert_transpose() : linear;
+    out.normals.resize(std::size_t(nf) * 3);
+    #pragma omp parallel for schedule(static) num_threads(nthreads)
+    for(int f = 0; f < nf; f ++) {
+        for(int k = 0; k < 3; k ++) {
+            const vec3 n = nmat * model.normal(f, k);
+            const double len = norm(n);
+            out.normals[f * 3 + k] = len > 0 ? n / len : vec3{0, 0, 1};
+        }
+    }
+
+    const vec3 base = {inst.color[2] / 255., inst.color[1] / 255., inst.color[0] / 255.};    // RGB
+    out.albedo.assign(nf, base);
+    for(int s = 0; s < model.nsubmeshes(); s ++) {
+        const Submesh& sub = model.submesh(s);
+        if(sub.material < 0) continue;
+        const vec3 kd = model.material(sub.material).diffuse;
+        const vec3 c = {base.x * kd.x, base.y * kd.y, base.z * kd.z};
+        std::fill(out.albedo.begin() + sub.first_face, out.albedo.begin() + sub.first_face + sub.nfaces, c);
+    }
+}
+
+/**
+ * @brief 提取实例在本视角下的特征边
+ *
+ * 邻接表按模型缓存，视点变换到模型空间后逐面判断朝向，不需要逐实例变换法线。
+ *
+ * @param camera
+ * @param out setup_instance 的输出
+ */
+void Renderer::setup_features(const Camera& camera, ScreenMesh& out) {
+    if(out.source.quantized) setup_features(camera, out.source.quantized, out);
+    else if(out.source.model) setup_features(camera, out.source.model, out);
+}
+
+/**
+ * @brief setup_features 对具体网格类型的实现
+ *
+ * @tparam Mesh Model 或 QuantizedModel
+ */
+template<typename Mesh>
+void Renderer::setup_features(const Camera& camera, const std::shared_ptr<const Mesh>& model, ScreenMesh& out) {
+    for(auto it = adjacency.begin(); it != adjacency.end(); ) {
+        if(it->second.first.expired()) it = adjacency.erase(it);
+        else ++ it;
+    }
+    auto& entry = adjacency[model.get()];
+    if(entry.first.lock() != model || !entry.second) entry = {model, std::make_shared<const EdgeAdjacency>(*model)};
+    out.adjacency = entry.second;
+
+    const mat<4,4> inv = out.source.transform.invert();
+    vec4 view = camera.persp ? vec4{camera.eye.x, camera.eye.y, camera.eye.z, 1}
+                             : vec4{camera.eye.x - camera.center.x, camera.eye.y - camera.center.y, camera.eye.z - camera.center.z, 0};
+    view = inv * view;
+    const vec3 v = camera.persp && std::abs(view.w) > 1e-300 ? vec3{view.x, view.y, view.z} / view.w : vec3{view.x, view.y, view.z};
+    out.features = out.adjacency->feature_edges(*model, v, camera.persp, config.crease_angle);
+}
+
+/**
+ * @brief 把图元按屏幕包围盒分到脏块
+ *
+ * 全部实例的图元按 (实例, 图元) 顺序连续编号后切段并行处理，分两遍：
+ * 第一遍各段统计落在每个块的引用数，按 (块, 段) 顺序做前缀和得到各段在每个块中的写入位置，
+ * 第二遍各段把引用写入同一个按块连续的数组。块内顺序因此总是提交顺序，与分段方式和线程数无关。
+ * 结果存放在 refs 与 tile_start 中，缓冲跨帧复用。
+ *
+ * @param fb
+ * @param dirty 每个块是否需要重绘
+ */
+void Renderer::bin(const Framebuffer& fb, const std::vector<char>& dirty) {
+    const int ts = Framebuffer::tile_size;
+    const int tx = fb.tiles_x();
+    const int ntiles = fb.ntiles();
+    const bool points = config.mode == RenderSettings::POINTS;
+    const bool features = config.mode == RenderSettings::FEATURE_LINE;
+
+    const int n = meshes.size();
+    std::vector<long long> offset(n + 1, 0);
+    for(int i = 0; i < n; i ++) {
+        const ScreenMesh& m = meshes[i];
+        const bool visible = !m.verts.empty() && m.tx0 < m.tx1 && m.ty0 < m.ty1;
+        offset[i + 1] = offset[i] + (visible ? (points ? m.verts.size() : m.nfaces + m.features.size()) : 0);
+    }
+    const long long total = offset[n];
+
+    // 对 [begin, end) 中每个图元覆盖的每个脏块调用 emit(块, 引用)，两遍共用同一套包围盒与剔除逻辑
+    auto visit = [&](const long long begin, const long long end, auto&& emit) {
+        auto push = [&](const int inst, const int prim, double xmin, double ymin, double xmax, double ymax) {
+            int px0 = std::max(0, pixel_floor(xmin, fb.width())), py0 = std::max(0, pixel_floor(ymin, fb.height()));
+            int px1 = std::min(fb.width(), pixel_floor(xmax, fb.width()) + 1), py1 = std::min(fb.height(), pixel_floor(ymax, fb.height()) + 1);
+            apply_scissor(meshes[inst].source.scissor, px0, py0, px1, py1);
+            if(px0 >= px1 || py0 >= py1) return;
+            px1 --;
+            py1 --;
+            for(int y = py0 / ts; y <= py1 / ts; y ++)
+                for(int x = px0 / ts; x <= px1 / ts; x ++)
+                    if(dirty[y * tx + x]) emit(y * tx + x, PrimRef{inst, prim});
+        };
+        int i = std::upper_bound(offset.begin(), offset.end(), begin) - offset.begin() - 1;
+        for(long long g = begin; g < end; g ++) {
+            while(g >= offset[i + 1]) i ++;
+            const ScreenMesh& m = meshes[i];
+            const int prim = g - offset[i];
+            if(points) {
+                const vec4& p = m.verts[prim];
+                if(p.w > 0) push(i, prim, p.x, p.y, p.x, p.y);
+                continue;
+            }
+            if(features && prim >= m.nfaces) {
+                const Edge& e = m.adjacency->edge(m.features[prim - m.nfaces]);
+                const vec4& a = m.verts[e.v0];
+                const vec4& b = m.verts[e.v1];
+                if(a.w > 0 && b.w > 0) push(i, prim, std::min(a.x, b.x), std::min(a.y, b.y), std::max(a.x, b.x), std::max(a.y, b.y));
+                continue;
+            }
+            const vec4& a = m.verts[m.facets[prim * 3]];
+            const vec4& b = m.verts[m.facets[prim * 3 + 1]];
+            const vec4& c = m.verts[m.facets[prim * 3 + 2]];
+            if(a.w <= 0 || b.w <= 0 || c.w <= 0) continue;      // 不做近平面裁剪，跨过相机平面的三角形整体丢弃
+            if(config.mode != RenderSettings::WIREFRAME) {
+                const double area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+                if(area == 0 || (config.cull_backfaces && area < 0)) continue;
+            }
+            push(i, prim, std::min({a.x, b.x, c.x}), std::min({a.y, b.y, c.y}),
+                          std::max({a.x, b.x, c.x}), std::max({a.y, b.y, c.y}));
+        }
+    };
+
+    // 段数只影响并行度：默认每线程一段，fine_grained_binning 时切得更细以平衡负载
+    const int nthreads = thread_count(config);
+    const long long max_chunks = config.fine_grained_binning ? 4LL * nthreads : nthreads;
+    const int nchunks = std::max(1LL, std::min(max_chunks, total / 4096));
+    const long long chunk = (total + nchunks - 1) / nchunks;
+    cursor.assign(std::size_t(nchunks) * ntiles, 0);
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(nthreads)
+    for(int k = 0; k < nchunks; k ++) {
+        long long* counts = &cursor[std::size_t(k) * ntiles];
+        visit(k * chunk, std::min(total, (k + 1) * chunk), [&](const int t, const PrimRef&) { counts[t] ++; });
+    }
+
+    tile_start.assign(ntiles + 1, 0);
+    long long running = 0;
+    for(int t = 0; t < ntiles; t ++) {
+        tile_start[t] = running;
+        for(int k = 0; k < nchunks; k ++) {
+            long long& c = cursor[std::size_t(k) * ntiles + t];
+            const long long count = c;
+            c = running;
+            running += count;
+        }
+    }
+    tile_start[ntiles] = running;
+    refs.resize(running);
+
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(nthreads)
+    for(int k = 0; k < nchunks; k ++) {
+        long long* pos = &cursor[std::size_t(k) * ntiles];
+        visit(k * chunk, std::min(total, (k + 1) * chunk), [&](const int t, const PrimRef& r) { refs[pos[t] ++] = r; });
+    }
+}
+
+/**
+ * @brief 只写深度的光栅化，消隐线框与特征线的第一遍
+ *
+ * 遵守实例的裁剪矩形；不做模板测试，模板只作用于画线的第二遍。
+ *
+ * @param tile
+ * @param fb
+ */
+void Renderer::depth_tile(const int tile, Framebuffer& fb) const {
+    const int ts = Framebuffer::tile_size;
+    const int tile_x0 = tile % fb.tiles_x() * ts, tile_y0 = tile / fb.tiles_x() * ts;
+    const int tile_x1 = std::min(tile_x0 + ts, fb.width()), tile_y1 = std::min(tile_y0 + ts, fb.height());
+    for(long long r = tile_start[tile]; r < tile_start[tile + 1]; r ++) {
+        const PrimRef& ref = refs[r];
+        const ScreenMesh& m = meshes[ref.instance];
+        if(ref.prim >= m.nfaces) continue;
+        int x0 = tile_x0, y0 = tile_y0, x1 = tile_x1, y1 = tile_y1;
+        apply_scissor(m.source.scissor, x0, y0, x1, y1);
+        const vec4& a = m.verts[m.facets[ref.prim * 3]];
+        const vec4& b = m.verts[m.facets[ref.prim * 3 + 1]];
+        const vec4& c = m.verts[m.facets[ref.prim * 3 + 2]];
+        TriangleSetup tri;
+        if(!tri.setup(a, b, c)) continue;
+        const int bx0 = std::max(x0, pixel_floor(std::min({a.x, b.x, c.x}), fb.width()));
+        const int by0 = std::max(y0, pixel_floor(std::min({a.y, b.y, c.y}), fb.height()));
+        const int bx1 = std::min(x1 - 1, pixel_floor(std::max({a.x, b.x, c.x}), fb.width()));
+        const int by1 = std::min(y1 - 1, pixel_floor(std::max({a.y, b.y, c.y}), fb.height()));
+        for(int y = by0; y <= by1; y ++) {
+            const double py = y + .5;
+            const double r0 = tri.bary[0].b * py + tri.bary[0].c;
+            const double r1 = tri.bary[1].b * py + tri.bary[1].c;
+            const double r2 = tri.bary[2].b * py + tri.bary[2].c;
+            const double rz = tri.z.b * py + tri.z.c;
+            for(int x = bx0; x <= bx1; x ++) {
+                const double px = x + .5;
+                if(tri.bary[0].a * px + r0 < 0 || tri.bary[1].a * px + r1 < 0 || tri.bary[2].a * px + r2 < 0) continue;
+                float& depth = fb.depth(x, y);
+                depth = std::max(depth, float(tri.z.a * px + rz));
+            }
+        }
+    }
+}
+
+/**
+ * @brief 清空并光栅化一个块
+ *
+ * 清空只把块标为 CLEARED，没有图元覆盖像素的块不会被填充；结束时颜色全同的块标为 CONSTANT。
+ *
+ * @param tile
+ * @param scene
+ * @param fb
+ */
+void Renderer::raster_tile(const int tile, const Scene& scene, Framebuffer& fb) const {
+    const int ts = Framebuffer::tile_size;
+    const int tile_x0 = tile % fb.tiles_x() * ts, tile_y0 = tile / fb.tiles_x() * ts;
+    const int tile_x1 = std::min(tile_x0 + ts, fb.width()), tile_y1 = std::min(tile_y0 + ts, fb.height());
+    fb.clear_tile(tile, config.background);
+    const vec3 light = normalized(scene.light_dir);
+    if(config.mode == RenderSettings::HIDDEN_LINE || config.mode == RenderSettings::FEATURE_LINE) depth_tile(tile, fb);
+
+    for(long long r = tile_start[tile]; r < tile_start[tile + 1]; r ++) {
+        const PrimRef& ref = refs[r];
+        if(meshes[ref.instance].source.stencil.enabled) raster_prim<true>(ref, tile_x0, tile_y0, tile_x1, tile_y1, scene, light, fb);
+        else raster_prim<false>(ref, tile_x0, tile_y0, tile_x1, tile_y1, scene, light, fb);
+    }
+    fb.compact_tile(tile);
+}
+
+/**
+ * @brief 在块 [tile_x0, tile_x1) x [tile_y0, tile_y1) 内光栅化一个图元
+ *
+ * @tparam Stencil 实例是否开启模板测试，按图元选定一次，像素循环内不再判断
+ * @param ref
+ * @param scene
+ * @param light 归一化的光照方向
+ * @param fb
+ */
+template<bool Stencil>
+void Renderer::raster_prim(const PrimRef& ref, const int tile_x0, const int tile_y0, const int tile_x1, const int tile_y1,
+                           const Scene& scene, const vec3& light, Framebuffer& fb) const {
+    const ScreenMesh& m = meshes[ref.instance];
+    const std::uint32_t flat = Framebuffer::pack(m.source.color);
+    // 模板关闭时不访问模板缓冲，未写过模板的块也就不会被填充
+    auto pass = [&](const int x, const int y, const bool depth_ok) {
+        if constexpr(Stencil) return stencil_pass(m.source.stencil, fb.stencil(x, y), depth_ok);
+        else return depth_ok;
+    };
+    // 块与实例裁剪矩形的交，逐图元的光栅化范围都限制在其中
+    int x0 = tile_x0, y0 = tile_y0, x1 = tile_x1, y1 = tile_y1;
+    apply_scissor(m.source.scissor, x0, y0, x1, y1);
+    if(config.mode == RenderSettings::POINTS) {
+        const vec4& p = m.verts[ref.prim];
+        const int x = pixel_floor(p.x, fb.width()), y = pixel_floor(p.y, fb.height());
+        if(x >= x0 && x < x1 && y >= y0 && y < y1 && pass(x, y, true)) fb.color(x, y) = flat;
+        return;
+    }
+
+    const int* facets = m.facets;
+    if(config.mode == RenderSettings::FEATURE_LINE) {
+        if(ref.prim < m.nfaces) return;
+        // 与 HIDDEN_LINE 相同的偏移，坡度取两侧面中较陡的一个
+        const Edge& e = m.adjacency->edge(m.features[ref.prim - m.nfaces]);
+        double slope = 0;
+        for(const int f : {e.f0, e.f1}) {
+            TriangleSetup tri;
+            if(f >= 0 && tri.setup(m.verts[facets[f * 3]], m.verts[facets[f * 3 + 1]], m.verts[facets[f * 3 + 2]]))
+                slope = std::max({slope, std::abs(tri.z.a), std::abs(tri.z.b)});
+        }
+        const double bias = config.line_depth_bias + slope;
+        const vec4& a = m.verts[e.v0];
+        const vec4& b = m.verts[e.v1];
+        line_in_rect(a.x, a.y, b.x, b.y, x0, y0, x1, y1,
+                     [&](const int x, const int y, const double t) {
+                         if(pass(x, y, a.z + (b.z - a.z) * t + bias >= fb.depth(x, y)))
+                             fb.color(x, y) = flat;
+                     });
+        return;
+    }
+    const vec4* v[3] = { &m.verts[facets[ref.prim * 3]], &m.verts[facets[ref.prim * 3 + 1]], &m.verts[facets[ref.prim * 3 + 2]] };
+    if(config.mode == RenderSettings::WIREFRAME) {
+        for(int k = 0; k < 3; k ++) {
+            const vec4& a = *v[k];
+            const vec4& b = *v[(k + 1) % 3];
+            line_in_rect(a.x, a.y, b.x, b.y, x0, y0, x1, y1,
+                         [&](const int x, const int y, double) {
+                             if(pass(x, y, true)) fb.color(x, y) = flat;
+                         });
+        }
+        return;
+    }
+    if(config.mode == RenderSettings::HIDDEN_LINE) {
+        // 线上的深度由端点插值，与像素中心处三角形的深度相差约一个像素的深度梯度，偏移随坡度放大
+        TriangleSetup tri;
+        if(!tri.setup(*v[0], *v[1], *v[2])) return;
+        const double bias = config.line_depth_bias + std::max(std::abs(tri.z.a), std::abs(tri.z.b));
+        for(int k = 0; k < 3; k ++) {
+            const vec4& a = *v[k];
+            const vec4& b = *v[(k + 1) % 3];
+            line_in_rect(a.x, a.y, b.x, b.y, x0, y0, x1, y1,
+                         [&](const int x, const int y, const double t) {
+                             if(pass(x, y, a.z + (b.z - a.z) * t + bias >= fb.depth(x, y)))
+                                 fb.color(x, y) = flat;
+                         });
+        }
+        return;
+    }
+
+    TriangleSetup tri;
+    if(!tri.setup(*v[0], *v[1], *v[2])) return;
+    const int bx0 = std::max(x0, pixel_floor(std::min({v[0]->x, v[1]->x, v[2]->x}), fb.width()));
+    const int by0 = std::max(y0, pixel_floor(std::min({v[0]->y, v[1]->y, v[2]->y}), fb.height()));
+    const int bx1 = std::min(x1 - 1, pixel_floor(std::max({v[0]->x, v[1]->x, v[2]->x}), fb.width()));
+    const int by1 = std::min(y1 - 1, pixel_floor(std::max({v[0]->y, v[1]->y, v[2]->y}), fb.height()));
+    const vec3* n = &m.normals[std::size_t(ref.prim) * 3];
+    // 法线按 attr/w 插值；随后要归一化，除以 1/w 的缩放被抵消，逐像素不需要倒数
+    const Plane nw[3] = { tri.perspective(n[0].x, n[1].x, n[2].x),
+                          tri.perspective(n[0].y, n[1].y, n[2].y),
+                          tri.perspective(n[0].z, n[1].z, n[2].z) };
+    const vec3 albedo = m.albedo[ref.prim];
+    for(int y = by0; y <= by1; y ++) {
+        // 每行先算出各平面的 b * y + c，逐像素只剩一次乘加
+        const double py = y + .5;
+        const double r0 = tri.bary[0].b * py + tri.bary[0].c;
+        const double r1 = tri.bary[1].b * py + tri.bary[1].c;
+        const double r2 = tri.bary[2].b * py + tri.bary[2].c;
+        const double rz = tri.z.b * py + tri.z.c;
+        const double rn[3] = { nw[0].b * py + nw[0].c, nw[1].b * py + nw[1].c, nw[2].b * py + nw[2].c };
+        for(int x = bx0; x <= bx1; x ++) {
+            const double px = x + .5;
+            if(tri.bary[0].a * px + r0 < 0 || tri.bary[1].a * px + r1 < 0 || tri.bary[2].a * px + r2 < 0) continue;
+            const float z = tri.z.a * px + rz;
+            float& depth = fb.depth(x, y);
+            if(!pass(x, y, z > depth)) continue;
+            depth = z;
+            const vec3 normal = normalized(vec3{nw[0].a * px + rn[0], nw[1].a * px + rn[1], nw[2].a * px + rn[2]});
+            const double intensity = scene.ambient + (1 - scene.ambient) * std::max(0., normal * light);
+            TGAColor c = {0, 0, 0, 255};
+            for(int i = 0; i < 3; i ++) c[2 - i] = std::uint8_t(std::clamp(albedo[i] * intensity, 0., 1.) * 255 + .5);
+            fb.color(x, y) = Framebuffer::pack(c);
+        }
+    }
+}
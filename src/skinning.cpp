@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <cmath>
+
+#include "model/skinning.h"
+
+namespace {
+
+/**
+ * @brief 关节矩阵的仿射部分（3x4，行主序）
+ */
+void affine_rows(const mat<4,4>& m, float out[12]) {
+    for(int r = 0; r < 3; r ++)
+        for(int c = 0; c < 4; c ++) out[r * 4 + c] = m[r][c];
+}
+
+/**
+ * @brief 关节矩阵转为单位对偶四元数 (实部 xyzw, 对偶部 xyzw)，去掉各列的缩放
+ */
+void dual_quaternion(const mat<4,4>& m, float out[8]) {
+    double r[3][3];
+    for(int c = 0; c < 3; c ++) {
+        const double len = std::sqrt(m[0][c] * m[0][c] + m[1][c] * m[1][c] + m[2][c] * m[2][c]);
+        for(int i = 0; i < 3; i ++) r[i][c] = len > 0 ? m[i][c] / len : (i == c);
+    }
+    double x, y, z, w;
+    const double trace = r[0][0] + r[1][1] + r[2][2];
+    if(trace > 0) {
+        const double s = std::sqrt(trace + 1) * 2;
+        w = s / 4;
+        x = (r[2][1] - r[1][2]) / s;
+        y = (r[0][2] - r[2][0]) / s;
+        z = (r[1][0] - r[0][1]) / s;
+    } else if(r[0][0] > r[1][1] && r[0][0] > r[2][2]) {
+        const double s = std::sqrt(1 + r[0][0] - r[1][1] - r[2][2]) * 2;
+        w = (r[2][1] - r[1][2]) / s;
+        x = s / 4;
+        y = (r[0][1] + r[1][0]) / s;
+        z = (r[0][2] + r[2][0]) / s;
+    } else if(r[1][1] > r[2][2]) {
+        const double s = std::sqrt(1 + r[1][1] - r[0][0] - r[2][2]) * 2;
+        w = (r[0][2] - r[2][0]) / s;
+        x = (r[0][1] + r[1][0]) / s;
+        y = s / 4;
+        z = (r[1][2] + r[2][1]) / s;
+    } else {
+        const double s = std::sqrt(1 + r[2][2] - r[0][0] - r[1][1]) * 2;
+        w = (r[1][0] - r[0][1]) / s;
+        x = (r[0][2] + r[2][0]) / s;
+        y = (r[1][2] + r[2][1]) / s;
+        z = s / 4;
+    }
+    const double len = std::sqrt(x * x + y * y + z * z + w * w);
+    x /= len, y /= len, z /= len, w /= len;
+    // 对偶部 = (0, t) * 实部 / 2
+    const double tx = m[0][3], ty = m[1][3], tz = m[2][3];
+    const double d[4] = {
+        (tx * w + ty * z - tz * y) / 2,
+        (-tx * z + ty * w + tz * x) / 2,
+        (tx * y - ty * x + tz * w) / 2,
+        (-tx * x - ty * y - tz * z) / 2,
+    };
+    const double q[8] = {x, y, z, w, d[0], d[1], d[2], d[3]};
+    for(int i = 0; i < 8; i ++) out[i] = q[i];
+}
+
+} // namespace
+
+/**
+ * @brief 对一个网格蒙皮
+ *
+ * 越界的关节号权重按 0 处理；权重先归一化，和为 0 的顶点保持原位。
+ * 没有蒙皮权重的模型原样输出。
+ *
+ * @param model
+ * @param joints 关节矩阵
+ * @param method
+ * @param positions 输出，大小调整为顶点数
+ */
+void Skinning::skin(const Model& model, const std::vector<mat<4,4>>& joints, const Method method, std::vector<vec3>& positions) {
+    const int nv = model.nverts();
+    positions.resize(nv);
+    if(!model.has_skin()) {
+        std::copy(model.verts.begin(), model.verts.end(), positions.begin());
+        return;
+    }
+    const bool dq = method == DUAL_QUATERNION;
+    const int stride = dq ? 8 : 12;
+    const int nj = joints.size();
+    std::vector<float> table(std::size_t(nj + 1) * stride, 0.f);   // 末尾多一个零关节，无效关节指向它
+    for(int j = 0; j < nj; j ++) {
+        if(dq) dual_quaternion(joints[j], &table[j * stride]);
+        else affine_rows(joints[j], &table[j * stride]);
+    }
+    const float* jt = table.data();
+    const int nblocks = (nv + lanes - 1) / lanes;
+
+    #pragma omp parallel for schedule(static)
+    for(int b = 0; b < nblocks; b ++) {
+        const int first = b * lanes;
+        const int count = std::min(lanes, nv - first);
+        float px[lanes], py[lanes], pz[lanes], w[4][lanes];
+        int j[4][lanes];
+        bool keep[lanes];
+        for(int l = 0; l < lanes; l ++) {
+            const int v = first + std::min(l, count - 1);
+            const vec3& p = model.verts[v];
+            const vec4& wt = model.skin_weights[v];
+            px[l] = p.x, py[l] = p.y, pz[l] = p.z;
+            double sum = 0;
+            for(int k = 0; k < 4; k ++) {
+                const int id = model.skin_joints[v * 4 + k];
+                j[k][l] = id < nj ? id : nj;
+                w[k][l] = id < nj ? wt[k] : 0;
+                sum += w[k][l];
+            }
+            keep[l] = sum <= 0;
+            for(int k = 0; k < 4; k ++) w[k][l] = sum > 0 ? w[k][l] / sum : 0;
+        }
+
+        float ox[lanes], oy[lanes], oz[lanes];
+        if(!dq) {
+            float m[12][lanes] = {};
+            for(int k = 0; k < 4; k ++) {
+                #pragma omp simd
+                for(int l = 0; l < lanes; l ++) {
+                    const float* J = jt + j[k][l] * 12;
+                    for(int e = 0; e < 12; e ++) m[e][l] += w[k][l] * J[e];
+                }
+            }
+            #pragma omp simd
+            for(int l = 0; l < lanes; l ++) {
+                ox[l] = m[0][l] * px[l] + m[1][l] * py[l] + m[2][l] * pz[l] + m[3][l];
+                oy[l] = m[4][l] * px[l] + m[5][l] * py[l] + m[6][l] * pz[l] + m[7][l];
+                oz[l] = m[8][l] * px[l] + m[9][l] * py[l] + m[10][l] * pz[l] + m[11][l];
+            }
+        } else {
+            float q[8][lanes] = {};
+            for(int k = 0; k < 4; k ++) {
+                #pragma omp simd
+                for(int l = 0; l < lanes; l ++) {
+                    // 与第一个关节的实部不在同一半球时取反，保证沿最短路径混合
+                    const float* J = jt + j[k][l] * 8;
+                    const float* J0 = jt + j[0][l] * 8;
+                    const float dot = J[0] * J0[0] + J[1] * J0[1] + J[2] * J0[2] + J[3] * J0[3];
+                    const float s = dot < 0 ? -w[k][l] : w[k][l];
+                    for(int e = 0; e < 8; e ++) q[e][l] += s * J[e];
+                }
+            }
+            #pragma omp simd
+            for(int l = 0; l < lanes; l ++) {
+                const float len = std::sqrt(q[0][l] * q[0][l] + q[1][l] * q[1][l] + q[2][l] * q[2][l] + q[3][l] * q[3][l]);
+                const float inv = len > 0 ? 1 / len : 0;
+                const float rx = q[0][l] * inv, ry = q[1][l] * inv, rz = q[2][l] * inv, rw = q[3][l] * inv;
+                const float dx = q[4][l] * inv, dy = q[5][l] * inv, dz = q[6][l] * inv, dw = q[7][l] * inv;
+                // 旋转：p + 2 r × (r × p + w p)
+                const float cx = ry * pz[l] - rz * py[l] + rw * px[l];
+                const float cy = rz * px[l] - rx * pz[l] + rw * py[l];
+                const float cz = rx * py[l] - ry * px[l] + rw * pz[l];
+                // 平移：2 (w d - d.w r + r × d)
+                const float tx = 2 * (rw * dx - dw * rx + ry * dz - rz * dy);
+                const float ty = 2 * (rw * dy - dw * ry + rz * dx - rx * dz);
+                const float tz = 2 * (rw * dz - dw * rz + rx * dy - ry * dx);
+                ox[l] = px[l] + 2 * (ry * cz - rz * cy) + tx;
+                oy[l] = py[l] + 2 * (rz * cx - rx * cz) + ty;
+                oz[l] = pz[l] + 2 * (rx * cy - ry * cx) + tz;
+            }
+        }
+        for(int l = 0; l < count; l ++)
+            positions[first + l] = keep[l] ? model.verts[first + l] : vec3{ox[l], oy[l], oz[l]};
+    }
+}
+
+/**
+ * @brief 并行地对多个网格蒙皮，每个线程一次处理一个网格
+ *
+ * @param jobs
+ * @param method
+ */
+void Skinning::skin_meshes(const std::vector<Job>& jobs, const Method method) {
+    const int n = jobs.size();
+    #pragma omp parallel for schedule(dynamic)
+    for(int i = 0; i < n; i ++) {
+        const Job& job = jobs[i];
+        if(job.model && job.joints && job.positions) skin(*job.model, *job.joints, method, *job.positions);
+    }
+}
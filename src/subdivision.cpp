@@ -0,0 +1,235 @@
+#include <cmath>
+#include <cstdint>
+
+#include "model/edge_adjacency.h"
+#include "model/half_edge.h"
+#include "model/subdivision.h"
+
+namespace {
+
+/**
+ * @brief 一层细分的输入或输出
+ */
+struct Level {
+    std::vector<vec3> verts = {};
+    std::vector<std::uint32_t> tris = {};   // 每 3 个索引一个三角形
+    std::vector<char> refine = {};          // 每个面是否细分，为空表示全部细分
+};
+
+/**
+ * @brief 细分一层
+ *
+ * 被选中的面一分为四；与之共享被分割边的未选中面按被分割的边数分成 2 或 3 个三角形，
+ * 不产生 T 形接缝。选中面的顶点按 Loop 规则平滑，其余顶点不动。
+ *
+ * @param in
+ * @param out 选中面的子三角形在下一层继续被选中
+ * @param first_child 输出，面 f 的子三角形为 [first_child[f], first_child[f + 1])
+ */
+void subdivide_level(const Level& in, Level& out, std::vector<int>& first_child) {
+    const int nv = in.verts.size();
+    const int nf = in.tris.size() / 3;
+    const int nh = nf * 3;
+    const bool uniform = in.refine.empty();
+    const HalfEdgeMesh mesh(nv, in.tris);
+    auto refined = [&](const std::uint32_t f) { return uniform || in.refine[f]; };
+
+    // 被分割的边由其较小的半边（或边界半边）拥有，按半边顺序编号
+    std::vector<char> split(nh), owner(nh);
+    #pragma omp parallel for schedule(static)
+    for(int h = 0; h < nh; h ++) {
+        const std::uint32_t t = mesh.twin(h);
+        split[h] = refined(h / 3) || (t != HalfEdgeMesh::invalid && refined(mesh.face(t)));
+        owner[h] = split[h] && (t == HalfEdgeMesh::invalid || std::uint32_t(h) < t);
+    }
+    std::vector<std::uint32_t> edge_vert(nh, HalfEdgeMesh::invalid), edge_owner;
+    for(int h = 0; h < nh; h ++)
+        if(owner[h]) edge_owner.push_back(h);
+    const int ne = edge_owner.size();
+
+    std::vector<char> moved(nv, uniform);
+    if(!uniform) {
+        for(int f = 0; f < nf; f ++)
+            if(in.refine[f])
+                for(int k = 0; k < 3; k ++) moved[in.tris[f * 3 + k]] = 1;
+    }
+
+    out.verts.resize(nv + ne);
+    #pragma omp parallel for schedule(static)
+    for(int v = 0; v < nv; v ++) {
+        const vec3& p = in.verts[v];
+        if(!moved[v] || mesh.vertex_halfedge(v) == HalfEdgeMesh::invalid) {
+            out.verts[v] = p;
+            continue;
+        }
+        vec3 sum, first, last;
+        int n = 0;
+        mesh.for_each_neighbor(v, [&](const std::uint32_t u, const std::uint32_t h) {
+            if(n == 0) first = in.verts[u];
+            if(h == HalfEdgeMesh::invalid) last = in.verts[u];
+            sum = sum + in.verts[u];
+            n ++;
+        });
+        if(mesh.is_boundary_vertex(v)) {
+            out.verts[v] = p * .75 + (first + last) * .125;
+        } else {
+            const double beta = n == 3 ? 3. / 16 : 3. / (8 * n);
+            out.verts[v] = p * (1 - n * beta) + sum * beta;
+        }
+    }
+
+    #pragma omp parallel for schedule(static)
+    for(int e = 0; e < ne; e ++) {
+        const std::uint32_t h = edge_owner[e];
+        const std::uint32_t t = mesh.twin(h);
+        const vec3& a = in.verts[mesh.from(h)];
+        const vec3& b = in.verts[mesh.to(h)];
+        edge_vert[h] = nv + e;
+        if(t == HalfEdgeMesh::invalid) {
+            out.verts[nv + e] = (a + b) * .5;
+            continue;
+        }
+        edge_vert[t] = nv + e;
+        const vec3& c = in.verts[mesh.from(mesh.prev(h))];
+        const vec3& d = in.verts[mesh.from(mesh.prev(t))];
+        out.verts[nv + e] = (a + b) * .375 + (c + d) * .125;
+    }
+
+    // 按被分割边的掩码决定子三角形个数，前缀和给出每个面的写入位置
+    static constexpr int children[8] = {1, 2, 2, 3, 2, 3, 3, 4};
+    first_child.assign(nf + 1, 0);
+    for(int f = 0; f < nf; f ++)
+        first_child[f + 1] = first_child[f] + children[split[f * 3] | split[f * 3 + 1] << 1 | split[f * 3 + 2] << 2];
+    const int nchildren = first_child[nf];
+    out.tris.resize(std::size_t(nchildren) * 3);
+    out.refine.clear();
+    if(!uniform) out.refine.assign(nchildren, 0);
+
+    #pragma omp parallel for schedule(static)
+    for(int f = 0; f < nf; f ++) {
+        const std::uint32_t* v = &in.tris[f * 3];
+        const std::uint32_t m[3] = {edge_vert[f * 3], edge_vert[f * 3 + 1], edge_vert[f * 3 + 2]};
+        const int mask = split[f * 3] | split[f * 3 + 1] << 1 | split[f * 3 + 2] << 2;
+        std::uint32_t* o = &out.tris[std::size_t(first_child[f]) * 3];
+        auto emit = [&](const std::uint32_t a, const std::uint32_t b, const std::uint32_t c) {
+            o[0] = a;
+            o[1] = b;
+            o[2] = c;
+            o += 3;
+        };
+        if(mask == 0) {
+            emit(v[0], v[1], v[2]);
+        } else if(mask == 7) {
+            emit(v[0], m[0], m[2]);
+            emit(m[0], v[1], m[1]);
+            emit(m[2], m[1], v[2]);
+            emit(m[0], m[1], m[2]);
+            if(!uniform && in.refine[f]) std::fill(out.refine.begin() + first_child[f], out.refine.begin() + first_child[f] + 4, 1);
+        } else if(mask == 1 || mask == 2 || mask == 4) {
+            const int k = mask == 1 ? 0 : mask == 2 ? 1 : 2;
+            emit(v[k], m[k], v[(k + 2) % 3]);
+            emit(m[k], v[(k + 1) % 3], v[(k + 2) % 3]);
+        } else {
+            // 边 k 与 k + 1 被分割，边 k + 2 保留
+            const int k = mask == 3 ? 0 : mask == 6 ? 1 : 2;
+            const int k1 = (k + 1) % 3, k2 = (k + 2) % 3;
+            emit(m[k], v[k1], m[k1]);
+            emit(v[k], m[k], m[k1]);
+            emit(v[k], m[k1], v[k2]);
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * @brief 对全部面做 Loop 细分
+ *
+ * @param model
+ * @param levels 层数，每层面数变为 4 倍
+ * @return Model
+ */
+Model Subdivision::loop(const Model& model, const int levels) {
+    return loop_adaptive(model, {}, levels);
+}
+
+/**
+ * @brief 只细分选中的面
+ *
+ * 选中面的子三角形在后续各层继续被细分，周围的面只做消除接缝所需的分割。
+ *
+ * @param model
+ * @param refine 每个面是否细分，为空表示全部细分
+ * @param levels 层数
+ * @return Model
+ */
+Model Subdivision::loop_adaptive(const Model& model, const std::vector<char>& refine, const int levels) {
+    Level level;
+    level.verts = model.verts;
+    level.tris.assign(model.facet_vert.begin(), model.facet_vert.end());
+    level.refine = refine;
+    if(!refine.empty()) level.refine.resize(model.nfaces(), 0);
+    std::vector<Submesh> submeshes = model.submeshes;
+    std::vector<int> first_child;
+    for(int i = 0; i < levels; i ++) {
+        Level next;
+        subdivide_level(level, next, first_child);
+        for(Submesh& s : submeshes) {
+            const int end = first_child[s.first_face + s.nfaces];
+            s.first_face = first_child[s.first_face];
+            s.nfaces = end - s.first_face;
+        }
+        level = std::move(next);
+    }
+
+    Model out;
+    out.verts = std::move(level.verts);
+    out.facet_vert.assign(level.tris.begin(), level.tris.end());
+    out.facet_tex.assign(out.facet_vert.size(), -1);
+    out.materials = model.materials;
+    out.submeshes = std::move(submeshes);
+    out.generate_normals();
+    return out;
+}
+
+/**
+ * @brief 选出需要细分的面：轮廓边两侧的面，以及投影后某条边长于 max_edge_px 的面
+ *
+ * @param model
+ * @param to_screen 模型空间到屏幕的矩阵（含视口变换）
+ * @param view 透视时为模型空间的相机位置，正交时为模型空间中指向相机的方向
+ * @param perspective
+ * @param max_edge_px 屏幕上的最大边长（像素）
+ * @return std::vector<char> 每个面是否细分
+ */
+std::vector<char> Subdivision::select_faces(const Model& model, const mat<4,4>& to_screen, const vec3& view,
+                                            const bool perspective, const double max_edge_px) {
+    const int nv = model.nverts();
+    const int nf = model.nfaces();
+    std::vector<vec4> screen(nv);
+    #pragma omp parallel for schedule(static)
+    for(int i = 0; i < nv; i ++) {
+        const vec3 p = model.vert(i);
+        const vec4 clip = to_screen * vec4{p.x, p.y, p.z, 1};
+        screen[i] = clip.w > 1e-9 ? vec4{clip.x / clip.w, clip.y / clip.w, 0, 1} : vec4{0, 0, 0, 0};
+    }
+
+    std::vector<char> refine(nf, 0);
+    const double limit = max_edge_px * max_edge_px;
+    #pragma omp parallel for schedule(static)
+    for(int f = 0; f < nf; f ++) {
+        for(int k = 0; k < 3; k ++) {
+            const vec4& a = screen[model.facet(f, k)];
+            const vec4& b = screen[model.facet(f, (k + 1) % 3)];
+            if(a.w > 0 && b.w > 0 && (a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y) > limit) refine[f] = 1;
+        }
+    }
+
+    const EdgeAdjacency adjacency(model);
+    for(const int e : adjacency.feature_edges(model, view, perspective, 180)) {
+        const Edge& edge = adjacency.edge(e);
+        refine[edge.f0] = 1;
+        if(edge.f1 >= 0) refine[edge.f1] = 1;
+    }
+    return refine;
+}
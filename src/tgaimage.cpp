@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 #include <cstring>
 #include "tga/tgaimage.h"
@@ -255,6 +256,26 @@ void TGAImage::set(int x, int y, const TGAColor &c) {
     memcpy(data.data()+(x+y*w)*bpp, c.bgra, bpp);
 }
 
+/**
+ * @brief 用同一颜色填充矩形区域.
+ * @param x0 左边界（含）。
+ * @param y0 下边界（含）。
+ * @param x1 右边界（不含）。
+ * @param y1 上边界（不含）。
+ * @param c 填充颜色。
+ * @note 区域裁剪到图像范围内；先写好一行，其余行整行复制。
+ */
+void TGAImage::fill(int x0, int y0, int x1, int y1, const TGAColor &c) {
+    x0 = std::max(x0, 0); y0 = std::max(y0, 0);
+    x1 = std::min(x1, w); y1 = std::min(y1, h);
+    if (!data.size() || x0>=x1 || y0>=y1) return;
+    std::uint8_t *row = data.data()+(x0+y0*w)*bpp;
+    for (int i=0; i<x1-x0; i++)
+        memcpy(row+i*bpp, c.bgra, bpp);
+    for (int j=y0+1; j<y1; j++)
+        memcpy(data.data()+(x0+j*w)*bpp, row, (x1-x0)*bpp);
+}
+
 /**
  * @brief 水平翻转图像（左右镜像）。
  */
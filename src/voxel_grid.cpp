@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <utility>
+
+#include "model/voxel_grid.h"
+#include "util/parallel_sort.h"
+
+namespace {
+
+constexpr std::uint64_t empty_key = ~std::uint64_t(0);
+constexpr int coord_bias = 1 << 20;    // 块坐标加偏移后占 21 位
+
+/**
+ * @brief 块坐标打包为键
+ */
+std::uint64_t brick_key(const int bx, const int by, const int bz) {
+    return std::uint64_t(bx + coord_bias) << 42 | std::uint64_t(by + coord_bias) << 21 | std::uint64_t(bz + coord_bias);
+}
+
+/**
+ * @brief 向下取整的除法（体素坐标到块坐标）
+ */
+int floor_div(const int a, const int b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+/**
+ * @brief 64 位整数散列（splitmix64 的终结步骤）
+ */
+std::uint64_t mix(std::uint64_t k) {
+    k ^= k >> 30;
+    k *= 0xbf58476d1ce4e5b9ull;
+    k ^= k >> 27;
+    k *= 0x94d049bb133111ebull;
+    return k ^ (k >> 31);
+}
+
+/**
+ * @brief 三角形与轴对齐盒是否相交（Akenine-Möller 分离轴测试，接触算相交）
+ *
+ * @param c 盒中心
+ * @param h 盒的半边长
+ * @param a
+ * @param b
+ * @param d 三角形顶点
+ */
+bool triangle_box_overlap(const vec3& c, const vec3& h, const vec3& a, const vec3& b, const vec3& d) {
+    const vec3 v[3] = {a - c, b - c, d - c};
+    for(int i = 0; i < 3; i ++) {
+        if(std::min({v[0][i], v[1][i], v[2][i]}) > h[i] || std::max({v[0][i], v[1][i], v[2][i]}) < -h[i]) return false;
+    }
+    const vec3 e[3] = {v[1] - v[0], v[2] - v[1], v[0] - v[2]};
+    const vec3 n = cross(e[0], e[1]);
+    if(std::abs(n * v[0]) > h.x * std::abs(n.x) + h.y * std::abs(n.y) + h.z * std::abs(n.z)) return false;
+    const vec3 units[3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    for(const vec3& edge : e) {
+        for(const vec3& u : units) {
+            const vec3 axis = cross(u, edge);
+            const double p0 = axis * v[0], p1 = axis * v[1], p2 = axis * v[2];
+            const double r = h.x * std::abs(axis.x) + h.y * std::abs(axis.y) + h.z * std::abs(axis.z);
+            if(std::min({p0, p1, p2}) > r || std::max({p0, p1, p2}) < -r) return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+/**
+ * @brief 体素化模型
+ *
+ * voxel_size 须为正的有限值，网格须落在块坐标 [-2^20, 2^20) 内，否则输出原因并得到空网格。
+ *
+ * @param model
+ * @param voxel_size 体素边长（模型空间）
+ * @param origin 体素 (0, 0, 0) 的最小角
+ */
+VoxelGrid::VoxelGrid(const Model& model, const double voxel_size, const vec3 origin) : size(voxel_size), base(origin) {
+    const int nf = model.nfaces();
+    const int bs = brick_size;
+    if(!(voxel_size > 0) || !std::isfinite(voxel_size)) {
+        std::cerr << "bad voxel size " << voxel_size << "\n";
+        size = 1;
+        return;
+    }
+    // 块坐标打包为 21 位，超出范围的体素坐标会与别的块冲突
+    const double limit = double(coord_bias) * bs;
+    for(int v = 0; v < model.nverts(); v ++) {
+        const vec3 p = model.vert(v);
+        for(int i = 0; i < 3; i ++) {
+            const double c = std::floor((p[i] - base[i]) / size);
+            if(!(c >= -limit && c < limit)) {
+                std::cerr << "mesh is out of voxel grid range at voxel size " << voxel_size << "\n";
+                return;
+            }
+        }
+    }
+
+    // 对三角形包围盒内的体素做分离轴测试，对相交的体素调用 hit(块坐标, 块内位号)；两遍用同一个测试
+    const vec3 half = vec3{1, 1, 1} * (size / 2);
+    auto for_each_voxel = [&](const int f, auto&& hit) {
+        const vec3 a = model.vert(f, 0), b = model.vert(f, 1), c = model.vert(f, 2);
+        int lo[3], hi[3];
+        for(int i = 0; i < 3; i ++) {
+            lo[i] = std::floor((std::min({a[i], b[i], c[i]}) - base[i]) / size);
+            hi[i] = std::floor((std::max({a[i], b[i], c[i]}) - base[i]) / size);
+        }
+        for(int z = lo[2]; z <= hi[2]; z ++) {
+            for(int y = lo[1]; y <= hi[1]; y ++) {
+                for(int x = lo[0]; x <= hi[0]; x ++) {
+                    if(!triangle_box_overlap(base + vec3{x + .5, y + .5, z + .5} * size, half, a, b, c)) continue;
+                    const int bx = floor_div(x, bs), by = floor_div(y, bs), bz = floor_div(z, bs);
+                    hit(brick_key(bx, by, bz), ((z - bz * bs) * bs + (y - by * bs)) * bs + (x - bx * bs));
+                }
+            }
+        }
+    };
+
+    // 第一遍：只收集命中的块键，每个线程就地去重，内存与每线程的非空块数成正比
+    std::vector<std::vector<std::uint64_t>> found;
+    #pragma omp parallel
+    {
+        std::vector<std::uint64_t> own;
+        std::size_t compact_at = 4096;
+        auto compact = [&] {
+            std::sort(own.begin(), own.end());
+            own.erase(std::unique(own.begin(), own.end()), own.end());
+        };
+        #pragma omp for schedule(dynamic, 256) nowait
+        for(int f = 0; f < nf; f ++) {
+            for_each_voxel(f, [&](const std::uint64_t key, int) {
+                if(own.empty() || own.back() != key) own.push_back(key);
+            });
+            if(own.size() >= compact_at) {
+                compact();
+                compact_at = std::max<std::size_t>(4096, own.size() * 2);
+            }
+        }
+        compact();
+        #pragma omp critical
+        found.push_back(std::move(own));
+    }
+    for(const auto& own : found) keys.insert(keys.end(), own.begin(), own.end());
+    found.clear();
+    parallel_sort(keys, [](const std::uint64_t l, const std::uint64_t r) { return l < r; });
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    const int nb = keys.size();
+    std::size_t capacity = 16;
+    while(capacity < std::size_t(nb) * 2) capacity *= 2;
+    table_keys.assign(capacity, empty_key);
+    table_bricks.assign(capacity, -1);
+    for(int i = 0; i < nb; i ++) {
+        std::size_t slot = mix(keys[i]) & (capacity - 1);
+        while(table_keys[slot] != empty_key) slot = (slot + 1) & (capacity - 1);
+        table_keys[slot] = keys[i];
+        table_bricks[slot] = i;
+    }
+
+    // 第二遍：重做同样的测试，命中的块必在表中；哈希表只读，位掩码直接用原子或写入
+    bits.assign(std::size_t(nb) * bs, 0);
+    std::uint64_t* words = bits.data();
+    #pragma omp parallel for schedule(dynamic, 256)
+    for(int f = 0; f < nf; f ++) {
+        for_each_voxel(f, [&](const std::uint64_t key, const int local) {
+            std::uint64_t& word = words[std::size_t(find(key)) * bs + local / (bs * bs)];
+            const std::uint64_t bit = std::uint64_t(1) << (local % (bs * bs));
+            #pragma omp atomic
+            word |= bit;
+        });
+    }
+}
+
+/**
+ * @brief 体素边长
+ */
+double VoxelGrid::voxel_size() const { return size; }
+
+/**
+ * @brief 体素 (0, 0, 0) 的最小角
+ */
+const vec3& VoxelGrid::origin() const { return base; }
+
+/**
+ * @brief 非空块数
+ */
+int VoxelGrid::nbricks() const { return keys.size(); }
+
+/**
+ * @brief 被置位的体素数
+ */
+long long VoxelGrid::count() const {
+    long long n = 0;
+    #pragma omp parallel for schedule(static) reduction(+:n)
+    for(long long i = 0; i < (long long)bits.size(); i ++) {
+        for(std::uint64_t w = bits[i]; w; w &= w - 1) n ++;
+    }
+    return n;
+}
+
+/**
+ * @brief 体素是否被置位
+ */
+bool VoxelGrid::occupied(const int x, const int y, const int z) const {
+    const int bs = brick_size;
+    const int bx = floor_div(x, bs), by = floor_div(y, bs), bz = floor_div(z, bs);
+    const int brick = find(brick_key(bx, by, bz));
+    if(brick < 0) return false;
+    return bits[std::size_t(brick) * bs + (z - bz * bs)] >> ((y - by * bs) * bs + (x - bx * bs)) & 1;
+}
+
+/**
+ * @brief 体素中心
+ */
+vec3 VoxelGrid::center(const int x, const int y, const int z) const {
+    return base + vec3{x + .5, y + .5, z + .5} * size;
+}
+
+/**
+ * @brief 查找块下标，不存在时返回 -1
+ */
+int VoxelGrid::find(const std::uint64_t key) const {
+    if(table_keys.empty()) return -1;
+    const std::size_t mask = table_keys.size() - 1;
+    for(std::size_t slot = mix(key) & mask; ; slot = (slot + 1) & mask) {
+        if(table_keys[slot] == key) return table_bricks[slot];
+        if(table_keys[slot] == empty_key) return -1;
+    }
+}
@@ -0,0 +1,159 @@
+/**
+ * @file tests/test_asset_store.cpp
+ * @brief tiny-renderer 的资源仓库与文件监视自测
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include "io/asset_store.h"
+
+namespace {
+
+/// @brief 测试失败计数
+int g_failures = 0;
+
+/**
+ * @brief 失败时记录并输出（不中断后续测试）
+ *
+ * @param ok
+ * @param expr
+ * @param file
+ * @param line
+ */
+inline void check(bool ok, const char* expr, const char* file, int line) {
+    if (ok) return;
+    ++g_failures;
+    std::cerr << file << ":" << line << ": FAIL: " << expr << "\n";
+}
+
+#define CHECK(...) ::check((__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
+
+/**
+ * @brief 测试模型经缓存加载、文件变化后只重新加载受影响的资源
+ */
+void test_reload_on_change() {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "tiny_renderer_assets";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    const std::string a = (dir / "a.obj").string();
+    const std::string b = (dir / "b.obj").string();
+    std::ofstream(a) << "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+    std::ofstream(b) << "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+
+    AssetStore store((dir / "cache").string());
+    const auto ma = store.model(a);
+    const auto mb = store.model(b);
+    CHECK(ma->nfaces() == 1 && mb->nfaces() == 1);
+    CHECK(std::filesystem::exists(store.cache_path(a)));
+    CHECK(store.model(a) == ma);            // 同一路径只加载一次
+    CHECK(store.refresh().empty());
+
+    // 改写 a：只有 a 被重新加载，旧的 shared_ptr 内容不变
+    std::ofstream(a) << "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nf 1 2 4 3\n";
+    const auto reloaded = store.refresh(1000);
+    CHECK(reloaded.size() == 1);
+    CHECK(store.model(a)->nfaces() == 2);
+    CHECK(ma->nfaces() == 1);
+    CHECK(store.model(b) == mb);
+
+    // 新的仓库直接读取重写过的缓存
+    AssetStore fresh((dir / "cache").string());
+    CHECK(fresh.model(a)->nfaces() == 2);
+}
+
+/**
+ * @brief 测试加载失败不被缓存、重新加载失败时保留旧纹理
+ */
+void test_failed_loads() {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "tiny_renderer_assets_failed";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    const std::string mesh = (dir / "late.obj").string();
+    const std::string tex = (dir / "skin.tga").string();
+    AssetStore store((dir / "cache").string());
+
+    // 文件还不存在：返回空资源，文件出现后再次访问即可加载
+    CHECK(store.model(mesh)->nverts() == 0);
+    CHECK(store.texture(tex)->width() == 0);
+    std::ofstream(mesh) << "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+    CHECK(TGAImage(4, 4, TGAImage::RGB).write_tga_file(tex, true, false));
+    CHECK(store.model(mesh)->nfaces() == 1);
+    CHECK(store.texture(tex)->width() == 4);
+    store.refresh(100);
+    const auto image = store.texture(tex);
+
+    // 纹理被截断：重新加载失败，仓库仍给出旧纹理
+    std::ifstream in(tex, std::ios::binary);
+    const std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::ofstream(tex, std::ios::binary) << bytes.substr(0, bytes.size() / 2);
+    CHECK(store.refresh(1000).empty());
+    CHECK(store.texture(tex) == image);
+}
+
+/**
+ * @brief 测试模型依赖：MTL 文件或贴图变化时重新加载模型，缓存比 MTL 文件旧时不再使用
+ */
+void test_material_dependencies() {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "tiny_renderer_assets_mtl";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    const std::string mesh = (dir / "tri.obj").string();
+    const std::string mtl = (dir / "tri.mtl").string();
+    const std::string tex = (dir / "tri.tga").string();
+    std::ofstream(mesh) << "mtllib tri.mtl\nv 0 0 0\nv 1 0 0\nv 0 1 0\nusemtl paint\nf 1 2 3\n";
+    std::ofstream(mtl) << "newmtl paint\nKd 1 0 0\nmap_Kd tri.tga\n";
+    CHECK(TGAImage(2, 2, TGAImage::RGB).write_tga_file(tex, true, false));
+    auto diffuse = [](const std::shared_ptr<const Model>& m) { return m->nmaterials() == 1 ? m->material(0).diffuse : vec3{-1, -1, -1}; };
+
+    AssetStore store((dir / "cache").string());
+    const auto first = store.model(mesh);
+    CHECK(diffuse(first).x == 1 && diffuse(first).y == 0);
+    store.refresh(100);
+
+    // 改写 MTL：模型重新加载，颜色更新
+    std::ofstream(mtl) << "newmtl paint\nKd 0 1 0\nmap_Kd tri.tga\n";
+    std::vector<std::string> reloaded = store.refresh(1000);
+    CHECK(reloaded.size() == 1);
+    CHECK(diffuse(store.model(mesh)).y == 1);
+    CHECK(diffuse(first).x == 1);
+
+    // 改写贴图：引用它的模型同样重新加载
+    const auto before = store.model(mesh);
+    CHECK(TGAImage(4, 4, TGAImage::RGB).write_tga_file(tex, true, false));
+    reloaded = store.refresh(1000);
+    CHECK(reloaded.size() == 1);
+    CHECK(store.model(mesh) != before);
+
+    // 新仓库：缓存不旧于依赖时读缓存；MTL 比缓存新时重新解析
+    CHECK(diffuse(AssetStore((dir / "cache").string()).model(mesh)).y == 1);
+    std::ofstream(mtl) << "newmtl paint\nKd 0 0 1\n";
+    std::filesystem::last_write_time(mtl, std::filesystem::last_write_time(store.cache_path(mesh)) + std::chrono::seconds(2));
+    CHECK(diffuse(AssetStore((dir / "cache").string()).model(mesh)).z == 1);
+}
+
+} // namespace
+
+/**
+ * @brief 自测入口
+ *
+ * @return 0 表示通过
+ */
+int main() {
+    test_reload_on_change();
+    test_failed_loads();
+    test_material_dependencies();
+
+    if (g_failures == 0) {
+        std::cout << "test_asset_store: all tests passed\n";
+        return 0;
+    }
+
+    std::cerr << "test_asset_store: failed cases = " << g_failures << "\n";
+    return 1;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file tests/test_json.cpp
+ * @brief tiny-renderer 的 JSON 解析自测
+ */
+
+#include <iostream>
+#include <string>
+
+#include "json/json.h"
+
+namespace {
+
+/// @brief 测试失败计数
+int g_failures = 0;
+
+/**
+ * @brief 失败时记录并输出（不中断后续测试）
+ *
+ * @param ok
+ * @param expr
+ * @param file
+ * @param line
+ */
+inline void check(bool ok, const char* expr, const char* file, int line) {
+    if (ok) return;
+    ++g_failures;
+    std::cerr << file << ":" << line << ": FAIL: " << expr << "\n";
+}
+
+#define CHECK(...) ::check((__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
+
+/**
+ * @brief 解析字符串形式的 JSON
+ */
+bool parse(const std::string& text, JsonValue& out) {
+    return parse_json(text.data(), text.data() + text.size(), out);
+}
+
+/**
+ * @brief 测试对象/数组/标量与链式取值
+ */
+void test_parse_document() {
+    JsonValue doc;
+    CHECK(parse(R"({"a": [1, -2.5e1, true, null], "b": {"c": "x\"yé"}, "d": false})", doc));
+    CHECK(doc.type == JsonValue::OBJECT && doc.size() == 3);
+    CHECK(doc["a"].size() == 4);
+    CHECK(doc["a"][0].integer() == 1);
+    CHECK(doc["a"][1].number() == -25.0);
+    CHECK(doc["a"][2].boolean);
+    CHECK(doc["a"][3].is_null());
+    CHECK(doc["b"]["c"].str() == "x\"y\xc3\xa9");
+    CHECK(doc.has("d") && !doc["d"].boolean);
+
+    // 缺失值返回 null，并可继续链式取值
+    CHECK(doc["missing"][3]["deeper"].is_null());
+    CHECK(doc["missing"].number(7) == 7);
+
+    // 超出 int 范围的数值取整时返回默认值
+    CHECK(parse("[1e10, -1e10, 1e400, 2147483647, -2147483648, 3.75]", doc));
+    CHECK(doc[0].integer(-1) == -1 && doc[1].integer(-1) == -1 && doc[2].integer(-1) == -1);
+    CHECK(doc[3].integer() == 2147483647 && doc[4].integer() == -2147483647 - 1);
+    CHECK(doc[5].integer() == 3);
+
+    // 代理对组成一个补充平面码点
+    CHECK(parse(R"(["\ud83d\ude00"])", doc));
+    CHECK(doc[0].str() == "\xf0\x9f\x98\x80");
+}
+
+/**
+ * @brief 测试非法输入
+ */
+void test_parse_errors() {
+    JsonValue doc;
+    CHECK(!parse("{\"a\": }", doc));
+    CHECK(!parse("[1, 2", doc));
+    CHECK(!parse("\"unterminated", doc));
+    CHECK(!parse("{} trailing", doc));
+    CHECK(!parse("tru", doc));
+    CHECK(!parse(R"(["\ud83d"])", doc));          // 单独的高代理
+    CHECK(!parse(R"(["\ud83dx"])", doc));
+    CHECK(!parse(R"(["\ud83d\u0041"])", doc));    // 高代理后不是低代理
+    CHECK(!parse(R"(["\ud83d\ud83d"])", doc));
+    CHECK(!parse(R"(["\ude00"])", doc));          // 单独的低代理
+}
+
+} // namespace
+
+/**
+ * @brief 自测入口
+ *
+ * @return 0 表示通过
+ */
+int main() {
+    test_parse_document();
+    test_parse_errors();
+
+    if (g_failures == 0) {
+        std::cout << "test_json: all tests passed\n";
+        return 0;
+    }
+
+    std::cerr << "test_json: failed cases = " << g_failures << "\n";
+    return 1;
+}
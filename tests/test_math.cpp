@@ -9,6 +9,7 @@
 #include <string>
 
 #include "math/geometry.h"
+#include "math/quantize.h"
 
 namespace {
 
@@ -229,6 +230,38 @@ void test_inverse() {
     CHECK(mat_nearly_equal<3, 3>(inv3 * A3, identity<3>(), eps));
 }
 
+/**
+ * @brief 测试半精度转换：常见值精确往返，舍入与溢出
+ */
+void test_half_float() {
+    for (const float v : {0.0f, -0.0f, 1.0f, -2.5f, 0.5f, 65504.0f, 6.103515625e-05f, 5.9604645e-08f}) {
+        CHECK(half_to_float(float_to_half(v)) == v);
+    }
+    CHECK(float_to_half(1.0f) == 0x3C00);
+    CHECK(float_to_half(1e6f) == 0x7C00);                      // 溢出为无穷
+    CHECK(float_to_half(1.0f + 1.0f / 4096) == 0x3C00);       // 正好一半，舍入到偶数
+    CHECK_NEAR(half_to_float(float_to_half(0.1f)), 0.1, 1e-3);
+}
+
+/**
+ * @brief 测试八面体编码：两个半球上的往返误差
+ */
+void test_oct_encoding() {
+    const vec3 dirs[] = {
+        {0, 0, 1}, {0, 0, -1}, {1, 0, 0}, {0, -1, 0},
+        normalized(vec3{1, 2, 3}), normalized(vec3{-3, 1, -2}), normalized(vec3{0.2, -0.7, -0.1}),
+    };
+    for (const vec3& d : dirs) {
+        const vec2 e = oct_encode(d);
+        const vec3 exact = oct_decode(e);
+        CHECK(vec_nearly_equal<3>(exact, d, 1e-12));
+
+        // 经过 snorm16 量化后的误差
+        const vec3 q = oct_decode({from_snorm16(to_snorm16(e.x)), from_snorm16(to_snorm16(e.y))});
+        CHECK_NEAR(q * d, 1.0, 1e-8);
+    }
+}
+
 } // namespace
 
 /**
@@ -243,6 +276,8 @@ int main() {
     test_matrix_multiply_and_transpose();
     test_determinant();
     test_inverse();
+    test_half_float();
+    test_oct_encoding();
 
     if (g_failures == 0) {
         std::cout << "test_math: all tests passed\n";
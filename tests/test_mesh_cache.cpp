@@ -0,0 +1,209 @@
+/**
+ * @file tests/test_mesh_cache.cpp
+ * @brief tiny-renderer 的索引压缩与二进制网格缓存自测
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "model/index_codec.h"
+#include "model/model.h"
+
+namespace {
+
+/// @brief 测试失败计数
+int g_failures = 0;
+
+/**
+ * @brief 失败时记录并输出（不中断后续测试）
+ *
+ * @param ok
+ * @param expr
+ * @param file
+ * @param line
+ */
+inline void check(bool ok, const char* expr, const char* file, int line) {
+    if (ok) return;
+    ++g_failures;
+    std::cerr << file << ":" << line << ": FAIL: " << expr << "\n";
+}
+
+#define CHECK(...) ::check((__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
+
+/**
+ * @brief 临时目录下的文件路径
+ */
+std::string temp_path(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / ("tiny_renderer_" + name)).string();
+}
+
+/**
+ * @brief n x n 网格的索引缓冲，按行生成（条带相邻）
+ */
+std::vector<int> grid_indices(const int n) {
+    std::vector<int> idx;
+    for (int y = 0; y < n; ++y) {
+        for (int x = 0; x < n; ++x) {
+            const int a = y * (n + 1) + x, b = a + 1, c = a + n + 1, d = c + 1;
+            idx.insert(idx.end(), {a, b, d, a, d, c});
+        }
+    }
+    return idx;
+}
+
+/**
+ * @brief 测试 Stream VByte 往返，含各字节长度与非 4 倍数的长度
+ */
+void test_streamvbyte_roundtrip() {
+    const std::vector<std::uint32_t> values = {0, 1, 255, 256, 65535, 65536, 16777215, 16777216, 0xFFFFFFFFu};
+    std::vector<std::uint32_t> decoded;
+    std::size_t used = 0;
+    const std::vector<std::uint8_t> enc = streamvbyte_encode(values);
+    CHECK(streamvbyte_decode(enc.data(), enc.size(), decoded, &used));
+    CHECK(decoded == values);
+    CHECK(used == enc.size());
+    CHECK(!streamvbyte_decode(enc.data(), enc.size() - 1, decoded));
+}
+
+/**
+ * @brief 测试 SIMD 与标量解码结果一致（CPU 不支持 SSSE3 时两者都是标量）
+ */
+void test_streamvbyte_simd() {
+    std::mt19937 rng(11);
+    std::vector<std::uint32_t> values(10001);
+    for (std::uint32_t& v : values) v = rng() >> (rng() % 32);
+    const std::vector<std::uint8_t> enc = streamvbyte_encode(values);
+    std::vector<std::uint32_t> simd, scalar;
+    CHECK(streamvbyte_decode(enc.data(), enc.size(), simd, nullptr, true));
+    CHECK(streamvbyte_decode(enc.data(), enc.size(), scalar, nullptr, false));
+    CHECK(simd == values && scalar == values);
+    CHECK(!streamvbyte_decode(enc.data(), enc.size() - 1, simd, nullptr, true));
+    std::cout << "streamvbyte simd: " << (streamvbyte_simd_available() ? "ssse3" : "scalar") << "\n";
+}
+
+/**
+ * @brief 测试索引编码：条带网格的压缩率，随机索引与负索引的往返
+ */
+void test_index_codec() {
+    const std::vector<int> grid = grid_indices(64);
+    const std::vector<std::uint8_t> enc = encode_indices(grid);
+    std::vector<int> decoded;
+    CHECK(decode_indices(enc.data(), enc.size(), decoded));
+    CHECK(decoded == grid);
+    CHECK(enc.size() * 3 <= grid.size() * sizeof(int));
+
+    std::mt19937 rng(7);
+    std::vector<int> random(3000);
+    for (int& i : random) i = int(rng() % 100000) - 1;
+    const std::vector<std::uint8_t> renc = encode_indices(random);
+    CHECK(decode_indices(renc.data(), renc.size(), decoded));
+    CHECK(decoded == random);
+
+    CHECK(!decode_indices(renc.data(), renc.size() / 2, decoded));
+}
+
+/**
+ * @brief 测试 .tmc 缓存往返：顶点、索引、蒙皮权重、形变目标、材质与子网格完全一致
+ */
+void test_cache_roundtrip() {
+    std::ofstream(temp_path("cache.mtl")) << "newmtl gold\nKd 1 0.8 0.2\nmap_Kd gold.tga\n";
+    std::ofstream(temp_path("cache.obj")) <<
+        "mtllib tiny_renderer_cache.mtl\n"
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 0 0 1\n"
+        "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+        "g base\nusemtl gold\nf 1/1 2/2 3/3 4/4\n"
+        "g tip\nf 1 2 5\n";
+    Model model(temp_path("cache.obj"));
+    std::vector<int> joints(model.nverts() * 4);
+    std::vector<vec4> weights(model.nverts());
+    for (int i = 0; i < model.nverts(); ++i) {
+        joints[i * 4] = i;
+        joints[i * 4 + 1] = i + 1;
+        weights[i] = {.75, .25, 0, 0};
+    }
+    CHECK(model.set_skin(joints, weights));
+    CHECK(model.add_morph_target({"smile", {1, 3}, {{0, .5, 0}, {-.25, 0, 1}}}));
+    CHECK(model.write_cache(temp_path("cache.tmc")));
+    const Model cached(temp_path("cache.tmc"));
+
+    CHECK(cached.nverts() == model.nverts());
+    CHECK(cached.nfaces() == model.nfaces());
+    for (int f = 0; f < model.nfaces() && f < cached.nfaces(); ++f) {
+        for (int k = 0; k < 3; ++k) {
+            const vec3 a = model.vert(f, k), b = cached.vert(f, k);
+            const vec3 na = model.normal(f, k), nb = cached.normal(f, k);
+            const vec4 ta = model.tangent(f, k), tb = cached.tangent(f, k);
+            const vec2 ua = model.uv(f, k), ub = cached.uv(f, k);
+            CHECK(a.x == b.x && a.y == b.y && a.z == b.z);
+            CHECK(na.x == nb.x && na.y == nb.y && na.z == nb.z);
+            CHECK(ta.x == tb.x && ta.w == tb.w);
+            CHECK(ua.x == ub.x && ua.y == ub.y);
+        }
+    }
+    CHECK(cached.has_skin());
+    for (int i = 0; cached.has_skin() && i < model.nverts(); ++i) {
+        for (int k = 0; k < 4; ++k) CHECK(cached.joint(i, k) == model.joint(i, k));
+        CHECK(cached.weights(i).x == .75 && cached.weights(i).y == .25);
+    }
+    CHECK(cached.nmorph_targets() == 1);
+    if (cached.nmorph_targets() == 1) {
+        const MorphTarget& t = cached.morph_target(0);
+        CHECK(t.name == "smile" && t.indices == model.morph_target(0).indices);
+        CHECK(t.deltas.size() == 2 && t.deltas[1].x == -.25 && t.deltas[1].z == 1);
+    }
+    CHECK(cached.nmaterials() == 1 && cached.nsubmeshes() == model.nsubmeshes());
+    if (cached.nmaterials() == 1) {
+        CHECK(cached.material(0).name == "gold");
+        CHECK(cached.material(0).diffuse_map == model.material(0).diffuse_map);
+    }
+    for (int i = 0; i < cached.nsubmeshes() && i < model.nsubmeshes(); ++i) {
+        CHECK(cached.submesh(i).name == model.submesh(i).name);
+        CHECK(cached.submesh(i).first_face == model.submesh(i).first_face);
+        CHECK(cached.submesh(i).nfaces == model.submesh(i).nfaces);
+    }
+
+    // 截断的缓存读取失败，模型为空
+    std::ifstream in(temp_path("cache.tmc"), std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::ofstream(temp_path("truncated.tmc"), std::ios::binary) << bytes.substr(0, bytes.size() / 2);
+    const Model broken(temp_path("truncated.tmc"));
+    CHECK(broken.nverts() == 0 && broken.nfaces() == 0);
+
+    // 文件以最后一个子网格的材质、首面、面数结尾；越界的面数或材质编号读取失败
+    for (const std::size_t back : {4u, 12u}) {
+        std::string bad = bytes;
+        const std::uint32_t huge = 1000;
+        std::memcpy(&bad[bad.size() - back], &huge, 4);
+        std::ofstream(temp_path("bad_submesh.tmc"), std::ios::binary) << bad;
+        const Model rejected(temp_path("bad_submesh.tmc"));
+        CHECK(rejected.nverts() == 0 && rejected.nsubmeshes() == 0);
+    }
+}
+
+} // namespace
+
+/**
+ * @brief 自测入口
+ *
+ * @return 0 表示通过
+ */
+int main() {
+    test_streamvbyte_roundtrip();
+    test_streamvbyte_simd();
+    test_index_codec();
+    test_cache_roundtrip();
+
+    if (g_failures == 0) {
+        std::cout << "test_mesh_cache: all tests passed\n";
+        return 0;
+    }
+
+    std::cerr << "test_mesh_cache: failed cases = " << g_failures << "\n";
+    return 1;
+}
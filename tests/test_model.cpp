@@ -0,0 +1,766 @@
+/**
+ * @file tests/test_model.cpp
+ * @brief tiny-renderer 的模型加载与几何处理自测
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "model/edge_adjacency.h"
+#include "model/glb.h"
+#include "model/half_edge.h"
+#include "model/model.h"
+#include "model/morph.h"
+#include "model/quantized_model.h"
+#include "model/skinning.h"
+#include "model/subdivision.h"
+#include "model/voxel_grid.h"
+
+namespace {
+
+/**
+ * @brief 浮点近似比较
+ *
+ * @param a
+ * @param b
+ * @param eps
+ * @return true
+ */
+inline bool nearly_equal(double a, double b, double eps) {
+    const double diff = std::fabs(a - b);
+    const double scale = 1.0 + std::max(std::fabs(a), std::fabs(b));
+    return diff <= eps * scale;
+}
+
+/// @brief 测试失败计数
+int g_failures = 0;
+
+/**
+ * @brief 失败时记录并输出（不中断后续测试）
+ *
+ * @param ok
+ * @param expr
+ * @param file
+ * @param line
+ * @param msg
+ */
+inline void check(bool ok, const char* expr, const char* file, int line, const std::string& msg = {}) {
+    if (ok) return;
+    ++g_failures;
+    std::cerr << file << ":" << line << ": FAIL: " << expr;
+    if (!msg.empty()) std::cerr << " | " << msg;
+    std::cerr << "\n";
+}
+
+#define CHECK(...) ::check((__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
+
+/**
+ * @brief vec 逐分量近似比较
+ *
+ * @tparam n
+ * @param a
+ * @param b
+ * @param eps
+ * @return true
+ */
+template<int n>
+inline bool vec_nearly_equal(const vec<n>& a, const vec<n>& b, double eps) {
+    for (int i = 0; i < n; ++i) {
+        if (!nearly_equal(a[i], b[i], eps)) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 将文本写入临时目录下的文件
+ *
+ * @param name 文件名
+ * @param content 文件内容
+ * @return std::string 文件完整路径
+ */
+std::string write_temp(const std::string& name, const std::string& content) {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / ("tiny_renderer_" + name);
+    std::ofstream out(path);
+    out << content;
+    return path.string();
+}
+
+/// @brief 单位立方体，12 个三角形，不含法线
+const char* const cube_obj =
+    "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+    "v 0 0 1\nv 1 0 1\nv 1 1 1\nv 0 1 1\n"
+    "vt 0 0\n"
+    "f 1/1/1 3/1/1 2/1/1\nf 1/1/1 4/1/1 3/1/1\n"
+    "f 5/1/1 6/1/1 7/1/1\nf 5/1/1 7/1/1 8/1/1\n"
+    "f 1/1/1 2/1/1 6/1/1\nf 1/1/1 6/1/1 5/1/1\n"
+    "f 2/1/1 3/1/1 7/1/1\nf 2/1/1 7/1/1 6/1/1\n"
+    "f 3/1/1 4/1/1 8/1/1\nf 3/1/1 8/1/1 7/1/1\n"
+    "f 4/1/1 1/1/1 5/1/1\nf 4/1/1 5/1/1 8/1/1\n";
+
+/**
+ * @brief 测试平滑法线：立方体角点按角度加权后指向对角线方向
+ */
+void test_generated_normals() {
+    Model model(write_temp("cube.obj", cube_obj));
+    CHECK(model.nverts() == 8);
+    CHECK(model.nfaces() == 12);
+
+    const double s = 1.0 / std::sqrt(3.0);
+    for (int f = 0; f < model.nfaces(); ++f) {
+        for (int k = 0; k < 3; ++k) {
+            const vec3 p = model.vert(f, k);
+            const vec3 expect = {p.x > .5 ? s : -s, p.y > .5 ? s : -s, p.z > .5 ? s : -s};
+            CHECK(vec_nearly_equal<3>(model.normal(f, k), expect, 1e-9));
+        }
+    }
+}
+
+/**
+ * @brief 测试切线：平面四边形的切线沿 +u 方向，副切线沿 +v 方向
+ */
+void test_generated_tangents() {
+    const char* const quad_obj =
+        "v 0 0 0\nv 2 0 0\nv 2 1 0\nv 0 1 0\n"
+        "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+        "vn 0 0 1\n"
+        "f 1/1/1 2/2/1 3/3/1\nf 1/1/1 3/3/1 4/4/1\n";
+    Model model(write_temp("quad.obj", quad_obj));
+    CHECK(model.nfaces() == 2);
+    for (int f = 0; f < model.nfaces(); ++f) {
+        for (int k = 0; k < 3; ++k) {
+            CHECK(vec_nearly_equal<3>(model.normal(f, k), vec3{0, 0, 1}, 1e-12));
+            CHECK(vec_nearly_equal<4>(model.tangent(f, k), vec4{1, 0, 0, 1}, 1e-12));
+        }
+    }
+
+    // 镜像 UV：副切线方向翻转
+    const char* const mirrored_obj =
+        "v 0 0 0\nv 2 0 0\nv 2 1 0\nv 0 1 0\n"
+        "vt 0 1\nvt 1 1\nvt 1 0\nvt 0 0\n"
+        "vn 0 0 1\n"
+        "f 1/1/1 2/2/1 3/3/1\nf 1/1/1 3/3/1 4/4/1\n";
+    Model mirrored(write_temp("mirrored.obj", mirrored_obj));
+    CHECK(vec_nearly_equal<4>(mirrored.tangent(0, 0), vec4{1, 0, 0, -1}, 1e-12));
+
+    // 共享法线与纹理坐标、右半边 u 镜像：接缝上的面顶点按 UV 朝向各自独立，不互相平均
+    const char* const seam_obj =
+        "v 0 0 0\nv 1 0 0\nv 2 0 0\nv 0 1 0\nv 1 1 0\nv 2 1 0\n"
+        "vt 0 0\nvt 1 0\nvt 0 1\nvt 1 1\n"
+        "vn 0 0 1\n"
+        "f 1/1/1 2/2/1 5/4/1\nf 1/1/1 5/4/1 4/3/1\n"
+        "f 2/2/1 3/1/1 6/3/1\nf 2/2/1 6/3/1 5/4/1\n";
+    Model seam(write_temp("seam.obj", seam_obj));
+    CHECK(seam.nfaces() == 4);
+    for (int f = 0; f < seam.nfaces(); ++f) {
+        const vec4 expect = f < 2 ? vec4{1, 0, 0, 1} : vec4{-1, 0, 0, -1};
+        for (int k = 0; k < 3; ++k) CHECK(vec_nearly_equal<4>(seam.tangent(f, k), expect, 1e-12));
+    }
+}
+
+/**
+ * @brief 测试多边形面三角化：四边形扇形剖分，凹多边形耳切
+ */
+void test_polygon_triangulation() {
+    // 四边形，使用 v 和负索引写法
+    Model quad(write_temp("ngon_quad.obj", "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf -4 -3 -2 -1\n"));
+    CHECK(quad.nfaces() == 2);
+
+    // L 形凹六边形（面积 3），使用 v//n 写法
+    const char* const l_obj =
+        "v 0 0 0\nv 2 0 0\nv 2 1 0\nv 1 1 0\nv 1 2 0\nv 0 2 0\n"
+        "vn 0 0 1\n"
+        "f 1//1 2//1 3//1 4//1 5//1 6//1\n";
+    Model l_shape(write_temp("ngon_l.obj", l_obj));
+    CHECK(l_shape.nfaces() == 4);
+    double area = 0;
+    bool ccw = true;
+    for (int f = 0; f < l_shape.nfaces(); ++f) {
+        const vec3 n = cross(l_shape.vert(f, 1) - l_shape.vert(f, 0), l_shape.vert(f, 2) - l_shape.vert(f, 0));
+        ccw = ccw && n.z > 0;
+        area += n.z / 2;
+        CHECK(vec_nearly_equal<3>(l_shape.normal(f, 0), vec3{0, 0, 1}, 1e-12));
+    }
+    CHECK(ccw);
+    CHECK(nearly_equal(area, 3.0, 1e-12));
+}
+
+/**
+ * @brief 测试 o/g/usemtl 分组与 MTL 解析：子网格按材质连续排列
+ */
+void test_material_groups() {
+    write_temp("groups.mtl",
+        "newmtl red\nKd 1 0 0\nmap_Kd red.tga\n"
+        "newmtl blue\nKd 0 0 1\nNs 32\n");
+    const char* const groups_obj =
+        "mtllib tiny_renderer_groups.mtl\n"
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+        "o body\nusemtl blue\nf 1 2 3\n"
+        "usemtl red\nf 1 3 4\nf 1 2 4\n"
+        "g head\nusemtl blue\nf 2 3 4\n";
+    Model model(write_temp("groups.obj", groups_obj));
+    CHECK(model.nfaces() == 4);
+    CHECK(model.nmaterials() == 2);
+    CHECK(model.nsubmeshes() == 3);
+    if (model.nmaterials() != 2 || model.nsubmeshes() != 3) return;
+
+    const Material& red = model.material(0);
+    CHECK(red.name == "red");
+    CHECK(vec_nearly_equal<3>(red.diffuse, vec3{1, 0, 0}, 1e-12));
+    CHECK(red.diffuse_map.find("red.tga") != std::string::npos);
+    CHECK(nearly_equal(model.material(1).shininess, 32, 1e-12));
+
+    // 材质 red(0) 在前，blue(1) 的两个子网格随后且保持出现顺序
+    int first = 0;
+    for (int i = 0; i < model.nsubmeshes(); ++i) {
+        CHECK(model.submesh(i).first_face == first);
+        first += model.submesh(i).nfaces;
+    }
+    CHECK(model.submesh(0).name == "body" && model.submesh(0).material == 0 && model.submesh(0).nfaces == 2);
+    CHECK(model.submesh(1).name == "body" && model.submesh(1).material == 1 && model.submesh(1).nfaces == 1);
+    CHECK(model.submesh(2).name == "head" && model.submesh(2).material == 1 && model.submesh(2).nfaces == 1);
+
+    // 子网格内三角形保持文件顺序
+    CHECK(vec_nearly_equal<3>(model.vert(0, 2), vec3{0, 1, 0}, 1e-12));
+    CHECK(vec_nearly_equal<3>(model.vert(1, 2), vec3{0, 1, 0}, 1e-12));
+    CHECK(vec_nearly_equal<3>(model.vert(1, 1), vec3{1, 0, 0}, 1e-12));
+    CHECK(vec_nearly_equal<3>(model.vert(3, 0), vec3{1, 0, 0}, 1e-12));
+}
+
+/**
+ * @brief 按小端追加 32 位整数
+ */
+void put_u32(std::string& s, std::uint32_t v) {
+    for (int i = 0; i < 4; ++i) s += char((v >> (8 * i)) & 0xFF);
+}
+
+/**
+ * @brief 把 JSON 与 BIN 块打包为 .glb 并写入临时文件
+ *
+ * @return 文件路径
+ */
+std::string write_glb(const std::string& name, std::string json, std::string bin) {
+    while (json.size() % 4) json += ' ';
+    while (bin.size() % 4) bin += '\0';
+    std::string glb;
+    put_u32(glb, 0x46546C67);
+    put_u32(glb, 2);
+    put_u32(glb, 12 + 8 + json.size() + 8 + bin.size());
+    put_u32(glb, json.size());
+    put_u32(glb, 0x4E4F534A);
+    glb += json;
+    put_u32(glb, bin.size());
+    put_u32(glb, 0x004E4942);
+    glb += bin;
+    const std::string path = (std::filesystem::temp_directory_path() / ("tiny_renderer_" + name + ".glb")).string();
+    std::ofstream(path, std::ios::binary) << glb;
+    return path;
+}
+
+/**
+ * @brief 测试 .glb 读取：交错顶点缓冲、16 位索引、节点平移
+ */
+void test_glb_loading() {
+    // 交错布局：position(3f) + uv(2f)，stride = 20
+    const float vertices[4][5] = {
+        {0, 0, 0, 0, 1}, {1, 0, 0, 1, 1}, {1, 1, 0, 1, 0}, {0, 1, 0, 0, 0},
+    };
+    const std::uint16_t indices[6] = {0, 1, 2, 0, 2, 3};
+    const float bulge[4][3] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 1}, {0, 0, 0}};     // 形变目标：只移动顶点 2
+    std::string bin(sizeof(vertices) + sizeof(indices) + sizeof(bulge), '\0');
+    std::memcpy(&bin[0], vertices, sizeof(vertices));
+    std::memcpy(&bin[sizeof(vertices)], indices, sizeof(indices));
+    std::memcpy(&bin[sizeof(vertices) + sizeof(indices)], bulge, sizeof(bulge));
+
+    std::string json =
+        "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],"
+        "\"nodes\":[{\"mesh\":0,\"translation\":[0,0,5]}],"
+        "\"materials\":[{\"name\":\"paint\",\"pbrMetallicRoughness\":{\"baseColorFactor\":[0.5,0.25,1,1]}}],"
+        "\"meshes\":[{\"name\":\"plane\",\"extras\":{\"targetNames\":[\"bulge\"]},"
+        "\"primitives\":[{\"attributes\":{\"POSITION\":0,\"TEXCOORD_0\":1},"
+        "\"indices\":2,\"material\":0,\"targets\":[{\"POSITION\":3}]}]}],"
+        "\"buffers\":[{\"byteLength\":140}],"
+        "\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":80,\"byteStride\":20},"
+        "{\"buffer\":0,\"byteOffset\":80,\"byteLength\":12},"
+        "{\"buffer\":0,\"byteOffset\":92,\"byteLength\":48}],"
+        "\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":4,\"type\":\"VEC3\"},"
+        "{\"bufferView\":0,\"byteOffset\":12,\"componentType\":5126,\"count\":4,\"type\":\"VEC2\"},"
+        "{\"bufferView\":1,\"componentType\":5123,\"count\":6,\"type\":\"SCALAR\"},"
+        "{\"bufferView\":2,\"componentType\":5126,\"count\":4,\"type\":\"VEC3\"}]}";
+
+    Model model(write_glb("plane", json, bin));
+    CHECK(model.nverts() == 4);
+    CHECK(model.nfaces() == 2);
+    CHECK(model.nmaterials() == 1 && model.nsubmeshes() == 1);
+    if (model.nfaces() != 2 || model.nmaterials() != 1 || model.nsubmeshes() != 1) return;
+    CHECK(model.material(0).name == "paint");
+    CHECK(vec_nearly_equal<3>(model.material(0).diffuse, vec3{0.5, 0.25, 1}, 1e-12));
+    CHECK(model.submesh(0).name == "plane" && model.submesh(0).nfaces == 2);
+    CHECK(vec_nearly_equal<3>(model.vert(0, 2), vec3{1, 1, 5}, 1e-12));
+    CHECK(vec_nearly_equal<3>(model.vert(1, 2), vec3{0, 1, 5}, 1e-12));
+    CHECK(vec_nearly_equal<2>(model.uv(0, 1), vec2{1, 0}, 1e-12));
+    CHECK(vec_nearly_equal<3>(model.normal(0, 0), vec3{0, 0, 1}, 1e-12));
+    CHECK(vec_nearly_equal<4>(model.tangent(0, 0), vec4{1, 0, 0, 1}, 1e-12));
+    CHECK(model.nmorph_targets() == 1);
+    if (model.nmorph_targets() != 1) return;
+    CHECK(model.morph_target(0).name == "bulge" && model.morph_target(0).indices == std::vector<int>{2});
+    CHECK(vec_nearly_equal<3>(model.morph_target(0).deltas[0], vec3{0, 0, 1}, 1e-12));
+}
+
+/**
+ * @brief 测试 .glb 访问器校验：负个数、负偏移、过小步长与超出 int 的数值均返回无效视图
+ */
+void test_glb_bad_accessors() {
+    const std::string bin(64, '\0');
+    auto accessor = [&](const std::string& view, const std::string& acc) {
+        const std::string json =
+            "{\"asset\":{\"version\":\"2.0\"},\"buffers\":[{\"byteLength\":64}],"
+            "\"bufferViews\":[{\"buffer\":0," + view + "}],"
+            "\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"type\":\"VEC3\"," + acc + "}]}";
+        GlbFile file;
+        CHECK(file.open(write_glb("accessor", json, bin)));
+        return file.accessor(0);
+    };
+    CHECK(accessor("\"byteLength\":48", "\"count\":4").valid());
+    CHECK(accessor("\"byteLength\":64,\"byteStride\":16", "\"count\":4").valid());
+    CHECK(!accessor("\"byteLength\":48", "\"count\":-4").valid());
+    CHECK(!accessor("\"byteLength\":48", "\"count\":5").valid());
+    CHECK(!accessor("\"byteLength\":48", "\"count\":1e12").valid());
+    CHECK(!accessor("\"byteOffset\":-12,\"byteLength\":48", "\"count\":4").valid());
+    CHECK(!accessor("\"byteLength\":48", "\"count\":3,\"byteOffset\":-12").valid());
+    CHECK(!accessor("\"byteLength\":48,\"byteStride\":4", "\"count\":4").valid());
+    CHECK(!accessor("\"byteLength\":-48", "\"count\":1").valid());
+}
+
+/**
+ * @brief 按小端追加任意定长值
+ */
+template<typename T>
+void put(std::string& s, T v) {
+    s.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+/**
+ * @brief 测试二进制 PLY 读取：全三角形的并行路径与含四边形的顺序路径
+ */
+void test_ply_loading() {
+    const float xyz[4][3] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}};
+
+    // 全三角形，额外的 confidence 属性打断紧凑布局之外的字段
+    std::string tri =
+        "ply\nformat binary_little_endian 1.0\ncomment scanner\n"
+        "element vertex 4\nproperty float x\nproperty float y\nproperty float z\nproperty uchar confidence\n"
+        "element face 2\nproperty list uchar int vertex_indices\nend_header\n";
+    for (const auto& v : xyz) {
+        for (float c : v) put(tri, c);
+        put<std::uint8_t>(tri, 200);
+    }
+    const int faces[2][3] = {{0, 1, 2}, {0, 2, 3}};
+    for (const auto& f : faces) {
+        put<std::uint8_t>(tri, 3);
+        for (int k = 0; k < 3; ++k) put<std::int32_t>(tri, f[k]);
+    }
+    Model tris(write_temp("tris.ply", tri));
+    CHECK(tris.nverts() == 4 && tris.nfaces() == 2);
+    if (tris.nfaces() == 2) {
+        CHECK(vec_nearly_equal<3>(tris.vert(1, 2), vec3{0, 1, 0}, 1e-12));
+        CHECK(vec_nearly_equal<3>(tris.normal(0, 0), vec3{0, 0, 1}, 1e-12));
+    }
+
+    // 一个四边形，double 坐标，ushort 索引
+    std::string quad =
+        "ply\nformat binary_little_endian 1.0\n"
+        "element vertex 4\nproperty double x\nproperty double y\nproperty double z\n"
+        "element face 1\nproperty list uchar ushort vertex_indices\nend_header\n";
+    for (const auto& v : xyz)
+        for (float c : v) put<double>(quad, c);
+    put<std::uint8_t>(quad, 4);
+    for (std::uint16_t i : {0, 1, 2, 3}) put(quad, i);
+    Model quads(write_temp("quad.ply", quad));
+    CHECK(quads.nverts() == 4 && quads.nfaces() == 2);
+    CHECK(quads.nsubmeshes() == 1);
+
+    // 列表长度远超剩余字节（首个或后续的面，含无穷大）：报告截断，不做溢出的转换
+    for (const double bad : {4e9, 1e300, std::numeric_limits<double>::infinity()}) {
+        for (const bool first : {true, false}) {
+            std::string big =
+                "ply\nformat binary_little_endian 1.0\n"
+                "element vertex 4\nproperty float x\nproperty float y\nproperty float z\n"
+                "element face 2\nproperty list double int vertex_indices\nend_header\n";
+            for (const auto& v : xyz)
+                for (float c : v) put(big, c);
+            for (const bool is_bad : {first, !first}) {
+                put<double>(big, is_bad ? bad : 3);
+                for (int k = 0; k < 3; ++k) put<std::int32_t>(big, k);
+            }
+            Model m(write_temp("big_list.ply", big));
+            CHECK(m.nverts() == 0 && m.nfaces() == 0);
+        }
+    }
+}
+
+/**
+ * @brief 测试量化网格：融合反量化的变换与逐元素解码的误差
+ */
+void test_quantized_model() {
+    Model model(write_temp("cube_q.obj", cube_obj));
+    const QuantizedModel q(model);
+    CHECK(q.nverts() == model.nverts() && q.nfaces() == model.nfaces());
+    // 8 个位置 + 8 条法线 + 1 个纹理坐标，至少压缩到 1/4
+    CHECK(q.vertex_bytes() * 4 <= 16 * sizeof(vec3) + sizeof(vec2));
+
+    mat<4,4> m = {{{2, 0, 0, 1}, {0, 0, -1, 2}, {0, 3, 0, 3}, {0, 0, 0, 1}}};
+    std::vector<vec4> out;
+    q.transform(m, out);
+    CHECK((int)out.size() == model.nverts());
+    for (int i = 0; i < model.nverts() && i < (int)out.size(); ++i) {
+        const vec3 v = model.vert(i);
+        CHECK(vec_nearly_equal<4>(out[i], m * vec4{v.x, v.y, v.z, 1}, 1e-4));
+        CHECK(vec_nearly_equal<3>(q.vert(i), v, 1e-4));
+    }
+    for (int f = 0; f < model.nfaces(); ++f) {
+        for (int k = 0; k < 3; ++k) {
+            CHECK(q.normal(f, k) * model.normal(f, k) > 1 - 1e-8);
+            CHECK(vec_nearly_equal<2>(q.uv(f, k), model.uv(f, k), 1e-3));
+        }
+    }
+}
+
+/**
+ * @brief 测试边邻接：立方体 12 条棱加 6 条对角线，棱为折痕，对角线不是；
+ * 从 (5, 5, 5) 看去三个面朝前，轮廓是围绕它们的 6 条棱
+ */
+void test_edge_adjacency() {
+    Model model(write_temp("cube_edges.obj", cube_obj));
+    const EdgeAdjacency adj(model);
+    CHECK(adj.nedges() == 18);
+    int creases = 0;
+    for (int i = 0; i < adj.nedges(); ++i) {
+        const Edge& e = adj.edge(i);
+        CHECK(e.v0 < e.v1 && e.f1 >= 0 && e.f0 != e.f1);
+        if (adj.dihedral_cos(i) < .5) ++creases;
+        CHECK(nearly_equal(adj.dihedral_cos(i), 0, 1e-12) || nearly_equal(adj.dihedral_cos(i), 1, 1e-12));
+    }
+    CHECK(creases == 12);
+
+    const std::vector<int> silhouette = adj.feature_edges(model, {5, 5, 5}, true, 180);
+    CHECK(silhouette.size() == 6);
+    for (const int i : silhouette) {
+        const Edge& e = adj.edge(i);
+        const bool a = adj.face_normal(e.f0) * vec3{1, 1, 1} > 0, b = adj.face_normal(e.f1) * vec3{1, 1, 1} > 0;
+        CHECK(a != b);
+    }
+    CHECK(adj.feature_edges(model, {5, 5, 5}, true, 60).size() == 9);
+    CHECK(adj.feature_edges(model, {0, 0, 1}, false, 180).size() == 4);
+
+    // 闭合环面：V - E + F = 0，每条边恰有两个面；规模足以走并行排序
+    const int nu = 100, nv = 100;
+    std::string torus;
+    for (int i = 0; i < nu; ++i) {
+        for (int j = 0; j < nv; ++j) {
+            const double u = 2 * M_PI * i / nu, v = 2 * M_PI * j / nv;
+            torus += "v " + std::to_string((2 + std::cos(v)) * std::cos(u)) + " " + std::to_string((2 + std::cos(v)) * std::sin(u)) +
+                     " " + std::to_string(std::sin(v)) + "\n";
+        }
+    }
+    for (int i = 0; i < nu; ++i) {
+        for (int j = 0; j < nv; ++j) {
+            const int a = i * nv + j + 1, b = (i + 1) % nu * nv + j + 1;
+            const int c = (i + 1) % nu * nv + (j + 1) % nv + 1, d = i * nv + (j + 1) % nv + 1;
+            torus += "f " + std::to_string(a) + " " + std::to_string(b) + " " + std::to_string(c) + "\n";
+            torus += "f " + std::to_string(a) + " " + std::to_string(c) + " " + std::to_string(d) + "\n";
+        }
+    }
+    Model ring(write_temp("torus_edges.obj", torus));
+    const EdgeAdjacency ring_adj(ring);
+    CHECK(ring_adj.nedges() == 3 * nu * nv);
+    bool closed = true, sorted = true;
+    for (int i = 0; i < ring_adj.nedges(); ++i) {
+        closed = closed && ring_adj.edge(i).f1 >= 0;
+        if (i > 0) {
+            const Edge& p = ring_adj.edge(i - 1);
+            const Edge& e = ring_adj.edge(i);
+            sorted = sorted && (p.v0 < e.v0 || (p.v0 == e.v0 && p.v1 < e.v1));
+        }
+    }
+    CHECK(closed);
+    CHECK(sorted);
+}
+
+/**
+ * @brief 测试半边结构：立方体闭合，对边互逆且方向相反，顶点度之和为半边数；
+ * 两个三角形拼成的正方形有 4 条边界半边，边界顶点的一环从一端走到另一端
+ */
+void test_half_edge() {
+    Model model(write_temp("cube_half_edge.obj", cube_obj));
+    const HalfEdgeMesh mesh(model);
+    CHECK(mesh.nverts() == 8 && mesh.nfaces() == 12 && mesh.nhalfedges() == 36);
+    CHECK(mesh.nonmanifold_edges() == 0);
+    int degree = 0;
+    for (int h = 0; h < mesh.nhalfedges(); ++h) {
+        CHECK(!mesh.is_boundary(h));
+        CHECK(mesh.twin(mesh.twin(h)) == std::uint32_t(h));
+        CHECK(mesh.from(mesh.twin(h)) == mesh.to(h) && mesh.to(mesh.twin(h)) == mesh.from(h));
+        CHECK(mesh.next(mesh.prev(h)) == std::uint32_t(h) && mesh.face(mesh.next(h)) == mesh.face(h));
+        CHECK(int(mesh.from(h)) == model.facet(h / 3, h % 3));
+    }
+    for (int v = 0; v < mesh.nverts(); ++v) {
+        CHECK(!mesh.is_boundary_vertex(v));
+        degree += mesh.valence(v);
+    }
+    CHECK(degree == 36);
+    // 顶点 0 与 1、2、3、4、5 相连（2、5 经过面的对角线）
+    std::vector<std::uint32_t> ring;
+    mesh.for_each_neighbor(0, [&](std::uint32_t u, std::uint32_t) { ring.push_back(u); });
+    std::sort(ring.begin(), ring.end());
+    CHECK(ring == std::vector<std::uint32_t>{1, 2, 3, 4, 5});
+
+    const HalfEdgeMesh quad(4, {0, 1, 2, 0, 2, 3});
+    int boundary = 0;
+    for (int h = 0; h < quad.nhalfedges(); ++h) boundary += quad.is_boundary(h);
+    CHECK(boundary == 4);
+    CHECK(quad.is_boundary_vertex(0) && quad.valence(0) == 3 && quad.valence(1) == 2);
+    std::vector<std::uint32_t> fan;
+    quad.for_each_neighbor(0, [&](std::uint32_t u, std::uint32_t) { fan.push_back(u); });
+    CHECK(fan == std::vector<std::uint32_t>{1, 2, 3});
+
+    // 三个面共享同一条边：非流形，不配对
+    const HalfEdgeMesh fin(5, {0, 1, 2, 1, 0, 3, 0, 1, 4});
+    CHECK(fin.nonmanifold_edges() == 1);
+    CHECK(fin.is_boundary(0) && fin.is_boundary(3) && fin.is_boundary(6));
+}
+
+/**
+ * @brief 测试 Loop 细分：闭合立方体细分后仍闭合且收缩在原包围盒内，平面网格保持共面；
+ * 全选的自适应细分与均匀细分相同，只选一个面时周围的面无接缝地分割
+ */
+void test_loop_subdivision() {
+    Model model(write_temp("cube_loop.obj", cube_obj));
+    const Model once = Subdivision::loop(model, 1);
+    CHECK(once.nverts() == 8 + 18 && once.nfaces() == 48);
+    const Model twice = Subdivision::loop(model, 2);
+    CHECK(twice.nverts() == 26 + 72 && twice.nfaces() == 192);
+    const HalfEdgeMesh closed(twice);
+    bool watertight = closed.nonmanifold_edges() == 0;
+    for (int h = 0; h < closed.nhalfedges(); ++h) watertight = watertight && !closed.is_boundary(h);
+    CHECK(watertight);
+    bool inside = true;
+    for (int i = 0; i < twice.nverts(); ++i)
+        for (int k = 0; k < 3; ++k) inside = inside && twice.vert(i)[k] > 0 && twice.vert(i)[k] < 1;
+    CHECK(inside);
+    CHECK(twice.nsubmeshes() == model.nsubmeshes());
+    if (twice.nsubmeshes() > 0) CHECK(twice.submesh(twice.nsubmeshes() - 1).first_face + twice.submesh(twice.nsubmeshes() - 1).nfaces == 192);
+
+    const Model all = Subdivision::loop_adaptive(model, std::vector<char>(model.nfaces(), 1), 2);
+    bool same = all.nverts() == twice.nverts() && all.nfaces() == twice.nfaces();
+    for (int f = 0; same && f < all.nfaces(); ++f)
+        for (int k = 0; k < 3; ++k) same = same && all.facet(f, k) == twice.facet(f, k) && norm(all.vert(f, k) - twice.vert(f, k)) == 0;
+    CHECK(same);
+
+    std::vector<char> one(model.nfaces(), 0);
+    one[0] = 1;
+    const Model local = Subdivision::loop_adaptive(model, one, 1);
+    CHECK(local.nfaces() == 4 + 3 * 2 + 8);
+    const HalfEdgeMesh local_mesh(local);
+    bool crack_free = local_mesh.nonmanifold_edges() == 0;
+    for (int h = 0; h < local_mesh.nhalfedges(); ++h) crack_free = crack_free && !local_mesh.is_boundary(h);
+    CHECK(crack_free);
+
+    Model quad(write_temp("quad_loop.obj", "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3\nf 1 3 4\n"));
+    const Model flat = Subdivision::loop(quad, 2);
+    CHECK(flat.nfaces() == 32);
+    bool planar = true;
+    for (int i = 0; i < flat.nverts(); ++i) planar = planar && flat.vert(i).z == 0;
+    CHECK(planar);
+}
+
+/**
+ * @brief 测试自适应细分的选面：正交相机沿 +z 看，轮廓是顶面的 4 条棱，
+ * 选中顶面的 2 个三角形与每个侧面挨着顶面的 1 个；投影边长阈值足够小时全选
+ */
+void test_subdivision_selection() {
+    Model model(write_temp("cube_select.obj", cube_obj));
+    const mat<4,4> identity = {{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}};
+    const std::vector<char> silhouette = Subdivision::select_faces(model, identity, {0, 0, 1}, false, 10);
+    CHECK(std::count(silhouette.begin(), silhouette.end(), 1) == 6);
+    const std::vector<char> large = Subdivision::select_faces(model, identity, {0, 0, 1}, false, .5);
+    CHECK(std::count(large.begin(), large.end(), 1) == 12);
+}
+
+/**
+ * @brief 测试体素化：体素中心落在立方体面上时，表面恰好是 11^3 - 9^3 个体素的壳，
+ * 内部为空；原点平移后坐标为负的块同样正确；非法边长与超出块坐标范围时为空网格
+ */
+void test_voxelization() {
+    Model model(write_temp("cube_voxel.obj", cube_obj));
+    const VoxelGrid grid(model, .1, {-.05, -.05, -.05});
+    CHECK(grid.count() == 11 * 11 * 11 - 9 * 9 * 9);
+    CHECK(grid.nbricks() == 8);
+    CHECK(grid.occupied(0, 5, 5) && grid.occupied(10, 10, 10) && grid.occupied(3, 0, 7));
+    CHECK(!grid.occupied(5, 5, 5) && !grid.occupied(-1, 5, 5) && !grid.occupied(11, 5, 5));
+    CHECK(vec_nearly_equal<3>(grid.center(10, 0, 5), {1, 0, .5}, 1e-12));
+
+    const VoxelGrid shifted(model, .1, {.45, .45, .45});
+    CHECK(shifted.count() == grid.count());
+    CHECK(shifted.nbricks() == 8);
+    CHECK(shifted.occupied(-5, -5, -5) && shifted.occupied(5, 0, 0) && !shifted.occupied(0, 0, 0));
+
+    // 非法体素边长与超出块坐标范围的网格得到空网格
+    for (const double bad : {0.0, -.1, std::nan("")}) {
+        const VoxelGrid empty(model, bad);
+        CHECK(empty.count() == 0 && empty.nbricks() == 0);
+    }
+    const VoxelGrid far(model, .1, {-1e6, 0, 0});
+    CHECK(far.count() == 0 && far.nbricks() == 0);
+}
+
+/**
+ * @brief 绕 z 轴旋转 deg 度再平移 t 的关节矩阵
+ */
+mat<4,4> joint_matrix(const double deg, const vec3& t) {
+    const double a = deg * M_PI / 180, c = std::cos(a), s = std::sin(a);
+    return {{{c, -s, 0, t.x}, {s, c, 0, t.y}, {0, 0, 1, t.z}, {0, 0, 0, 1}}};
+}
+
+/**
+ * @brief 测试蒙皮：单关节的顶点与直接矩阵变换一致（含不足 8 个的尾组）；
+ * 两个关节相差 180 度时线性混合塌陷到轴上，对偶四元数保持到轴的距离；多网格并行与逐个结果相同
+ */
+void test_skinning() {
+    Model model = Subdivision::loop(Model(write_temp("cube_skin.obj", cube_obj)), 1);
+    const int nv = model.nverts();
+    CHECK(nv % Skinning::lanes != 0);
+    std::vector<int> joints(nv * 4, 0);
+    std::vector<vec4> weights(nv, vec4{1, 0, 0, 0});
+    for (int i = 0; i < nv; ++i) joints[i * 4] = model.vert(i).z > .5 ? 1 : 0;
+    weights[0] = {0, 0, 0, 0};      // 不受关节影响
+    CHECK(!model.set_skin(joints, std::vector<vec4>(nv - 1)));
+    CHECK(model.set_skin(joints, weights) && model.has_skin());
+
+    const std::vector<mat<4,4>> pose = {joint_matrix(0, {0, 0, 0}), joint_matrix(90, {1, 2, 3})};
+    for (const Skinning::Method method : {Skinning::LINEAR_BLEND, Skinning::DUAL_QUATERNION}) {
+        std::vector<vec3> out;
+        Skinning::skin(model, pose, method, out);
+        CHECK((int)out.size() == nv);
+        bool exact = true;
+        for (int i = 0; i < nv && i < (int)out.size(); ++i) {
+            const vec3 p = model.vert(i);
+            const vec4 expect = i == 0 ? vec4{p.x, p.y, p.z, 1} : pose[joints[i * 4]] * vec4{p.x, p.y, p.z, 1};
+            exact = exact && vec_nearly_equal<3>(out[i], expect.xyz(), 1e-5);
+        }
+        CHECK(exact);
+    }
+
+    Model bar(write_temp("skin_bar.obj", "v 1 0 0\nv 0 1 0\nv 0 0 1\nf 1 2 3\n"));
+    CHECK(bar.set_skin(std::vector<int>{0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0}, std::vector<vec4>(3, vec4{.5, .5, 0, 0})));
+    const std::vector<mat<4,4>> twist = {joint_matrix(0, {0, 0, 0}), joint_matrix(180, {0, 0, 0})};
+    std::vector<vec3> linear, dual;
+    Skinning::skin(bar, twist, Skinning::LINEAR_BLEND, linear);
+    Skinning::skin(bar, twist, Skinning::DUAL_QUATERNION, dual);
+    CHECK(norm(linear[0]) < 1e-5);
+    CHECK(std::abs(norm(dual[0]) - 1) < 1e-5 && std::abs(dual[0].z) < 1e-5);
+
+    std::vector<vec3> a, b;
+    const std::vector<Skinning::Job> jobs = {{&model, &pose, &a}, {&bar, &twist, &b}};
+    Skinning::skin_meshes(jobs, Skinning::DUAL_QUATERNION);
+    std::vector<vec3> single;
+    Skinning::skin(model, pose, Skinning::DUAL_QUATERNION, single);
+    bool same = a.size() == single.size() && b.size() == dual.size();
+    for (int i = 0; same && i < (int)a.size(); ++i) same = norm(a[i] - single[i]) == 0;
+    for (int i = 0; same && i < (int)b.size(); ++i) same = norm(b[i] - dual[i]) == 0;
+    CHECK(same);
+}
+
+/**
+ * @brief 测试形变目标：只有激活目标触及的顶点被移动，换帧时上一帧的位移被撤销；同一地址换了模型时重新拷贝基础位置
+ */
+void test_morph_targets() {
+    Model model(write_temp("cube_morph.obj", cube_obj));
+    CHECK(!model.add_morph_target({"bad", {6, 5}, {{0, 0, 1}, {0, 0, 1}}}));
+    CHECK(!model.add_morph_target({"bad", {8}, {{0, 0, 1}}}));
+    CHECK(model.add_morph_target({"lift", {6}, {{0, 0, 1}}}));
+    CHECK(model.add_morph_target({"push", {5, 6}, {{1, 0, 0}, {1, 0, 0}}}));
+    CHECK(model.nmorph_targets() == 2 && model.morph_target(1).name == "push");
+
+    MorphBuffer buffer;
+    auto matches = [&](const std::vector<vec3>& expect) {
+        bool ok = (int)buffer.positions().size() == model.nverts();
+        for (int i = 0; ok && i < model.nverts(); ++i) ok = vec_nearly_equal<3>(buffer.positions()[i], expect[i], 1e-12);
+        return ok;
+    };
+    std::vector<vec3> base(model.nverts());
+    for (int i = 0; i < model.nverts(); ++i) base[i] = model.vert(i);
+
+    buffer.evaluate(model, {1});
+    std::vector<vec3> expect = base;
+    expect[6] = {1, 1, 2};
+    CHECK(matches(expect) && buffer.touched() == 1);
+
+    buffer.evaluate(model, {0, .5});
+    expect = base;
+    expect[5] = {1.5, 0, 1};
+    expect[6] = {1.5, 1, 1};
+    CHECK(matches(expect) && buffer.touched() == 2);
+
+    buffer.evaluate(model, {2, 1});
+    expect[5] = {2, 0, 1};
+    expect[6] = {2, 1, 3};
+    CHECK(matches(expect) && buffer.touched() == 2);
+
+    buffer.evaluate(model, {});
+    CHECK(matches(base) && buffer.touched() == 0);
+
+    // 同一地址换成顶点数相同的另一个模型：基础位置重新拷贝
+    std::string moved_obj = cube_obj;
+    moved_obj.replace(0, 7, "v -1 -1 -1");
+    model = Model(write_temp("cube_morph_moved.obj", moved_obj));
+    CHECK(model.nverts() == (int)base.size());
+    base[0] = {-1, -1, -1};
+    buffer.evaluate(model, {});
+    CHECK(matches(base));
+
+    buffer.reset();
+    CHECK(buffer.positions().empty());
+    buffer.evaluate(model, {});
+    CHECK(matches(base) && buffer.touched() == 0);
+}
+
+} // namespace
+
+/**
+ * @brief 自测入口
+ *
+ * @return 0 表示通过
+ */
+int main() {
+    test_generated_normals();
+    test_generated_tangents();
+    test_polygon_triangulation();
+    test_material_groups();
+    test_glb_loading();
+    test_glb_bad_accessors();
+    test_ply_loading();
+    test_quantized_model();
+    test_edge_adjacency();
+    test_half_edge();
+    test_loop_subdivision();
+    test_subdivision_selection();
+    test_voxelization();
+    test_skinning();
+    test_morph_targets();
+
+    if (g_failures == 0) {
+        std::cout << "test_model: all tests passed\n";
+        return 0;
+    }
+
+    std::cerr << "test_model: failed cases = " << g_failures << "\n";
+    return 1;
+}
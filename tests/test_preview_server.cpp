@@ -0,0 +1,138 @@
+/**
+ * @file tests/test_preview_server.cpp
+ * @brief tiny-renderer 的预览服务自测
+ */
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "io/preview_server.h"
+
+namespace {
+
+/// @brief 测试失败计数
+int g_failures = 0;
+
+/**
+ * @brief 失败时记录并输出（不中断后续测试）
+ *
+ * @param ok
+ * @param expr
+ * @param file
+ * @param line
+ */
+inline void check(bool ok, const char* expr, const char* file, int line) {
+    if (ok) return;
+    ++g_failures;
+    std::cerr << file << ":" << line << ": FAIL: " << expr << "\n";
+}
+
+#define CHECK(...) ::check((__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
+
+/**
+ * @brief 测试请求行的编码与解析
+ */
+void test_request_roundtrip() {
+    PreviewRequest r;
+    r.mesh = "/tmp/with space.obj";
+    r.width = 320;
+    r.height = 200;
+    r.mode = RenderSettings::WIREFRAME;
+    r.camera.eye = {1.25, -2, 3};
+    r.camera.persp = false;
+
+    PreviewRequest parsed;
+    CHECK(PreviewRequest::parse(r.to_line(), parsed));
+    CHECK(parsed.mesh == r.mesh);
+    CHECK(parsed.width == 320 && parsed.height == 200);
+    CHECK(parsed.mode == RenderSettings::WIREFRAME);
+    CHECK(parsed.camera == r.camera);
+    CHECK(!PreviewRequest::parse("render 0 10 shaded 0 0 3 0 0 0 0 1 0 1 a.obj", parsed));
+    CHECK(!PreviewRequest::parse("render 10 10 smooth 0 0 3 0 0 0 0 1 0 1 a.obj", parsed));
+    CHECK(!PreviewRequest::parse("render 10 10 shaded 0 0 3 0 0 0 0 1 0 1", parsed));
+    CHECK(!PreviewRequest::parse("render 10 10 shaded 0 0 0 0 0 0 0 1 0 1 a.obj", parsed));     // eye 与 center 重合
+    CHECK(!PreviewRequest::parse("render 10 10 shaded 0 3 0 0 0 0 0 1 0 1 a.obj", parsed));     // up 与视线平行
+}
+
+/**
+ * @brief 测试服务端渲染的画面与本地渲染一致，同一连接可连续请求，超长请求行断开连接
+ */
+void test_render_over_socket() {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "tiny_renderer_preview";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    const std::string mesh = (dir / "tri.obj").string();
+    std::ofstream(mesh) << "v -1 -1 0\nv 1 -1 0\nv 0 1 0\nf 1 2 3\n";
+    const std::string socket_path = (dir / "preview.sock").string();
+
+    PreviewServer server(socket_path, (dir / "cache").string());
+    CHECK(server.open());
+    std::thread serving([&] { server.run(); });
+
+    PreviewClient client;
+    CHECK(client.connect(socket_path));
+    PreviewRequest request;
+    request.mesh = mesh;
+    request.width = 40;
+    request.height = 30;
+    PreviewFrame frame;
+    CHECK(client.render(request, frame));
+    CHECK(frame.width == 40 && frame.height == 30);
+    CHECK(frame.pixels.size() == 40u * 30u);
+
+    Scene scene;
+    scene.instances.push_back({std::make_shared<const Model>(mesh)});
+    Framebuffer fb(40, 30);
+    Renderer().render(scene, request.camera, fb);
+    bool same = true;
+    for(int y = 0; y < 30; y ++)
+        for(int x = 0; x < 40; x ++) same = same && frame.pixels[y * 40 + x] == Framebuffer::pack(fb.get(x, y));
+    CHECK(same);
+    CHECK(frame.pixels[15 * 40 + 20] != Framebuffer::pack(RenderSettings().background));
+
+    request.mode = RenderSettings::POINTS;
+    CHECK(client.render(request, frame));
+    // 超过尺寸上限的请求得到错误回复，服务继续处理后续请求
+    request.width = request.height = 100000;
+    CHECK(!client.render(request, frame));
+    request.width = 40;
+    request.height = 30;
+    CHECK(client.render(request, frame) && frame.width == 40);
+    request.mesh = (dir / "missing.obj").string();
+    CHECK(!client.render(request, frame));
+
+    // 超长的请求行：服务端不缓存它而是断开连接，新连接照常服务
+    request.mesh = mesh + std::string(10000, 'x');
+    CHECK(!client.render(request, frame));
+    request.mesh = mesh;
+    CHECK(!client.render(request, frame));
+    PreviewClient second;
+    CHECK(second.connect(socket_path));
+    CHECK(second.render(request, frame) && frame.width == 40);
+
+    second.quit();
+    serving.join();
+}
+
+} // namespace
+
+/**
+ * @brief 自测入口
+ *
+ * @return 0 表示通过
+ */
+int main() {
+    test_request_roundtrip();
+    test_render_over_socket();
+
+    if (g_failures == 0) {
+        std::cout << "test_preview_server: all tests passed\n";
+        return 0;
+    }
+
+    std::cerr << "test_preview_server: failed cases = " << g_failures << "\n";
+    return 1;
+}
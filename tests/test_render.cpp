@@ -0,0 +1,863 @@
+/**
+ * @file tests/test_render.cpp
+ * @brief tiny-renderer 的分块光栅化自测
+ */
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "model/morph.h"
+#include "render/batch.h"
+#include "render/interpolation.h"
+#include "render/progressive.h"
+#include "render/render_cache.h"
+#include "render/renderer.h"
+
+namespace {
+
+/// @brief 测试失败计数
+int g_failures = 0;
+
+/**
+ * @brief 失败时记录并输出（不中断后续测试）
+ *
+ * @param ok
+ * @param expr
+ * @param file
+ * @param line
+ */
+inline void check(bool ok, const char* expr, const char* file, int line) {
+    if (ok) return;
+    ++g_failures;
+    std::cerr << file << ":" << line << ": FAIL: " << expr << "\n";
+}
+
+#define CHECK(...) ::check((__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
+
+/**
+ * @brief 写出单位立方体并加载（面朝外，逆时针）
+ *
+ * @return std::shared_ptr<const Model>
+ */
+std::shared_ptr<const Model> load_cube() {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "tiny_renderer_render_cube.obj";
+    std::ofstream(path) <<
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+        "v 0 0 1\nv 1 0 1\nv 1 1 1\nv 0 1 1\n"
+        "f 1 3 2\nf 1 4 3\nf 5 6 7\nf 5 7 8\n"
+        "f 1 2 6\nf 1 6 5\nf 2 3 7\nf 2 7 6\n"
+        "f 3 4 8\nf 3 8 7\nf 4 1 5\nf 4 5 8\n";
+    return std::make_shared<const Model>(path.string());
+}
+
+/**
+ * @brief 以 (x, y) 为中心、边长 s 的立方体的模型矩阵
+ */
+mat<4,4> place(const double x, const double y, const double s) {
+    mat<4,4> m = translate({x - s / 2, y - s / 2, -s / 2});
+    for(int i = 0; i < 3; i ++) m[i][i] = s;
+    return m;
+}
+
+/**
+ * @brief 两个颜色缓冲是否逐像素相同
+ */
+bool same_pixels(const Framebuffer& a, const Framebuffer& b) {
+    if(a.width() != b.width() || a.height() != b.height()) return false;
+    for(int y = 0; y < a.height(); y ++)
+        for(int x = 0; x < a.width(); x ++)
+            if(Framebuffer::pack(a.get(x, y)) != Framebuffer::pack(b.get(x, y))) return false;
+    return true;
+}
+
+/**
+ * @brief 两个相距较远的立方体，正交相机
+ */
+Scene two_cubes(const std::shared_ptr<const Model>& cube, Camera& camera) {
+    camera.persp = false;
+    Scene scene;
+    scene.instances.push_back({cube, place(-.6, -.6, .4), {255, 255, 255, 255}});
+    scene.instances.push_back({cube, place(.6, .6, .4), {0, 0, 255, 255}});
+    return scene;
+}
+
+/**
+ * @brief 测试着色覆盖：立方体中心被填充，空白处为背景色
+ */
+void test_shaded_coverage() {
+    Camera camera;
+    const Scene scene = two_cubes(load_cube(), camera);
+    Renderer renderer;
+    Framebuffer fb(128, 128);
+    const RenderStats stats = renderer.render(scene, camera, fb);
+    CHECK(stats.instances_updated == 2);
+    CHECK(stats.tiles_rendered == fb.ntiles());
+
+    // 正对相机的面法线与光照方向一致，亮度为 1
+    const TGAColor a = fb.get(25, 25), b = fb.get(102, 102), bg = fb.get(64, 64);
+    CHECK(a[0] == 255 && a[1] == 255 && a[2] == 255);
+    CHECK(b[0] == 0 && b[1] == 0 && b[2] == 255);
+    CHECK(bg[0] == 0 && bg[1] == 0 && bg[2] == 0);
+}
+
+/**
+ * @brief 测试增量渲染：移动、删除实例后只重绘受影响的块，结果与完整渲染一致
+ */
+void test_incremental_matches_full() {
+    Camera camera;
+    Scene scene = two_cubes(load_cube(), camera);
+    Renderer renderer;
+    Framebuffer fb(128, 128);
+    renderer.render(scene, camera, fb);
+
+    RenderStats stats = renderer.render_incremental(scene, camera, fb);
+    CHECK(stats.instances_updated == 0 && stats.tiles_rendered == 0);
+
+    scene.instances[1].transform = place(.5, .6, .4);
+    stats = renderer.render_incremental(scene, camera, fb);
+    CHECK(stats.instances_updated == 1);
+    CHECK(stats.tiles_rendered > 0 && stats.tiles_rendered < fb.ntiles());
+    Framebuffer full(128, 128);
+    Renderer().render(scene, camera, full);
+    CHECK(same_pixels(fb, full));
+
+    scene.instances.pop_back();
+    stats = renderer.render_incremental(scene, camera, fb);
+    CHECK(stats.tiles_rendered > 0 && stats.tiles_rendered < fb.ntiles());
+    Renderer().render(scene, camera, full);
+    CHECK(same_pixels(fb, full));
+
+    // 只改光照时完整重绘，结果与完整渲染一致
+    scene.light_dir = {1, 0, 1};
+    stats = renderer.render_incremental(scene, camera, fb);
+    CHECK(stats.tiles_rendered == fb.ntiles());
+    Renderer().render(scene, camera, full);
+    CHECK(same_pixels(fb, full));
+    scene.ambient = .5;
+    renderer.render_incremental(scene, camera, fb);
+    Renderer().render(scene, camera, full);
+    CHECK(same_pixels(fb, full));
+
+    // 相机变化时完整重绘
+    camera.eye = {.1, 0, 3};
+    stats = renderer.render_incremental(scene, camera, fb);
+    CHECK(stats.tiles_rendered == fb.ntiles());
+}
+
+/**
+ * @brief 测试裁剪矩形：矩形外不光栅化，矩形内与不裁剪时逐像素相同，修改矩形只重绘受影响的块
+ */
+void test_scissor() {
+    Camera camera;
+    camera.persp = false;
+    Scene scene;
+    scene.instances.push_back({load_cube(), place(0, 0, 1), {255, 255, 255, 255}});
+    Framebuffer plain(128, 128);
+    const RenderStats plain_stats = Renderer().render(scene, camera, plain);
+
+    scene.instances[0].scissor = {true, 40, 0, 64, 128};
+    Renderer renderer;
+    Framebuffer fb(128, 128);
+    const RenderStats stats = renderer.render(scene, camera, fb);
+    CHECK(stats.primitives_binned < plain_stats.primitives_binned);
+    bool inside_same = true, outside_clear = true;
+    for(int y = 0; y < 128; y ++) {
+        for(int x = 0; x < 128; x ++) {
+            const std::uint32_t c = Framebuffer::pack(fb.get(x, y));
+            if(x >= 40 && x < 64) inside_same = inside_same && c == Framebuffer::pack(plain.get(x, y));
+            else outside_clear = outside_clear && c == Framebuffer::pack(TGAColor{0, 0, 0, 255});
+        }
+    }
+    CHECK(inside_same);
+    CHECK(outside_clear);
+    CHECK(fb.get(50, 64)[0] > 0);
+
+    // 空矩形不画任何东西
+    scene.instances[0].scissor = {true, 64, 64, 64, 96};
+    RenderStats empty = Renderer().render(scene, camera, fb);
+    CHECK(empty.primitives_binned == 0);
+
+    scene.instances[0].scissor = {true, 40, 0, 64, 128};
+    renderer.render(scene, camera, fb);
+    scene.instances[0].scissor = {true, 40, 0, 100, 128};
+    const RenderStats moved = renderer.render_incremental(scene, camera, fb);
+    CHECK(moved.instances_updated == 1 && moved.tiles_rendered < fb.ntiles());
+    Framebuffer full(128, 128);
+    Renderer().render(scene, camera, full);
+    CHECK(same_pixels(fb, full));
+}
+
+/**
+ * @brief 测试模板：模板操作的语义；先画的小立方体写入模板，后画的大立方体只画在模板外，得到轮廓环
+ */
+void test_stencil() {
+    StencilState s;
+    s.ref = 3;
+    std::uint8_t v = 255;
+    s.apply(StencilState::INCREMENT, v);
+    CHECK(v == 255);
+    s.apply(StencilState::INCREMENT_WRAP, v);
+    CHECK(v == 0);
+    s.apply(StencilState::DECREMENT, v);
+    CHECK(v == 0);
+    s.apply(StencilState::DECREMENT_WRAP, v);
+    CHECK(v == 255);
+    s.write_mask = 0x0f;
+    s.apply(StencilState::ZERO, v);
+    CHECK(v == 0xf0);
+    s.apply(StencilState::REPLACE, v);
+    CHECK(v == 0xf3);
+    s.apply(StencilState::INVERT, v);
+    CHECK(v == 0xfc);
+    s.func = StencilState::LESS;
+    s.read_mask = 0x0f;
+    CHECK(s.test(0xf4) && !s.test(0x03));
+    StencilState::Func f;
+    StencilState::Op op;
+    CHECK(StencilState::parse_func("not-equal", f) && f == StencilState::NOT_EQUAL);
+    CHECK(StencilState::parse_op("decrement-wrap", op) && op == StencilState::DECREMENT_WRAP);
+    CHECK(!StencilState::parse_op("wrap", op));
+
+    Camera camera;
+    camera.persp = false;
+    const std::shared_ptr<const Model> cube = load_cube();
+    Scene scene;
+    scene.instances.push_back({cube, place(0, 0, .8), {255, 255, 255, 255}});
+    scene.instances.push_back({cube, place(0, 0, 1), {0, 0, 255, 255}});
+    StencilState& mark = scene.instances[0].stencil;
+    mark.enabled = true;
+    mark.ref = 1;
+    mark.pass = StencilState::REPLACE;
+    StencilState& outline = scene.instances[1].stencil;
+    outline.enabled = true;
+    outline.func = StencilState::NOT_EQUAL;
+    outline.ref = 1;
+
+    Renderer renderer;
+    Framebuffer fb(128, 128);
+    renderer.render(scene, camera, fb);
+    const TGAColor inner = fb.get(64, 64), ring = fb.get(35, 64), bg = fb.get(10, 64);
+    CHECK(inner[0] > 0 && inner[0] == inner[1] && inner[1] == inner[2]);
+    CHECK(ring[0] == 0 && ring[1] == 0 && ring[2] > 0);
+    CHECK(bg[0] == 0 && bg[1] == 0 && bg[2] == 0);
+    CHECK(fb.stencil(64, 64) == 1 && fb.stencil(35, 64) == 0);
+
+    // 改变模板参考值后大立方体覆盖整个区域，增量结果与完整渲染一致
+    outline.ref = 2;
+    const RenderStats stats = renderer.render_incremental(scene, camera, fb);
+    CHECK(stats.instances_updated == 1);
+    const TGAColor covered = fb.get(64, 64);
+    CHECK(covered[0] == 0 && covered[2] > 0);
+    Framebuffer full(128, 128);
+    Renderer().render(scene, camera, full);
+    CHECK(same_pixels(fb, full));
+}
+
+/**
+ * @brief 图像与颜色缓冲是否逐像素相同（只比较 RGB）
+ */
+bool same_image(const Framebuffer& fb, const TGAImage& image) {
+    if(fb.width() != image.width() || fb.height() != image.height()) return false;
+    for(int y = 0; y < fb.height(); y ++) {
+        for(int x = 0; x < fb.width(); x ++) {
+            const TGAColor a = fb.get(x, y), b = image.get(x, y);
+            if(a[0] != b[0] || a[1] != b[1] || a[2] != b[2]) return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 测试块状态：清空只改状态，写入时填充，常量块检测；resolve 与 RLE 写出与逐像素结果一致
+ */
+void test_tile_states() {
+    Framebuffer fb(70, 40);
+    fb.clear({0, 0, 255, 255});
+    bool all_cleared = true;
+    for(int t = 0; t < fb.ntiles(); t ++) all_cleared = all_cleared && fb.tile_state(t) == Framebuffer::CLEARED;
+    CHECK(all_cleared && fb.ntiles() == 6);
+    CHECK(fb.get(69, 39)[2] == 255);
+    CHECK(fb.depth(5, 5) == std::numeric_limits<float>::lowest() && fb.stencil(5, 5) == 0);
+    CHECK(fb.tile_state(0) == Framebuffer::UNCOMPRESSED && fb.tile_state(1) == Framebuffer::CLEARED);
+    fb.compact_tile(0);
+    CHECK(fb.tile_state(0) == Framebuffer::CONSTANT);
+    fb.color(40, 3) = Framebuffer::pack({0, 255, 0, 255});
+    fb.compact_tile(1);
+    CHECK(fb.tile_state(1) == Framebuffer::UNCOMPRESSED);
+    CHECK(fb.get(40, 3)[1] == 255 && fb.get(41, 3)[2] == 255);
+
+    TGAImage image;
+    fb.resolve(image);
+    CHECK(same_image(fb, image));
+
+    // 渲染后空白块保持 CLEARED 或变为 CONSTANT
+    Camera camera;
+    const Scene scene = two_cubes(load_cube(), camera);
+    Framebuffer frame(300, 200);
+    Renderer().render(scene, camera, frame);
+    int constant = 0, uncompressed = 0;
+    for(int t = 0; t < frame.ntiles(); t ++) {
+        constant += frame.tile_state(t) != Framebuffer::UNCOMPRESSED;
+        uncompressed += frame.tile_state(t) == Framebuffer::UNCOMPRESSED;
+    }
+    CHECK(constant > 0 && uncompressed > 0);
+    frame.resolve(image);
+    CHECK(same_image(frame, image));
+
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "tiny_renderer_tiles";
+    std::filesystem::create_directories(dir);
+    for(const Framebuffer* f : {&fb, &frame}) {
+        const std::string file = (dir / "frame.tga").string();
+        TGAImage back;
+        CHECK(f->write_tga(file) && back.read_tga_file(file));
+        back.flip_vertically();     // 读入时转为原点在左上角
+        CHECK(same_image(*f, back));
+    }
+    std::filesystem::remove_all(dir);
+}
+
+/**
+ * @brief 测试消隐线框：被遮挡的背面顶点不画，可见顶点照常画，增量结果与完整渲染一致；
+ * 特征线只画棱，不画正面的对角线
+ */
+void test_hidden_line() {
+    Camera camera;
+    camera.eye = {1, 1, 3};
+    Scene scene;
+    scene.instances.push_back({load_cube(), place(0, 0, .8)});
+    const mat<4,4> mvp = viewport(0, 0, 128, 128) * camera.view_projection(128, 128);
+    auto pixel_of = [&](const vec3& p, int& x, int& y) {
+        const vec4 clip = mvp * vec4{p.x, p.y, p.z, 1};
+        x = std::floor(clip.x / clip.w);
+        y = std::floor(clip.y / clip.w);
+    };
+    auto lit_near = [](const Framebuffer& fb, const int x, const int y) {
+        bool lit = false;
+        for(int dy = -1; dy <= 1; dy ++)
+            for(int dx = -1; dx <= 1; dx ++) lit = lit || fb.get(x + dx, y + dy)[0] != 0;
+        return lit;
+    };
+    int hx, hy, vx, vy;
+    pixel_of({-.4, -.1, -.4}, hx, hy);      // 背面一条棱上的点，被立方体挡住
+    pixel_of({.4, .4, .4}, vx, vy);         // 朝向相机的角
+
+    RenderSettings settings;
+    settings.mode = RenderSettings::WIREFRAME;
+    Framebuffer wire(128, 128);
+    Renderer(settings).render(scene, camera, wire);
+    CHECK(lit_near(wire, hx, hy));
+
+    settings.mode = RenderSettings::HIDDEN_LINE;
+    Renderer renderer(settings);
+    Framebuffer hidden(128, 128);
+    renderer.render(scene, camera, hidden);
+    CHECK(!lit_near(hidden, hx, hy));
+    CHECK(lit_near(hidden, vx, vy));
+    int lit_wire = 0, lit_hidden = 0;
+    for(int y = 0; y < 128; y ++)
+        for(int x = 0; x < 128; x ++) {
+            lit_wire += wire.get(x, y)[0] != 0;
+            lit_hidden += hidden.get(x, y)[0] != 0;
+        }
+    CHECK(lit_hidden > 0 && lit_hidden < lit_wire);
+
+    int dx, dy;
+    pixel_of({0, 0, .4}, dx, dy);           // 正面对角线的中点
+    CHECK(lit_near(hidden, dx, dy));
+    settings.mode = RenderSettings::FEATURE_LINE;
+    Framebuffer feature(128, 128);
+    Renderer(settings).render(scene, camera, feature);
+    CHECK(!lit_near(feature, dx, dy));
+    CHECK(!lit_near(feature, hx, hy));
+    CHECK(lit_near(feature, vx, vy));
+    int lit_feature = 0;
+    for(int y = 0; y < 128; y ++)
+        for(int x = 0; x < 128; x ++) lit_feature += feature.get(x, y)[0] != 0;
+    CHECK(lit_feature > 0 && lit_feature < lit_hidden);
+    settings.mode = RenderSettings::HIDDEN_LINE;
+
+    scene.instances[0].transform = place(.1, 0, .8);
+    renderer.render_incremental(scene, camera, hidden);
+    Framebuffer full(128, 128);
+    Renderer(settings).render(scene, camera, full);
+    CHECK(same_pixels(hidden, full));
+}
+
+/**
+ * @brief 测试透视校正插值：插值出的世界坐标投影回屏幕正好落在采样像素上
+ */
+void test_perspective_interpolation() {
+    Camera camera;
+    camera.eye = {1, 2, 3};
+    const mat<4,4> mvp = viewport(0, 0, 200, 100) * camera.view_projection(200, 100);
+    const vec3 world[3] = {{-1, -.5, -1}, {1.2, -.3, .8}, {0, 1, -.2}};
+    auto project = [&](const vec3& p) {
+        const vec4 clip = mvp * vec4{p.x, p.y, p.z, 1};
+        return vec4{clip.x / clip.w, clip.y / clip.w, clip.z / clip.w, 1 / clip.w};
+    };
+    const vec4 a = project(world[0]), b = project(world[1]), c = project(world[2]);
+    TriangleSetup tri;
+    CHECK(tri.setup(a, b, c));
+    CHECK(!TriangleSetup().setup(a, a, c));
+    for(int i = 0; i < 3; i ++) {
+        CHECK(std::abs(tri.bary[i].at(a.x, a.y) - (i == 0)) < 1e-9);
+        CHECK(std::abs(tri.bary[i].at(c.x, c.y) - (i == 2)) < 1e-9);
+    }
+
+    Plane pw[3];
+    for(int k = 0; k < 3; k ++) pw[k] = tri.perspective(world[0][k], world[1][k], world[2][k]);
+    const vec2 samples[3] = {{(a.x + b.x + c.x) / 3, (a.y + b.y + c.y) / 3},
+                             {(a.x * 3 + b.x) / 4, (a.y * 3 + b.y) / 4},
+                             {(b.x + c.x * 2) / 3, (b.y + c.y * 2) / 3}};
+    for(const vec2& p : samples) {
+        const double w = 1 / tri.inv_w.at(p.x, p.y);
+        const vec3 q = {pw[0].at(p.x, p.y) * w, pw[1].at(p.x, p.y) * w, pw[2].at(p.x, p.y) * w};
+        const vec4 back = project(q);
+        CHECK(std::abs(back.x - p.x) < 1e-9 && std::abs(back.y - p.y) < 1e-9);
+        CHECK(std::abs(back.z - tri.z.at(p.x, p.y)) < 1e-9);
+    }
+}
+
+/**
+ * @brief 测试线框与点模式：增量结果与完整渲染一致
+ */
+void test_wireframe_and_points() {
+    for(const RenderSettings::Mode mode : {RenderSettings::WIREFRAME, RenderSettings::POINTS}) {
+        Camera camera;
+        Scene scene = two_cubes(load_cube(), camera);
+        RenderSettings settings;
+        settings.mode = mode;
+        Renderer renderer(settings);
+        Framebuffer fb(128, 128);
+        renderer.render(scene, camera, fb);
+        int lit = 0;
+        for(int y = 0; y < fb.height(); y ++)
+            for(int x = 0; x < fb.width(); x ++) lit += fb.get(x, y)[0] != 0;
+        CHECK(lit > 0);
+
+        scene.instances[0].transform = place(-.5, -.6, .4);
+        renderer.render_incremental(scene, camera, fb);
+        Framebuffer full(128, 128);
+        Renderer(settings).render(scene, camera, full);
+        CHECK(same_pixels(fb, full));
+    }
+}
+
+/**
+ * @brief 测试量化网格实例：各模式与原模型的绘制结果逐像素相差不超过 1，渲染缓存区分两种网格
+ */
+void test_quantized_instance() {
+    const std::shared_ptr<const Model> cube = load_cube();
+    const auto quantized = std::make_shared<const QuantizedModel>(*cube);
+    for(const RenderSettings::Mode mode : {RenderSettings::SHADED, RenderSettings::WIREFRAME, RenderSettings::FEATURE_LINE}) {
+        Camera camera;
+        camera.eye = {1.5, 1.2, 2.5};
+        mat<4,4> spin = identity4();    // 绕 y 轴转 0.4 弧度，三个面可见
+        spin[0][0] = spin[2][2] = std::cos(.4);
+        spin[0][2] = std::sin(.4);
+        spin[2][0] = -std::sin(.4);
+        Scene scene;
+        scene.instances.push_back({cube, spin * place(0, 0, .8)});
+        RenderSettings settings;
+        settings.mode = mode;
+        Framebuffer expected(128, 128), fb(128, 128);
+        Renderer(settings).render(scene, camera, expected);
+        scene.instances[0].model = nullptr;
+        scene.instances[0].quantized = quantized;
+        Renderer(settings).render(scene, camera, fb);
+
+        int lit = 0, differ = 0;
+        for(int y = 0; y < fb.height(); y ++)
+            for(int x = 0; x < fb.width(); x ++) {
+                const TGAColor a = expected.get(x, y), b = fb.get(x, y);
+                lit += b[0] != 0 || b[1] != 0 || b[2] != 0;
+                for(int c = 0; c < 3; c ++) differ += std::abs(int(a[c]) - int(b[c])) > 1;
+            }
+        CHECK(lit > 0);
+        CHECK(differ == 0);
+    }
+
+    Camera camera;
+    Scene a = two_cubes(cube, camera), b = two_cubes(nullptr, camera);
+    for(Instance& inst : b.instances) inst.quantized = quantized;
+    RenderCache cache((std::filesystem::temp_directory_path() / "tiny_renderer_quantized_cache").string());
+    CHECK(cache.key(a, camera, {}, 64, 64).hash != cache.key(b, camera, {}, 64, 64).hash);
+}
+
+/**
+ * @brief 测试代替顶点位置：形变目标的求值结果按实例绘制，与把同样的位移放进变换的结果一致；
+ * 换了位置对象的实例被增量重绘，渲染缓存区分不同的位置
+ */
+void test_posed_instance() {
+    auto model = std::make_shared<Model>(*load_cube());
+    MorphTarget shift = {"shift", {}, {}};
+    for(int i = 0; i < model->nverts(); i ++) {
+        shift.indices.push_back(i);
+        shift.deltas.push_back({1.5, 0, 0});
+    }
+    CHECK(model->add_morph_target(shift));
+    const std::shared_ptr<const Model> cube = model;
+    MorphBuffer morph;
+    morph.evaluate(*cube, {1});
+
+    Camera camera;
+    camera.persp = false;
+    Scene posed;
+    posed.instances.push_back({cube, place(-.6, 0, .4)});
+    posed.instances[0].positions = std::make_shared<const std::vector<vec3>>(morph.positions());
+    Scene moved;
+    moved.instances.push_back({cube, place(-.6, 0, .4) * translate({1.5, 0, 0})});
+    Framebuffer a(128, 128), b(128, 128);
+    Renderer renderer;
+    renderer.render(posed, camera, a);
+    Renderer().render(moved, camera, b);
+    int differ = 0;
+    for(int y = 0; y < a.height(); y ++)
+        for(int x = 0; x < a.width(); x ++) differ += Framebuffer::pack(a.get(x, y)) != Framebuffer::pack(b.get(x, y));
+    CHECK(differ <= 16);    // 只允许边缘像素因舍入不同
+    CHECK(Framebuffer::pack(a.get(25, 64)) == Framebuffer::pack(RenderSettings().background));
+    CHECK(Framebuffer::pack(a.get(64, 64)) != Framebuffer::pack(RenderSettings().background));
+
+    // 大小与顶点数不符的位置被忽略
+    Scene wrong = posed;
+    wrong.instances[0].positions = std::make_shared<const std::vector<vec3>>(3, vec3{0, 0, 0});
+    Framebuffer c(128, 128);
+    Renderer().render(wrong, camera, c);
+    CHECK(Framebuffer::pack(c.get(25, 64)) != Framebuffer::pack(RenderSettings().background));
+
+    // 求值新的权重得到新的位置对象：只有这个实例被重新变换
+    morph.evaluate(*cube, {0});
+    Scene rest = posed;
+    rest.instances[0].positions = std::make_shared<const std::vector<vec3>>(morph.positions());
+    CHECK(renderer.render_incremental(rest, camera, a).instances_updated == 1);
+    CHECK(same_pixels(a, c));
+    RenderCache cache((std::filesystem::temp_directory_path() / "tiny_renderer_posed_cache").string());
+    CHECK(cache.key(posed, camera, {}, 64, 64).hash != cache.key(rest, camera, {}, 64, 64).hash);
+}
+
+/**
+ * @brief 测试极端坐标：贴近相机平面的顶点投影到约 1e10 像素之外，各模式照常绘制可见部分；
+ * 退化的相机被识别，渲染结果为背景而不是未定义行为
+ */
+void test_extreme_coordinates() {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "tiny_renderer_near_eye.obj";
+    std::ofstream(path) << "v -.5 -.5 0\nv .5 -.5 0\nv 1 .2 2.99999997\nf 1 2 3\n";
+    const auto model = std::make_shared<const Model>(path.string());
+    Camera camera;
+    CHECK(camera.valid());
+    Scene scene;
+    scene.instances.push_back({model});
+    for(const RenderSettings::Mode mode : {RenderSettings::SHADED, RenderSettings::WIREFRAME, RenderSettings::POINTS,
+                                           RenderSettings::HIDDEN_LINE, RenderSettings::FEATURE_LINE}) {
+        RenderSettings settings;
+        settings.mode = mode;
+        settings.cull_backfaces = false;
+        Framebuffer fb(64, 64);
+        Renderer(settings).render(scene, camera, fb);
+        int lit = 0;
+        for(int y = 0; y < fb.height(); y ++)
+            for(int x = 0; x < fb.width(); x ++) lit += fb.get(x, y)[0] != 0 || fb.get(x, y)[1] != 0 || fb.get(x, y)[2] != 0;
+        CHECK(mode == RenderSettings::POINTS || lit > 0);
+    }
+
+    for(const Camera& bad : {Camera{{0, 0, 0}, {0, 0, 0}, {0, 1, 0}, true}, Camera{{0, 3, 0}, {0, 0, 0}, {0, 1, 0}, true},
+                            Camera{{0, 0, std::nan("")}, {0, 0, 0}, {0, 1, 0}, false}}) {
+        CHECK(!bad.valid());
+        Framebuffer fb(16, 16);
+        Renderer().render(scene, bad, fb);
+        CHECK(Framebuffer::pack(fb.get(8, 8)) == Framebuffer::pack({0, 0, 0, 255}));
+    }
+}
+
+/**
+ * @brief 读取整个文件
+ */
+std::string read_file(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+/**
+ * @brief 测试分块顺序：大量深度相同、相互重叠的三角形，任意线程数与分段方式输出的 TGA 逐字节相同，
+ * 同一个 Renderer 复用分块缓冲渲染第二帧结果不变；切换分段方式不触发重绘
+ */
+void test_deterministic_threads() {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "tiny_renderer_overlap.obj";
+    {
+        std::ofstream out(path);
+        unsigned seed = 12345;
+        auto rnd = [&] { seed = seed * 1664525u + 1013904223u; return (seed >> 8) / double(1 << 24) * 2 - 1; };
+        const int n = 20000;
+        for(int i = 0; i < n; i ++) {
+            const double x = rnd(), y = rnd(), r = .05 + .1 * (rnd() + 1);
+            out << "v " << x << ' ' << y << " 0\nv " << x + r << ' ' << y << " 0\nv " << x << ' ' << y + r << " 0\n";
+        }
+        for(int i = 0; i < n; i ++) out << "f " << 3 * i + 1 << ' ' << 3 * i + 2 << ' ' << 3 * i + 3 << "\n";
+    }
+    const auto model = std::make_shared<const Model>(path.string());
+    CHECK(model->nfaces() == 20000);
+    Camera camera;
+    camera.persp = false;
+    Scene scene;
+    scene.instances.push_back({model, identity4(), {255, 0, 0, 255}});
+    scene.instances.push_back({model, translate({.01, 0, 0}), {0, 255, 0, 255}});
+
+    for(const RenderSettings::Mode mode : {RenderSettings::SHADED, RenderSettings::WIREFRAME}) {
+        std::string reference;
+        for(const int threads : {1, 2, 3, 4, 7}) {
+            for(const bool fine : {false, true}) {
+                RenderSettings settings;
+                settings.mode = mode;
+                settings.threads = threads;
+                settings.fine_grained_binning = fine;
+                Framebuffer fb(200, 150);
+                Renderer renderer(settings);
+                for(int frame = 0; frame < 2; frame ++) {
+                    renderer.render(scene, camera, fb);
+                    const std::filesystem::path out = std::filesystem::temp_directory_path() / "tiny_renderer_deterministic.tga";
+                    CHECK(write_frame(fb, out.string(), "tga"));
+                    const std::string bytes = read_file(out);
+                    if(reference.empty()) reference = bytes;
+                    CHECK(!bytes.empty() && bytes == reference);
+                }
+            }
+        }
+    }
+
+    Renderer renderer;
+    Framebuffer fb(200, 150);
+    renderer.render(scene, camera, fb);
+    RenderSettings settings = renderer.settings();
+    settings.fine_grained_binning = true;
+    settings.threads = 3;
+    CHECK(settings == renderer.settings());
+    renderer.set_settings(settings);
+    const RenderStats stats = renderer.render_incremental(scene, camera, fb);
+    CHECK(stats.instances_updated == 0 && stats.tiles_rendered == 0);
+}
+
+/**
+ * @brief 测试渐进式渲染：由粗到细四遍，最后一遍与完整渲染一致，回调可取消
+ */
+void test_progressive() {
+    Camera camera;
+    const Scene scene = two_cubes(load_cube(), camera);
+    ProgressiveRenderer progressive;
+    CHECK(progressive.npasses() == 4);
+
+    TGAImage image(100, 60, TGAImage::RGB);
+    std::vector<int> scales;
+    const int passes = progressive.render(scene, camera, image, [&](const int pass, const int scale, const TGAImage& img) {
+        CHECK(pass == (int)scales.size());
+        CHECK(img.width() == 100 && img.height() == 60);
+        scales.push_back(scale);
+        return true;
+    });
+    CHECK(passes == 4);
+    CHECK((scales == std::vector<int>{8, 4, 2, 1}));
+
+    Framebuffer full(100, 60);
+    Renderer().render(scene, camera, full);
+    bool same = true;
+    for(int y = 0; y < 60; y ++)
+        for(int x = 0; x < 100; x ++) {
+            const TGAColor a = image.get(x, y), b = full.get(x, y);
+            for(int i = 0; i < 3; i ++) same = same && a[i] == b[i];
+        }
+    CHECK(same);
+
+    const int cancelled = progressive.render(scene, camera, image, [](int, int, const TGAImage&) { return false; });
+    CHECK(cancelled == 1);
+}
+
+/**
+ * @brief 测试任务文件：网格只加载一次并被共享，多线程执行结果与直接渲染一致
+ */
+void test_batch() {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "tiny_renderer_batch";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    load_cube();
+    std::filesystem::copy_file(std::filesystem::temp_directory_path() / "tiny_renderer_render_cube.obj", dir / "cube.obj");
+    std::ofstream(dir / "jobs.json") << R"({
+        "meshes": { "cube": "cube.obj" },
+        "cameras": { "front": { "eye": [0, 0, 3], "ortho": true } },
+        "scenes": {
+            "one": { "instances": [ { "mesh": "cube", "translate": [-0.2, -0.2, -0.2], "scale": 0.4 } ] },
+            "two": { "ambient": 0.2, "instances": [
+                { "mesh": "cube", "translate": [-0.8, -0.8, -0.2], "scale": 0.4, "color": [255, 0, 0] },
+                { "mesh": "cube", "translate": [0.4, 0.4, -0.2], "scale": 0.4 } ] }
+        },
+        "jobs": [
+            { "scene": "one", "camera": "front", "width": 64, "height": 48, "output": "one.tga" },
+            { "scene": "two", "camera": "front", "width": 64, "height": 48, "output": "two.raw", "format": "raw" },
+            { "scene": "two", "camera": { "eye": [1, 1, 3] }, "mode": "wireframe", "width": 32, "height": 32, "output": "three.tga", "format": "tga-raw" }
+        ]
+    })";
+
+    BatchFile batch;
+    CHECK(read_batch_file((dir / "jobs.json").string(), batch));
+    CHECK(batch.meshes.size() == 1 && batch.scenes.size() == 2 && batch.jobs.size() == 3);
+    CHECK(batch.scenes[1].instances[0].model == batch.scenes[0].instances[0].model);
+    CHECK(batch.jobs[2].settings.mode == RenderSettings::WIREFRAME && batch.jobs[2].camera.persp);
+
+    const std::vector<JobResult> results = run_batch(batch, 2);
+    CHECK(results.size() == 3);
+    for(const JobResult& r : results) CHECK(r.ok);
+    TGAImage image;
+    CHECK(image.read_tga_file((dir / "one.tga").string()) && image.width() == 64);
+    CHECK(image.read_tga_file((dir / "three.tga").string()) && image.width() == 32);
+
+    Framebuffer fb(64, 48);
+    Renderer().render(batch.scenes[1], batch.jobs[1].camera, fb);
+    std::ifstream raw(dir / "two.raw", std::ios::binary);
+    bool same = true;
+    for(int y = 0; y < 48; y ++)
+        for(int x = 0; x < 64; x ++) {
+            std::uint32_t c = 0;
+            raw.read(reinterpret_cast<char*>(&c), 4);
+            same = same && c == Framebuffer::pack(fb.get(x, y));
+        }
+    CHECK(raw && same);
+
+    // 只有光照不同的两个场景由同一个工作线程依次渲染，各自与完整渲染一致
+    std::ofstream(dir / "light.json") << R"({
+        "meshes": { "cube": "cube.obj" },
+        "cameras": { "front": { "eye": [0, 0, 3], "ortho": true } },
+        "scenes": {
+            "dim": { "light": [0, 0, 1], "ambient": 0.1, "instances": [ { "mesh": "cube", "translate": [-0.2, -0.2, -0.2], "scale": 0.4 } ] },
+            "side": { "light": [1, 0, 1], "ambient": 0.6, "instances": [ { "mesh": "cube", "translate": [-0.2, -0.2, -0.2], "scale": 0.4 } ] }
+        },
+        "jobs": [
+            { "scene": "dim", "camera": "front", "width": 64, "height": 48, "output": "dim.raw", "format": "raw" },
+            { "scene": "side", "camera": "front", "width": 64, "height": 48, "output": "side.raw", "format": "raw" }
+        ]
+    })";
+    BatchFile lights;
+    CHECK(read_batch_file((dir / "light.json").string(), lights));
+    for(const JobResult& r : run_batch(lights, 1)) CHECK(r.ok);
+    for(int j = 0; j < 2; j ++) {
+        Renderer().render(lights.scenes[lights.jobs[j].scene], lights.jobs[j].camera, fb);
+        std::ifstream in(dir / lights.jobs[j].output, std::ios::binary);
+        bool match = true;
+        for(int y = 0; y < 48; y ++)
+            for(int x = 0; x < 64; x ++) {
+                std::uint32_t c = 0;
+                in.read(reinterpret_cast<char*>(&c), 4);
+                match = match && c == Framebuffer::pack(fb.get(x, y));
+            }
+        CHECK(in && match);
+    }
+
+    std::ofstream(dir / "bad.json") << R"({ "scenes": { "s": { "instances": [ { "mesh": "nope" } ] } } })";
+    CHECK(!read_batch_file((dir / "bad.json").string(), batch));
+
+    // 写法不同的同一文件只加载一次；经由资源仓库加载时使用二进制缓存，模型留在仓库中
+    std::filesystem::create_directories(dir / "sub");
+    std::ofstream(dir / "alias.json") << R"({
+        "meshes": { "a": "cube.obj", "b": "sub/../cube.obj", "c": "./cube.obj" },
+        "scenes": { "s": { "instances": [ { "mesh": "a" }, { "mesh": "b" } ] } },
+        "jobs": [ { "scene": "s", "width": 8, "height": 8, "output": "alias.tga" } ]
+    })";
+    BatchFile alias;
+    CHECK(read_batch_file((dir / "alias.json").string(), alias));
+    CHECK(alias.meshes.size() == 3 && alias.meshes[0] == alias.meshes[1] && alias.meshes[0] == alias.meshes[2]);
+    AssetStore store((dir / "cache").string());
+    CHECK(read_batch_file((dir / "alias.json").string(), alias, &store));
+    CHECK(alias.meshes[0] == alias.meshes[1] && alias.meshes[0] == alias.meshes[2]);
+    CHECK(alias.meshes[0] == store.model((dir / "cube.obj").string()));
+    CHECK(std::filesystem::exists(store.cache_path((dir / "cube.obj").string())));
+}
+
+/**
+ * @brief 测试渲染结果缓存：内容相同的输入键相同，任何输入变化键都变化，命中时画面一致，
+ * 哈希相同而描述不同时不命中
+ */
+void test_render_cache() {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "tiny_renderer_render_cache";
+    std::filesystem::remove_all(dir);
+    RenderCache cache(dir.string());
+
+    Camera camera;
+    const Scene scene = two_cubes(load_cube(), camera);
+    const Scene reloaded = two_cubes(load_cube(), camera);      // 不同对象，相同内容
+    CHECK(reloaded.instances[0].model != scene.instances[0].model);
+    const RenderSettings settings;
+    const RenderCache::Key k = cache.key(scene, camera, settings, 64, 64);
+    CHECK(cache.key(reloaded, camera, settings, 64, 64) == k);
+    CHECK(cache.key(scene, camera, settings, 64, 65) != k);
+    RenderSettings wire = settings;
+    wire.mode = RenderSettings::WIREFRAME;
+    CHECK(cache.key(scene, camera, wire, 64, 64) != k);
+    Camera moved = camera;
+    moved.eye.x += 1e-9;
+    CHECK(cache.key(scene, moved, settings, 64, 64) != k);
+    Scene recolored = scene;
+    recolored.instances[1].color[0] = 1;
+    CHECK(cache.key(recolored, camera, settings, 64, 64) != k);
+
+    Renderer renderer;
+    Framebuffer fb(64, 64), again(64, 64);
+    bool hit = true;
+    cache.render(renderer, scene, camera, fb, &hit);
+    CHECK(!hit);
+    CHECK(std::filesystem::exists(cache.path(k.hash)));
+    const RenderStats stats = cache.render(renderer, reloaded, camera, again, &hit);
+    CHECK(hit && stats.tiles_rendered == 0);
+    CHECK(same_pixels(fb, again));
+
+    // 命中后增量状态失效，继续增量渲染仍然正确
+    Scene changed = scene;
+    changed.instances[0].transform = place(-.5, -.6, .4);
+    renderer.render_incremental(changed, camera, again);
+    Renderer().render(changed, camera, fb);
+    CHECK(same_pixels(fb, again));
+
+    // 哈希相同但描述不同（模拟碰撞）时不命中
+    RenderCache::Key forged = cache.key(recolored, camera, settings, 64, 64);
+    forged.hash = k.hash;
+    CHECK(cache.load(k, again) && !cache.load(forged, again));
+
+    std::ofstream(cache.path(k.hash), std::ios::binary) << "TRRC garbage";
+    CHECK(!cache.load(k, again));
+}
+
+} // namespace
+
+/**
+ * @brief 自测入口
+ *
+ * @return 0 表示通过
+ */
+int main() {
+    test_shaded_coverage();
+    test_incremental_matches_full();
+    test_perspective_interpolation();
+    test_wireframe_and_points();
+    test_quantized_instance();
+    test_posed_instance();
+    test_extreme_coordinates();
+    test_hidden_line();
+    test_scissor();
+    test_stencil();
+    test_tile_states();
+    test_deterministic_threads();
+    test_progressive();
+    test_batch();
+    test_render_cache();
+
+    if (g_failures == 0) {
+        std::cout << "test_render: all tests passed\n";
+        return 0;
+    }
+
+    std::cerr << "test_render: failed cases = " << g_failures << "\n";
+    return 1;
+}